@@ -27,7 +27,9 @@ bool isOwningPtrName(const std::string &Name) {
   // mb: 'base' ones are needed for methods at isSystemSafeFunction
   return Name == "safememory::owning_ptr" ||
           Name == "safememory::detail::owning_ptr_impl" ||
-          Name == "safememory::detail::owning_ptr_base_impl";
+          Name == "safememory::detail::owning_ptr_base_impl" ||
+          Name == "safememory::shared_owning_ptr" ||
+          Name == "safememory::detail::shared_owning_ptr_impl";
 }
 
 bool isSafePtrName(const std::string &Name) {
@@ -40,7 +42,9 @@ bool isSafePtrName(const std::string &Name) {
     Name == "safememory::detail::soft_this_ptr_impl" ||
     Name == "safememory::detail::soft_this_ptr_base_impl" ||
     Name == "safememory::soft_this_ptr2" ||
-    Name == "safememory::detail::soft_this_ptr2_impl";
+    Name == "safememory::detail::soft_this_ptr2_impl" ||
+    Name == "safememory::shared_soft_ptr" ||
+    Name == "safememory::detail::shared_soft_ptr_impl";
 }
 
 bool isAwaitableName(const std::string &Name) {
@@ -53,7 +57,15 @@ bool isNullablePtrName(const std::string &Name) {
   // TODO remove naked_ptr
   return Name == "safememory::nullable_ptr" ||
          Name == "safememory::detail::nullable_ptr_impl" ||
-         Name == "safememory::detail::nullable_ptr_base_impl";
+         Name == "safememory::detail::nullable_ptr_base_impl" ||
+         isBorrowedPtrName(Name);
+}
+
+bool isBorrowedPtrName(const std::string &Name) {
+  // borrowed_ptr is not registered at the control block, so it must never
+  // escape its scope; it follows the same (stack-only) rules as nullable_ptr
+  return Name == "safememory::borrowed_ptr" ||
+         Name == "safememory::detail::borrowed_ptr_impl";
 }
 
 bool isSoftPtrCastName(const std::string& Name) {
@@ -114,7 +126,8 @@ bool isStackOnlyIteratorName(const ClangTidyContext *Context,
   //hardcode some names that are really important, and have special rules
     return Name == "eastl::node_iterator" ||
       Name == "safememory::detail::hashtable_stack_only_iterator" ||
-      Name == "safememory::detail::array_stack_only_iterator";
+      Name == "safememory::detail::array_stack_only_iterator" ||
+      Name == "safememory::detail::flat_hashtable_stack_only_iterator";
 }
 
 bool isSystemSafeFunction(const ClangTidyContext* Context, const std::string& Name) {
@@ -142,6 +155,8 @@ bool isSystemSafeFunction(const FunctionDecl* Decl, const ClangTidyContext* Cont
               MethodName == "get")
               return true;
     }
+    if(isBorrowedPtrName(ClassName) && MethodName == "to_soft")
+      return true;
   }
 
   std::string Name = getQnameForSystemSafeDb(Decl);
@@ -629,7 +644,9 @@ KindCheck isSafeVectorType(QualType Qt, const ClangTidyContext* Context,
   //   return KindCheck(false, false);
 
   std::string Name = getQnameForSystemSafeDb(Qt);
-  if (Name == "safememory::vector" || Name == "safememory::vector_safe") {
+  if (Name == "safememory::vector" || Name == "safememory::vector_safe" ||
+    Name == "safememory::small_vector" || Name == "safememory::deque" ||
+    Name == "safememory::ring_buffer") {
     return KindCheck(true, templateArgIsSafe(Qt, 0, Context, Dh));
   }
 
@@ -647,7 +664,8 @@ KindCheck isSafeHashMapType(QualType Qt, const ClangTidyContext* Context,
 
   std::string Name = getQnameForSystemSafeDb(Qt);
   if (Name == "safememory::unordered_map" || Name == "safememory::unordered_map_safe" ||
-    Name == "safememory::unordered_multimap" || Name == "safememory::unordered_multimap_safe") {
+    Name == "safememory::unordered_multimap" || Name == "safememory::unordered_multimap_safe" ||
+    Name == "safememory::flat_hash_map") {
     // mb: hashmap Key,Hash, and Equal must be deep_const
     // value only needs to be safe
 
@@ -661,6 +679,17 @@ KindCheck isSafeHashMapType(QualType Qt, const ClangTidyContext* Context,
       return KindCheck(true, false);
     return KindCheck(true, true);
   }
+  else if (Name == "safememory::flat_hash_set") {
+    // mb: same as hashmap, but without mapped type
+
+    if(!templateArgIsSafeAndDeepConst(Qt, 0, Context, Dh))
+      return KindCheck(true, false);
+    if(!templateArgIsDeepConstAndNoSideEffectCallOp(Qt, 1, Context, Dh))
+      return KindCheck(true, false);
+    if(!templateArgIsDeepConstAndNoSideEffectCallOp(Qt, 2, Context, Dh))
+      return KindCheck(true, false);
+    return KindCheck(true, true);
+  }
 
   return KindCheck(false, false);
 
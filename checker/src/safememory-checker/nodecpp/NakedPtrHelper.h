@@ -79,6 +79,7 @@ bool isOwningPtrName(const std::string& Name);
 bool isSafePtrName(const std::string& Name);
 bool isAwaitableName(const std::string &Name);
 bool isNullablePtrName(const std::string& Name);
+bool isBorrowedPtrName(const std::string& Name);
 
 bool isSoftPtrCastName(const std::string& Name);
 bool isWaitForAllName(const std::string& Name);
@@ -72,6 +72,8 @@ using soft_this_ptr2 = std::conditional_t<is_safe == memory_safety::safe, detail
 
 template<class T, memory_safety is_safe = safeness_declarator<T>::is_safe> using nullable_ptr = typename detail::nullable_ptr_type_<T, is_safe>::type;
 
+template<class T> using borrowed_ptr = detail::borrowed_ptr_impl<T>;
+
 
 
 template<class _Ty,
@@ -76,6 +76,7 @@ template<class T> class soft_ptr_base_impl; // forward declaration
 template<class T> class soft_ptr_impl; // forward declaration
 template<class T> class nullable_ptr_base_impl; // forward declaration
 template<class T> class nullable_ptr_impl; // forward declaration
+template<class T> class borrowed_ptr_impl; // forward declaration
 template<class T> class soft_this_ptr_impl; // forward declaration
 class soft_this_ptr2_impl; // forward declaration
 
@@ -590,61 +591,63 @@ soft_ptr_impl<T> soft_ptr_reinterpret_cast_impl( soft_ptr_impl<T1> p ) {
 }
 
 
-template<class T>
-class soft_this_ptr_impl
+class soft_this_ptr_base_impl
 {
+protected:
 	FirstControlBlock* cbPtr = nullptr;
-	uint32_t offset;
-
-public:
 
-	static constexpr memory_safety is_safe = memory_safety::safe;
+	static FirstControlBlock* getCbPtr() noexcept {
+		return nullptr;
+	}
 
-	soft_this_ptr_impl();
+	soft_this_ptr_base_impl() : cbPtr(getCbPtr()) {}
+	soft_this_ptr_base_impl(const soft_this_ptr_base_impl&) : cbPtr(getCbPtr()) {}
+	soft_this_ptr_base_impl(soft_this_ptr_base_impl&&) : cbPtr(getCbPtr()) {}
 
-	soft_this_ptr_impl( soft_this_ptr_impl& other ) {}
-	soft_this_ptr_impl& operator = ( soft_this_ptr_impl& other ) { return *this; }
+	soft_this_ptr_base_impl& operator=(const soft_this_ptr_base_impl&) { return *this; }
+	soft_this_ptr_base_impl& operator=(soft_this_ptr_base_impl&&) { return *this; }
 
-	soft_this_ptr_impl( soft_this_ptr_impl&& other ) {}
-	soft_this_ptr_impl& operator = ( soft_this_ptr_impl&& other ) { return *this; }
+	~soft_this_ptr_base_impl() = default;
 
-	explicit operator bool() const noexcept
-	{
-		return cbPtr != nullptr;
-	}
+public:
 
-	template<class TT>
-	soft_ptr_impl<TT> getSoftPtr(TT* ptr);
+	static constexpr memory_safety is_safe = memory_safety::safe;
 
-	~soft_this_ptr_impl()
-	{
+	explicit operator bool() const noexcept {
+		return cbPtr != nullptr;
 	}
 };
 
-class soft_this_ptr2_impl
+template<class T>
+class soft_this_ptr_impl : public soft_this_ptr_base_impl
 {
-	FirstControlBlock* cbPtr = nullptr;
+public:
 
-	static FirstControlBlock* getCbPtr() noexcept {
-		return nullptr;
-	}
+	soft_this_ptr_impl() = default;
+	soft_this_ptr_impl(const soft_this_ptr_impl&) = default;
+	soft_this_ptr_impl(soft_this_ptr_impl&&) = default;
 
-public:
+	soft_this_ptr_impl& operator=(const soft_this_ptr_impl&) = default;
+	soft_this_ptr_impl& operator=(soft_this_ptr_impl&&) = default;
 
-	static constexpr memory_safety is_safe = memory_safety::safe;
+	~soft_this_ptr_impl() = default;
 
-	soft_this_ptr2_impl() : cbPtr(getCbPtr()) {}
-	soft_this_ptr2_impl(const soft_this_ptr2_impl&) : cbPtr(getCbPtr()) {}
-	soft_this_ptr2_impl(soft_this_ptr2_impl&&) : cbPtr(getCbPtr()) {}
+	template<class TT>
+	soft_ptr_impl<TT> getSoftPtr(TT* ptr) const;
+};
 
-	soft_this_ptr2_impl& operator=(const soft_this_ptr2_impl&) { return *this; }
-	soft_this_ptr2_impl& operator=(soft_this_ptr2_impl&&) { return *this; }
+class soft_this_ptr2_impl : public soft_this_ptr_base_impl
+{
+public:
 
-	~soft_this_ptr2_impl() = default;
+	soft_this_ptr2_impl() = default;
+	soft_this_ptr2_impl(const soft_this_ptr2_impl&) = default;
+	soft_this_ptr2_impl(soft_this_ptr2_impl&&) = default;
 
-	explicit operator bool() const noexcept {
-		return cbPtr != nullptr;
-	}
+	soft_this_ptr2_impl& operator=(const soft_this_ptr2_impl&) = default;
+	soft_this_ptr2_impl& operator=(soft_this_ptr2_impl&&) = default;
+
+	~soft_this_ptr2_impl() = default;
 
 	template<class T>
 	soft_ptr_impl<T> getSoftPtr(T* ptr) const {
@@ -931,6 +934,35 @@ nullable_ptr_impl<T> nullable_cast_impl( T* p ) {
 	return nullable_ptr_impl<T>( p );
 }
 
+
+template<class T>
+class borrowed_ptr_impl
+{
+	T* t = nullptr;
+	FirstControlBlock* cb = nullptr;
+
+public:
+	static constexpr memory_safety is_safe = memory_safety::safe;
+
+	borrowed_ptr_impl() {}
+	borrowed_ptr_impl( std::nullptr_t ) {}
+	template<class T1>
+	borrowed_ptr_impl( const owning_ptr_impl<T1>& owner ) {}
+	template<class T1>
+	borrowed_ptr_impl( const soft_ptr_impl<T1>& other ) {}
+	borrowed_ptr_impl( const borrowed_ptr_impl<T>& other ) = default;
+	borrowed_ptr_impl<T>& operator = ( const borrowed_ptr_impl<T>& other ) = default;
+	borrowed_ptr_impl<T>& operator = ( std::nullptr_t ) { t = nullptr; cb = nullptr; return *this; }
+
+	soft_ptr_impl<T> to_soft() const { return soft_ptr_impl<T>(); }
+
+	T& operator * () const { return *t; }
+	T* operator -> () const { return t; }
+	explicit operator bool() const noexcept { return t != nullptr; }
+	bool operator == ( std::nullptr_t ) const { return t == nullptr; }
+	bool operator != ( std::nullptr_t ) const { return t != nullptr; }
+};
+
 } // namespace safememory::detail
 
 #endif // SAFE_PTR_IMPL_H
@@ -0,0 +1,36 @@
+// RUN: safememory-checker --no-library-db %s | FileCheck %s -implicit-check-not="{{warning|error}}:"
+
+#include <safememory/safe_ptr.h>
+
+using namespace safememory;
+
+struct Safe {
+	int i = 0;
+};
+
+struct Holder {
+	soft_ptr<Safe> sp;
+};
+
+int use(borrowed_ptr<Safe> bp) {
+	return bp->i; // ok
+}
+
+void store(borrowed_ptr<Safe> bp, Holder& h) {
+	h.sp = bp.to_soft(); // ok, a regular soft_ptr is registered
+}
+
+void func99() {
+
+	owning_ptr<Safe> op1;
+	borrowed_ptr<Safe> ptr1(op1);
+	use(ptr1);
+	{
+		owning_ptr<Safe> op2;
+		borrowed_ptr<Safe> ptr2(op2);
+		ptr2 = ptr1; // ok
+		ptr1 = ptr2; // bad
+//CHECK: :[[@LINE-1]]:8: error: (S5.1)
+
+	}
+}
@@ -590,61 +590,63 @@ soft_ptr_impl<T> soft_ptr_reinterpret_cast_impl( soft_ptr_impl<T1> p ) {
 }
 
 
-template<class T>
-class soft_this_ptr_impl
+class soft_this_ptr_base_impl
 {
+protected:
 	FirstControlBlock* cbPtr = nullptr;
-	uint32_t offset;
-
-public:
 
-	static constexpr memory_safety is_safe = memory_safety::safe;
+	static FirstControlBlock* getCbPtr() noexcept {
+		return nullptr;
+	}
 
-	soft_this_ptr_impl();
+	soft_this_ptr_base_impl() : cbPtr(getCbPtr()) {}
+	soft_this_ptr_base_impl(const soft_this_ptr_base_impl&) : cbPtr(getCbPtr()) {}
+	soft_this_ptr_base_impl(soft_this_ptr_base_impl&&) : cbPtr(getCbPtr()) {}
 
-	soft_this_ptr_impl( soft_this_ptr_impl& other ) {}
-	soft_this_ptr_impl& operator = ( soft_this_ptr_impl& other ) { return *this; }
+	soft_this_ptr_base_impl& operator=(const soft_this_ptr_base_impl&) { return *this; }
+	soft_this_ptr_base_impl& operator=(soft_this_ptr_base_impl&&) { return *this; }
 
-	soft_this_ptr_impl( soft_this_ptr_impl&& other ) {}
-	soft_this_ptr_impl& operator = ( soft_this_ptr_impl&& other ) { return *this; }
+	~soft_this_ptr_base_impl() = default;
 
-	explicit operator bool() const noexcept
-	{
-		return cbPtr != nullptr;
-	}
+public:
 
-	template<class TT>
-	soft_ptr_impl<TT> getSoftPtr(TT* ptr);
+	static constexpr memory_safety is_safe = memory_safety::safe;
 
-	~soft_this_ptr_impl()
-	{
+	explicit operator bool() const noexcept {
+		return cbPtr != nullptr;
 	}
 };
 
-class soft_this_ptr2_impl
+template<class T>
+class soft_this_ptr_impl : public soft_this_ptr_base_impl
 {
-	FirstControlBlock* cbPtr = nullptr;
+public:
 
-	static FirstControlBlock* getCbPtr() noexcept {
-		return nullptr;
-	}
+	soft_this_ptr_impl() = default;
+	soft_this_ptr_impl(const soft_this_ptr_impl&) = default;
+	soft_this_ptr_impl(soft_this_ptr_impl&&) = default;
 
-public:
+	soft_this_ptr_impl& operator=(const soft_this_ptr_impl&) = default;
+	soft_this_ptr_impl& operator=(soft_this_ptr_impl&&) = default;
 
-	static constexpr memory_safety is_safe = memory_safety::safe;
+	~soft_this_ptr_impl() = default;
 
-	soft_this_ptr2_impl() : cbPtr(getCbPtr()) {}
-	soft_this_ptr2_impl(const soft_this_ptr2_impl&) : cbPtr(getCbPtr()) {}
-	soft_this_ptr2_impl(soft_this_ptr2_impl&&) : cbPtr(getCbPtr()) {}
+	template<class TT>
+	soft_ptr_impl<TT> getSoftPtr(TT* ptr) const;
+};
 
-	soft_this_ptr2_impl& operator=(const soft_this_ptr2_impl&) { return *this; }
-	soft_this_ptr2_impl& operator=(soft_this_ptr2_impl&&) { return *this; }
+class soft_this_ptr2_impl : public soft_this_ptr_base_impl
+{
+public:
 
-	~soft_this_ptr2_impl() = default;
+	soft_this_ptr2_impl() = default;
+	soft_this_ptr2_impl(const soft_this_ptr2_impl&) = default;
+	soft_this_ptr2_impl(soft_this_ptr2_impl&&) = default;
 
-	explicit operator bool() const noexcept {
-		return cbPtr != nullptr;
-	}
+	soft_this_ptr2_impl& operator=(const soft_this_ptr2_impl&) = default;
+	soft_this_ptr2_impl& operator=(soft_this_ptr2_impl&&) = default;
+
+	~soft_this_ptr2_impl() = default;
 
 	template<class T>
 	soft_ptr_impl<T> getSoftPtr(T* ptr) const {
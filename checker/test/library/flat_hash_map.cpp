@@ -0,0 +1,75 @@
+// RUN: safememory-checker %s | FileCheck %s -implicit-check-not="{{warning|error}}:"
+
+#include <safememory/safe_ptr.h>
+#include <safememory/flat_hash_map.h>
+#include <safememory/flat_hash_set.h>
+
+using namespace safememory;
+
+struct Safe1 {
+	int i = 0;
+};
+
+void safeFlatMap() {
+	//all ok
+
+	flat_hash_map<int, int> mi;
+	flat_hash_map<int, Safe1> mS1;
+	flat_hash_set<int> si;
+}
+
+
+struct SafeIt {
+	flat_hash_map<int, int>::iterator_safe it; //ok
+};
+
+struct BadIt {
+// CHECK: :[[@LINE-1]]:8: error: unsafe type declaration
+	flat_hash_map<int, int>::iterator it;
+};
+
+void heapIterator() {
+
+	auto ok = make_owning<SafeIt>();
+
+	auto bad = make_owning<BadIt>();
+// CHECK: :[[@LINE-1]]:7: error: unsafe type at variable declaration
+}
+
+
+flat_hash_map<int,int>::iterator flatMapFunc(flat_hash_map<int,int>::iterator in) {
+	return in;
+}
+
+flat_hash_map<int,int>::iterator flatMapFunc2() {
+	flat_hash_map<int,int> mi;
+	return mi.end();
+// CHECK: :[[@LINE-1]]:9: error: (S5.1) return value may extend scope
+}
+
+void flatMapIterator() {
+	//all ok
+	flat_hash_map<int,int>::iterator it;
+	flat_hash_map<int,int>::iterator_safe sit;
+	{
+		flat_hash_map<int,int> mi;
+		it = mi.end();
+// CHECK: :[[@LINE-1]]:6: error: (S5.1) assignment may extend scope
+
+		sit = mi.end_safe();//ok
+
+		it = flatMapFunc(mi.end());
+// CHECK: :[[@LINE-1]]:6: error: (S5.1) assignment may extend scope
+
+		sit = mi.make_safe(mi.end());
+	}
+}
+
+void flatSetIterator() {
+	flat_hash_set<int>::iterator it;
+	{
+		flat_hash_set<int> si;
+		it = si.begin();
+// CHECK: :[[@LINE-1]]:6: error: (S5.1) assignment may extend scope
+	}
+}
@@ -137,7 +137,12 @@ namespace safememory {
 			explicit operator bool() const noexcept;
 		};
 
-		class soft_this_ptr_impl {
+		class soft_this_ptr_base_impl {
+		public:
+			explicit operator bool() const noexcept;
+		};
+
+		class soft_this_ptr_impl : public soft_this_ptr_base_impl {
 		public:
 			typedef soft_this_ptr_impl this_type;
 
@@ -0,0 +1,63 @@
+// RUN: safememory-checker %s | FileCheck %s -implicit-check-not="{{warning|error}}:"
+
+#include <safememory/safe_ptr.h>
+#include <safememory/small_vector.h>
+#include <safememory/deque.h>
+#include <safememory/ring_buffer.h>
+#include <safememory/string_view.h>
+
+
+using namespace safememory;
+
+struct Safe1 {
+	int i = 0;
+};
+
+void safeContainers() {
+	//all ok
+	small_vector<int, 4> sv;
+	small_vector<Safe1, 4> svS1;
+
+	deque<int> dq;
+	deque<Safe1> dqS1;
+
+	ring_buffer<int> rb(4);
+	ring_buffer<Safe1> rbS1;
+
+	string_view s;
+}
+
+void badFunc() {
+	small_vector<int*, 4> sv; //bad
+// CHECK: :[[@LINE-1]]:24: error: unsafe type at variable declaration
+
+	deque<int*> dq; //bad
+// CHECK: :[[@LINE-1]]:14: error: unsafe type at variable declaration
+
+	ring_buffer<int*> rb; //bad
+// CHECK: :[[@LINE-1]]:20: error: unsafe type at variable declaration
+}
+
+void iterators() {
+	small_vector<int, 4>::iterator it;
+	small_vector<int, 4>::iterator_safe sit;
+	deque<int>::iterator dit;
+	ring_buffer<int>::iterator rit;
+	string_view::const_iterator vit;
+	{
+		small_vector<int, 4> sv;
+		it = sv.end();
+// CHECK: :[[@LINE-1]]:6: error: (S5.1) assignment may extend scope
+
+		sit = sv.end_safe(); //ok
+
+		deque<int> dq;
+		dit = dq.end(); //ok, heap safe iterator
+
+		ring_buffer<int> rb(4);
+		rit = rb.end(); //ok, heap safe iterator
+
+		string_view s;
+		vit = s.end(); //ok, heap safe iterator
+	}
+}
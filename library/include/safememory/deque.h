@@ -0,0 +1,299 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_DEQUE_H
+#define SAFE_MEMORY_DEQUE_H
+
+#include <EASTL/algorithm.h>
+#include <EASTL/iterator.h>
+#include <safememory/detail/checker_attributes.h>
+#include <safememory/detail/ring_buffer_base.h>
+#include <safememory/detail/ring_iterator.h>
+#include <safe_memory_error.h>
+
+namespace safememory
+{
+	/**
+	 * \brief Double ended queue, on a single circular array.
+	 * 
+	 * Meant for event queues and alike, \c push_back and \c pop_front are O(1) and never move
+	 * other elements, unlike \c vector::erase(begin()).
+	 * 
+	 * Unlike \c eastl::deque elements are not kept in fixed size blocks, a single array
+	 * is allocated and reallocated when it is full, like \c vector does.
+	 * So a single \c soft_ptr is enough for heap safe iterators.
+	 * 
+	 * There are only heap safe iterators, see \c detail::ring_heap_safe_iterator
+	 */
+	template <typename T, memory_safety Safety = safeness_declarator<T>::is_safe>
+	class SAFEMEMORY_DEEP_CONST_WHEN_PARAMS deque : protected detail::ring_buffer_base<T, Safety>
+	SAFEMEMORY_DEZOMBIEFY_ITERATORS_REGISTRY
+	{
+		typedef deque<T, Safety>                                           this_type;
+		typedef detail::ring_buffer_base<T, Safety>                        base_type;
+
+	public:
+		typedef typename base_type::value_type                             value_type;
+		typedef typename base_type::pointer                                pointer;
+		typedef typename base_type::const_pointer                          const_pointer;
+		typedef typename base_type::reference                              reference;
+		typedef typename base_type::const_reference                        const_reference;
+		typedef typename base_type::size_type                              size_type;
+		typedef typename base_type::difference_type                        difference_type;
+		typedef typename base_type::allocator_type                         allocator_type;
+
+#ifdef SAFEMEMORY_DEZOMBIEFY_ITERATORS
+		static constexpr bool dz_it = true;
+#else
+		static constexpr bool dz_it = false;
+#endif
+
+		typedef typename allocator_type::template soft_array_pointer<T>                   soft_ptr_type;
+		typedef typename detail::ring_heap_safe_iterator<T, false, soft_ptr_type, dz_it>  iterator;
+		typedef typename detail::ring_heap_safe_iterator<T, true, soft_ptr_type, dz_it>   const_iterator;
+		typedef eastl::reverse_iterator<iterator>                                         reverse_iterator;
+		typedef eastl::reverse_iterator<const_iterator>                                   const_reverse_iterator;
+
+		static constexpr memory_safety is_safe = Safety;
+
+	public:
+		deque() {}
+		explicit deque(size_type n) : base_type(n) {}
+		deque(size_type n, const value_type& value) : base_type(n, value) {}
+		deque(const this_type& x) = default;
+		deque(this_type&&) = default;
+		deque(std::initializer_list<value_type> ilist) : base_type(ilist) {}
+
+		~deque() = default;
+
+		this_type& operator=(const this_type& x) = default;
+		this_type& operator=(std::initializer_list<value_type> ilist) { base_type::operator=(ilist); return *this; }
+		this_type& operator=(this_type&& x) = default;
+
+		void swap(this_type& x) { base_type::swap(x); }
+
+		void assign(size_type n, const value_type& value) { base_type::assign(n, value); }
+		void assign(std::initializer_list<value_type> ilist) { base_type::assign(ilist); }
+
+		iterator       begin() noexcept { return makeIt(0); }
+		const_iterator begin() const noexcept { return makeIt(0); }
+		const_iterator cbegin() const noexcept { return makeIt(0); }
+
+		iterator       end() noexcept { return makeIt(base_type::size()); }
+		const_iterator end() const noexcept { return makeIt(base_type::size()); }
+		const_iterator cend() const noexcept { return makeIt(base_type::size()); }
+
+		reverse_iterator       rbegin() noexcept { return reverse_iterator(end()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+
+		reverse_iterator       rend() noexcept { return reverse_iterator(begin()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+#ifdef SAFEMEMORY_DEZOMBIEFY_ITERATORS
+		size_type size() const noexcept { return base_type::size(); }
+#else
+		using base_type::size;
+#endif
+
+		using base_type::empty;
+		using base_type::capacity;
+		using base_type::max_size;
+
+		using base_type::resize;
+		using base_type::reserve;
+		using base_type::shrink_to_fit;
+
+		reference       operator[](size_type n) { return at(n); }
+		const_reference operator[](size_type n) const { return at(n); }
+
+		reference at(size_type n) {
+			checkIndex(n);
+			return *base_type::slot(n);
+		}
+
+		const_reference at(size_type n) const {
+			checkIndex(n);
+			return *base_type::slot(n);
+		}
+
+		reference       front() { checkNotEmpty(); return *base_type::slot(0); }
+		const_reference front() const { checkNotEmpty(); return *base_type::slot(0); }
+
+		reference       back() { checkNotEmpty(); return *base_type::slot(base_type::size() - 1); }
+		const_reference back() const { checkNotEmpty(); return *base_type::slot(base_type::size() - 1); }
+
+		void push_back(const value_type& value) { base_type::emplace_back(value); }
+		void push_back(value_type&& value) { base_type::emplace_back(std::move(value)); }
+		void push_front(const value_type& value) { base_type::emplace_front(value); }
+		void push_front(value_type&& value) { base_type::emplace_front(std::move(value)); }
+
+		using base_type::emplace_back;
+		using base_type::emplace_front;
+
+		void pop_back() {
+			checkNotEmpty();
+			base_type::pop_back();
+		}
+
+		void pop_front() {
+			checkNotEmpty();
+			base_type::pop_front();
+		}
+
+		template<class... Args>
+		iterator emplace(const const_iterator& position, Args&&... args) {
+			const size_type ix = toIndex(position);
+			base_type::emplace(ix, std::forward<Args>(args)...);
+			return makeIt(ix);
+		}
+
+		iterator insert(const const_iterator& position, const value_type& value) {
+			return emplace(position, value);
+		}
+
+		iterator insert(const const_iterator& position, value_type&& value) {
+			return emplace(position, std::move(value));
+		}
+
+		iterator erase(const const_iterator& position) {
+			const size_type ix = toIndexDereferenceable(position);
+			base_type::erase(ix, ix + 1);
+			return makeIt(ix);
+		}
+
+		iterator erase(const const_iterator& first, const const_iterator& last) {
+			auto p = toIndex(first, last);
+			base_type::erase(p.first, p.second);
+			return makeIt(p.first);
+		}
+
+		using base_type::clear;
+
+	protected:
+		[[noreturn]] static void ThrowRangeException() { throw nodecpp::error::out_of_range; }
+
+		void checkNotEmpty() const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(empty()))
+					ThrowRangeException();
+			}
+		}
+
+		void checkIndex(size_type n) const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(n >= base_type::size()))
+					ThrowRangeException();
+			}
+		}
+
+		// mb: iterators are only checked against capacity, but base needs them inside [begin, end]
+		size_type toIndex(const const_iterator& it) const {
+			const size_type ix = it.toIndex(base_type::buffer(), base_type::head());
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(ix > base_type::size()))
+					ThrowRangeException();
+			}
+			return ix;
+		}
+
+		std::pair<size_type, size_type> toIndex(const const_iterator& it, const const_iterator& it2) const {
+			auto p = it.toIndex(base_type::buffer(), base_type::head(), it2);
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(p.second > base_type::size()))
+					ThrowRangeException();
+			}
+			return p;
+		}
+
+		/// erase needs an iterator to an element, not \c end()
+		size_type toIndexDereferenceable(const const_iterator& it) const {
+			const size_type ix = toIndex(it);
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(ix == base_type::size()))
+					ThrowRangeException();
+			}
+			return ix;
+		}
+
+		iterator makeIt(size_type ix) {
+			return iterator::makeIx(allocator_type::to_soft(base_type::mpBuffer), base_type::head(), ix, this);
+		}
+
+		const_iterator makeIt(size_type ix) const {
+			return const_iterator::makeIx(allocator_type::to_soft(base_type::mpBuffer), base_type::head(), ix, const_cast<this_type*>(this));
+		}
+	}; // class deque
+
+
+	template <typename T, memory_safety Safety>
+	inline bool operator==(const deque<T, Safety>& a, const deque<T, Safety>& b)
+	{
+		return a.size() == b.size() && eastl::equal(a.begin(), a.end(), b.begin());
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator!=(const deque<T, Safety>& a, const deque<T, Safety>& b)
+	{
+		return !(a == b);
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator<(const deque<T, Safety>& a, const deque<T, Safety>& b)
+	{
+		return eastl::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator>(const deque<T, Safety>& a, const deque<T, Safety>& b)
+	{
+		return b < a;
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator<=(const deque<T, Safety>& a, const deque<T, Safety>& b)
+	{
+		return !(b < a);
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator>=(const deque<T, Safety>& a, const deque<T, Safety>& b)
+	{
+		return !(a < b);
+	}
+
+	template <typename T, memory_safety Safety>
+	inline void swap(deque<T, Safety>& a, deque<T, Safety>& b)
+	{
+		a.swap(b);
+	}
+
+} // namespace safememory
+
+#endif // SAFE_MEMORY_DEQUE_H
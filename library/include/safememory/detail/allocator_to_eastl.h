@@ -57,35 +57,50 @@ extern flexible_array_with_memory<2, soft_ptr_with_zero_offset_base> gpSafeMemor
 extern void* gpSafeMemoryEmptyBucketArrayRaw[];
 
 
-template<std::size_t alignment>
+/// \c embeddedSlots is the number of soft_ptr slots beyond \c FirstControlBlock::maxSlots
+/// to be placed right after the object (see \c soft_ptr_slots_declarator)
+template<std::size_t alignment, std::size_t embeddedSlots = 0>
 void* zombie_allocate_helper(std::size_t sz) {
 
 	std::size_t head = sizeof(FirstControlBlock) - getPrefixByteCount();
+	constexpr bool overAligned = FirstControlBlock::isOverAlignedType(alignment);
 
-	std::size_t total = head + sz;
-	void* data =  zombieAllocateAligned<alignment>(total);
+	std::size_t total = FirstControlBlock::overAlignedExtraSize(alignment) + ( embeddedSlots == 0 ? head + sz :
+		head + FirstControlBlock::embeddedBlockOffset(sz) + FirstControlBlock::embeddedBlockSize(embeddedSlots) );
+	void* data =  zombieAllocateAligned<overAligned ? NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT : alignment>(total);
 
-	void* dataForObj = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(data) + head);
+	void* dataForObj;
+	if constexpr (overAligned)
+		dataForObj = FirstControlBlock::placeOverAligned(reinterpret_cast<uint8_t*>(data), head, alignment);
+	else
+		dataForObj = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(data) + head);
 	
 	auto cb = getControlBlock_(dataForObj);
 	cb->init();
+	if constexpr (overAligned)
+		cb->setOverAligned();
+	if constexpr (embeddedSlots != 0)
+		cb->attachEmbeddedSecondBlock(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(dataForObj) + FirstControlBlock::embeddedBlockOffset(sz)), embeddedSlots);
 
 	return dataForObj;
 }
 
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 
-template<memory_safety is_safe, std::size_t alignment>
+template<memory_safety is_safe, std::size_t alignment, std::size_t embeddedSlots = 0>
 std::pair<make_zero_offset_t, void*> allocate_helper(std::size_t sz) {
 
 	if ( is_safe == memory_safety::none || g_CurrentAllocManager == nullptr ) {
 		void* ptr = allocateAligned<alignment>(sz);
 		typedef decltype(g_CurrentAllocManager->allocatorID()) id_type;
 		id_type allocatorID = g_CurrentAllocManager != nullptr ? g_CurrentAllocManager->allocatorID() : 0;
+		// zombieable buffers are counted by zombieAllocateAligned(), these ones are counted here (see safememory::arena)
+		if ( NODECPP_UNLIKELY( allocatorID != 0 && thg_allocatorRegistry.count != 0 ) )
+			countRegisteredAllocation();
 		return { make_zero_offset_t{allocatorID}, ptr };
 	}
 	else {
-		void* ptr = zombie_allocate_helper<alignment>(sz);
+		void* ptr = zombie_allocate_helper<alignment, embeddedSlots>(sz);
 		auto allocatorID = g_CurrentAllocManager->allocatorID();
 		return { make_zero_offset_t{allocatorID}, ptr };
 	}
@@ -100,19 +115,21 @@ void deallocate_helper(const soft_ptr_with_zero_offset<T, is_safe>& p) {
 		//we don't destruct here dataForObj->~T();
 		if(is_safe == memory_safety::none || allocatorID == 0) {
 			deallocate( dataForObj, alignof(T), allocatorID );
+			if ( NODECPP_UNLIKELY( allocatorID != 0 && thg_allocatorRegistry.count != 0 ) )
+				countRegisteredDeallocation( allocatorID );
 		}
 		else {
 			auto cb = getControlBlock_(dataForObj);
-			cb->template updatePtrForListItemsWithInvalidPtr<T>();
+			cb->updatePtrForListItemsWithInvalidPtr();
+			cb->clear(); // marked as zombie before the block goes to the allocator
 			zombieDeallocate( getAllocatedBlock_(dataForObj), allocatorID );
-			cb->clear(allocatorID);
 		}
 	}
 }
 
 #else
 
-template<memory_safety is_safe, std::size_t alignment>
+template<memory_safety is_safe, std::size_t alignment, std::size_t embeddedSlots = 0>
 std::pair<make_zero_offset_t, void*> allocate_helper(std::size_t sz) {
 
 	if ( is_safe == memory_safety::none ) {
@@ -120,7 +137,7 @@ std::pair<make_zero_offset_t, void*> allocate_helper(std::size_t sz) {
 		return { make_zero_offset_t{}, ptr };
 	}
 	else {
-		void* ptr = zombie_allocate_helper<alignment>(sz);
+		void* ptr = zombie_allocate_helper<alignment, embeddedSlots>(sz);
 		return { make_zero_offset_t{}, ptr };
 	}
 }
@@ -136,9 +153,9 @@ void deallocate_helper(const soft_ptr_with_zero_offset<T, is_safe>& p) {
 		}
 		else {
 			auto cb = getControlBlock_(dataForObj);
-			cb->template updatePtrForListItemsWithInvalidPtr<T>();
+			cb->updatePtrForListItemsWithInvalidPtr();
+			cb->clear(); // marked as zombie before the block goes to the allocator
 			zombieDeallocate( getAllocatedBlock_(dataForObj) );
-			cb->clear();
 		}
 	}
 }
@@ -149,7 +166,7 @@ void deallocate_helper(const soft_ptr_with_zero_offset<T, is_safe>& p) {
 template<memory_safety is_safe, class T>
 soft_ptr_with_zero_offset<T, is_safe> allocate_node_helper() {
 
-	auto mm = allocate_helper<is_safe, alignof(T)>(sizeof(T));
+	auto mm = allocate_helper<is_safe, alignof(T), FirstControlBlock::embeddedSlotCount<T>()>(sizeof(T));
 
 	auto dataForObj = reinterpret_cast<T*>(mm.second);
 
@@ -227,18 +244,7 @@ class soft_ptr_helper {
 	}
 };
 
-class soft_this_ptr_raii_impl {
-
-	void* stackTmp;
-public:
-	soft_this_ptr_raii_impl(void* ptr) noexcept : stackTmp(thg_stackPtrForMakeOwningCall) {
-		thg_stackPtrForMakeOwningCall = ptr;
-	}
-
-	~soft_this_ptr_raii_impl() {
-		thg_stackPtrForMakeOwningCall = stackTmp;
-	}
-};
+using soft_this_ptr_raii_impl = make_owning_context;
 
 class soft_this_ptr_raii_dummy {
 public:
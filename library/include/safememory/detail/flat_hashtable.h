@@ -0,0 +1,821 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_DETAIL_FLAT_HASHTABLE_H
+#define SAFE_MEMORY_DETAIL_FLAT_HASHTABLE_H
+
+#include <utility>
+#include <iterator> //for std::forward_iterator_tag
+#include <cstring>
+#include <initializer_list>
+#include <EASTL/utility.h> // for eastl::pair
+#include <safememory/detail/allocator_to_eastl.h>
+#include <safe_memory_error.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAFEMEMORY_FLAT_HASH_SSE2
+#include <emmintrin.h>
+#endif
+
+/** \file
+ * \brief Open addressing hash table with Swiss table style control bytes.
+ * 
+ * Elements are kept in a single array (slab) allocated through the same allocator as \c safememory::vector,
+ * that is, with a \a ControlBlock in front. The slab holds \c capacity slots followed by
+ * \c capacity + \c flat_group::width control bytes (first \c flat_group::width of them are cloned at the end,
+ * so that a group can be loaded at any position without wrapping around).
+ * 
+ * A control byte is either \c flat_ctrl_empty, \c flat_ctrl_deleted, or 7 bits of the hash of the element
+ * in the slot (full slot). Lookups compare a whole group of control bytes at once and only look at slots
+ * whose bits match.
+ * 
+ * Iterators are an index plus a pointer to the slab. Heap safe iterators use a \c soft_ptr to it,
+ * which is invalidated when the slab is deallocated (i.e. at rehash or destruction of the table).
+ */
+
+namespace safememory::detail {
+
+typedef int8_t flat_ctrl_t;
+constexpr flat_ctrl_t flat_ctrl_empty = -128;   // 0b10000000
+constexpr flat_ctrl_t flat_ctrl_deleted = -2;   // 0b11111110
+constexpr bool flat_ctrl_is_full( flat_ctrl_t c ) { return c >= 0; }
+
+/// bits of a group match; \p Shift is log2 of the number of bits per control byte
+template<int Shift>
+struct flat_bitmask
+{
+	uint64_t mask;
+
+	explicit operator bool() const { return mask != 0; }
+	size_t lowest() const { return countTrailingZeros( mask ) >> Shift; }
+	void clear_lowest() { mask &= mask - 1; }
+};
+
+#ifdef SAFEMEMORY_FLAT_HASH_SSE2
+
+struct flat_group
+{
+	static constexpr size_t width = 16;
+	typedef flat_bitmask<0> bitmask;
+
+	__m128i ctrl;
+
+	explicit flat_group( const flat_ctrl_t* pos ) { ctrl = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pos ) ); }
+
+	bitmask match( flat_ctrl_t h2 ) const { return { (uint32_t)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( h2 ), ctrl ) ) }; }
+	bitmask match_empty() const { return match( flat_ctrl_empty ); }
+	bitmask match_empty_or_deleted() const { return { (uint32_t)_mm_movemask_epi8( ctrl ) }; } // only these have the sign bit set
+};
+
+#else
+
+// portable version, 8 control bytes in a word (little endian is assumed)
+struct flat_group
+{
+	static constexpr size_t width = 8;
+	typedef flat_bitmask<3> bitmask;
+	static constexpr uint64_t lsbs = 0x0101010101010101ull;
+	static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+	uint64_t ctrl;
+
+	explicit flat_group( const flat_ctrl_t* pos ) { std::memcpy( &ctrl, pos, sizeof(ctrl) ); }
+
+	// may give false positives (for a byte next to a real match), which are filtered out by key comparison
+	bitmask match( flat_ctrl_t h2 ) const {
+		uint64_t x = ctrl ^ ( lsbs * (uint8_t)h2 );
+		return { ( x - lsbs ) & ~x & msbs };
+	}
+	bitmask match_empty() const { return { ( ctrl & ( ~ctrl << 6 ) ) & msbs }; }
+	bitmask match_empty_or_deleted() const { return { ctrl & msbs }; }
+};
+
+#endif // SAFEMEMORY_FLAT_HASH_SSE2
+
+/// layout of the slab: \c capacity slots, then control bytes
+template<class Slot>
+struct flat_hash_layout
+{
+	typedef eastl_size_t size_type;
+
+	static size_type ctrlByteCount( size_type capacity ) { return capacity + flat_group::width; }
+	// in Slot units, as the slab is allocated as flexible_array<Slot>
+	static size_type slabSize( size_type capacity ) {
+		return capacity + ( ctrlByteCount( capacity ) + sizeof(Slot) - 1 ) / sizeof(Slot);
+	}
+	static flat_ctrl_t* ctrl( const flexible_array<Slot>* arr, size_type capacity ) {
+		return reinterpret_cast<flat_ctrl_t*>( const_cast<Slot*>( arr->data() ) + capacity );
+	}
+};
+
+
+/**
+ * \brief Iterator of \c flat_hashtable.
+ * 
+ * Keeps a pointer to the slab and an index in it. With a \c soft_ptr as \p ArrPtr
+ * it is the \a heap_safe iterator, the \a stack_only one is \c flat_hashtable_stack_only_iterator .
+ * Dereference checks the slot is still full, so an iterator to an erased element throws,
+ * and an iterator to a slab that was deallocated will throw at \c soft_ptr dereference.
+ */
+template <typename T, typename Slot, bool is_const, typename ArrPtr>
+class flat_hashtable_iterator
+{
+protected:
+	typedef flat_hashtable_iterator<T, Slot, is_const, ArrPtr>    this_type;
+	typedef flat_hashtable_iterator<T, Slot, false, ArrPtr>       this_type_non_const;
+	typedef flat_hash_layout<Slot>                                layout;
+
+	typedef ArrPtr                                                array_pointer;
+
+	static constexpr bool is_raw_pointer = std::is_pointer<array_pointer>::value;
+
+	// for non-const to const conversion
+	template<typename, typename, bool, typename>
+	friend class flat_hashtable_iterator;
+
+	template<typename TT>
+	static constexpr bool sfinae = is_const && std::is_same_v<TT, this_type_non_const>;
+
+public:
+	typedef std::forward_iterator_tag                   iterator_category;
+	typedef std::conditional_t<is_const, const T, T>    value_type;
+	typedef eastl_ssize_t                               difference_type;
+	typedef eastl_size_t                                size_type;
+	typedef value_type*                                 pointer;
+	typedef value_type&                                 reference;
+
+protected:
+	array_pointer _array = nullptr;
+	size_type _index = 0;
+	size_type _capacity = 0;
+
+	constexpr flat_hashtable_iterator(array_pointer arr, size_type ix, size_type capacity)
+		: _array(arr), _index(ix), _capacity(capacity) {}
+
+	[[noreturn]] static void ThrowRangeException() { throw nodecpp::error::out_of_range; }
+	[[noreturn]] static void ThrowNullException() { throw nodecpp::error::zero_pointer_access; }
+	[[noreturn]] static void ThrowInvalidArgumentException() { throw nodecpp::error::out_of_range; }
+
+	const flexible_array<Slot>* rawArray() const {
+		if constexpr (is_raw_pointer)
+			return _array;
+		else
+			return _array ? &*_array : nullptr;
+	}
+
+	pointer getDereferenceablePtr() const {
+		if(!_array)
+			ThrowNullException();
+		if(_index >= _capacity)
+			ThrowRangeException();
+
+		const flexible_array<Slot>* arr = &*_array;
+		if(!flat_ctrl_is_full(layout::ctrl(arr, _capacity)[_index]))
+			ThrowRangeException(); // element was erased
+
+		return reinterpret_cast<pointer>(const_cast<Slot*>(arr->data()) + _index);
+	}
+
+public:
+	constexpr flat_hashtable_iterator() {}
+
+	/// static factory methods are unsafe but static checker tool will keep user hands away
+	static constexpr this_type makeIx(array_pointer arr, size_type ix, size_type capacity) {
+		return {arr, ix, capacity};
+	}
+
+	flat_hashtable_iterator(const flat_hashtable_iterator& ri) = default;
+	flat_hashtable_iterator& operator=(const flat_hashtable_iterator& ri) = default;
+
+	flat_hashtable_iterator(flat_hashtable_iterator&& ri) = default; 
+	flat_hashtable_iterator& operator=(flat_hashtable_iterator&& ri) = default;
+
+	/// allow non-const to const constructor
+	template<typename Other, std::enable_if_t<sfinae<Other>, bool> = true>
+	flat_hashtable_iterator(const Other& ri)
+		: _array(ri._array), _index(ri._index), _capacity(ri._capacity) {}
+
+	/// allow non-const to const assignment
+	template<typename Other, std::enable_if_t<sfinae<Other>, bool> = true>
+	flat_hashtable_iterator& operator=(const Other& ri) {
+		this->_array = ri._array;
+		this->_index = ri._index;
+		this->_capacity = ri._capacity;
+		return *this;
+	}
+
+	reference operator*() const { return *getDereferenceablePtr(); }
+	pointer operator->() const { return getDereferenceablePtr(); }
+
+	this_type& operator++() {
+		const flexible_array<Slot>* arr = rawArray();
+		if(arr) {
+			const flat_ctrl_t* ctrl = layout::ctrl(arr, _capacity);
+			do {
+				++_index;
+			} while(_index < _capacity && !flat_ctrl_is_full(ctrl[_index]));
+		}
+		return *this;
+	}
+
+	this_type operator++(int) { this_type ri(*this); operator++(); return ri; }
+
+	bool operator==(const this_type& ri) const {
+		return _array == ri._array && _index == ri._index;
+	}
+
+	bool operator!=(const this_type& ri) const {
+		return !operator==(ri);
+	}
+
+	/**
+	 * \brief Index of the slot in the slab \p arr , checking iterator belongs to it.
+	 * 
+	 * Called on all iterators coming from user side before they are used by the table.
+	 */
+	size_type toIndex(const flexible_array<Slot>* arr) const {
+		if(rawArray() != arr)
+			ThrowInvalidArgumentException();
+		return _index;
+	}
+};
+
+
+/**
+ * \brief Stack only iterator of \c flat_hashtable.
+ * 
+ * This iterator is exactly identical to \c flat_hashtable_iterator over a raw pointer
+ * but checker will enforce a different set of rules for it (same as \c array_stack_only_iterator ).
+ */
+template <typename T, typename Slot, bool is_const>
+class flat_hashtable_stack_only_iterator :protected flat_hashtable_iterator<T, Slot, is_const, flexible_array<Slot>*>
+{
+protected:
+	typedef flat_hashtable_stack_only_iterator<T, Slot, is_const>           this_type;
+	typedef flat_hashtable_stack_only_iterator<T, Slot, false>              this_type_non_const;
+	typedef flat_hashtable_iterator<T, Slot, is_const, flexible_array<Slot>*> base_type;
+	typedef typename base_type::array_pointer                               array_pointer;
+
+	// for non-const to const conversion
+	template<typename, typename, bool>
+	friend class flat_hashtable_stack_only_iterator;
+
+	template<typename TT>
+	static constexpr bool sfinae = is_const && std::is_same_v<TT, this_type_non_const>;
+
+public:
+	typedef typename base_type::iterator_category  iterator_category;
+	typedef typename base_type::value_type         value_type;
+	typedef typename base_type::difference_type    difference_type;
+	typedef typename base_type::size_type          size_type;
+	typedef typename base_type::pointer            pointer;
+	typedef typename base_type::reference          reference;
+
+protected:
+	constexpr flat_hashtable_stack_only_iterator(const base_type& ri)
+		: base_type(ri) {}
+
+public:
+	constexpr flat_hashtable_stack_only_iterator() :base_type() {}
+
+	/// static factory methods are unsafe but static checker tool will keep user hands away
+	static constexpr this_type makeIx(array_pointer arr, size_type ix, size_type capacity) {
+		return base_type::makeIx(arr, ix, capacity);
+	}
+
+	flat_hashtable_stack_only_iterator(const flat_hashtable_stack_only_iterator& ri) = default;
+	flat_hashtable_stack_only_iterator& operator=(const flat_hashtable_stack_only_iterator& ri) = default;
+
+	flat_hashtable_stack_only_iterator(flat_hashtable_stack_only_iterator&& ri) = default; 
+	flat_hashtable_stack_only_iterator& operator=(flat_hashtable_stack_only_iterator&& ri) = default;
+
+	/// allow non-const to const constructor
+	template<typename Other, std::enable_if_t<sfinae<Other>, bool> = true>
+	flat_hashtable_stack_only_iterator(const Other& ri)
+		: base_type(static_cast<const typename Other::base_type&>(ri)) {}
+
+	/// allow non-const to const assignment
+	template<typename Other, std::enable_if_t<sfinae<Other>, bool> = true>
+	flat_hashtable_stack_only_iterator& operator=(const Other& ri) {
+		base_type::operator=(static_cast<const typename Other::base_type&>(ri));
+		return *this;
+	}
+
+	using base_type::operator*;
+	using base_type::operator->;
+
+	this_type& operator++() { base_type::operator++(); return *this; }
+	this_type operator++(int) { this_type ri(*this); base_type::operator++(); return ri; }
+
+	bool operator==(const this_type& ri) const { return base_type::operator==(ri); }
+	bool operator!=(const this_type& ri) const { return base_type::operator!=(ri); }
+
+	using base_type::toIndex;
+};
+
+
+/**
+ * \brief Implementation of \c flat_hash_map and \c flat_hash_set.
+ * 
+ * \p Policy provides \c key_type, \c value_type, \c key(value) and \c relocate(dst, src)
+ * (move-construct at \c dst and destroy \c src ).
+ * 
+ * Hash values are mixed before use, so an identity hash of integers is fine.
+ * Erased slots are marked as deleted (tombstones), that are cleaned up at the next rehash.
+ */
+template <typename Policy, typename Hash, typename Predicate, memory_safety Safety>
+class flat_hashtable
+{
+public:
+	typedef flat_hashtable<Policy, Hash, Predicate, Safety>                    this_type;
+	typedef typename Policy::key_type                                          key_type;
+	typedef typename Policy::value_type                                        value_type;
+	typedef value_type&                                                        reference;
+	typedef const value_type&                                                  const_reference;
+	typedef eastl_size_t                                                       size_type;
+	typedef eastl_ssize_t                                                      difference_type;
+	typedef Hash                                                               hasher;
+	typedef Predicate                                                          key_equal;
+	typedef allocator_to_eastl_hashtable<Safety>                               allocator_type;
+
+	struct slot_type { alignas(value_type) unsigned char buff[sizeof(value_type)]; };
+	typedef flat_hash_layout<slot_type>                                        layout;
+
+	typedef typename allocator_type::template array_pointer<slot_type>        array_pointer;
+	typedef typename allocator_type::template soft_array_pointer<slot_type>   soft_array_pointer;
+
+	typedef flat_hashtable_stack_only_iterator<value_type, slot_type, false>                   stack_only_iterator;
+	typedef flat_hashtable_stack_only_iterator<value_type, slot_type, true>                    const_stack_only_iterator;
+	typedef flat_hashtable_iterator<value_type, slot_type, false, soft_array_pointer>          heap_safe_iterator;
+	typedef flat_hashtable_iterator<value_type, slot_type, true, soft_array_pointer>           const_heap_safe_iterator;
+
+	typedef stack_only_iterator                                                iterator;
+	typedef const_stack_only_iterator                                          const_iterator;
+	typedef heap_safe_iterator                                                 iterator_safe;
+	typedef const_heap_safe_iterator                                           const_iterator_safe;
+	typedef eastl::pair<iterator, bool>                                        insert_return_type;
+	typedef eastl::pair<iterator_safe, bool>                                   insert_return_type_safe;
+
+	static constexpr memory_safety is_safe = Safety;
+	static constexpr size_type min_capacity = flat_group::width;
+
+protected:
+	array_pointer mpSlab;
+	size_type mnCapacity = 0; // 0 or a power of 2, not less than min_capacity
+	size_type mnSize = 0;
+	size_type mnGrowthLeft = 0; // empty slots that still can be taken before rehash
+	Hash mHash;
+	Predicate mEqual;
+
+public:
+	flat_hashtable() {}
+	explicit flat_hashtable(size_type n, const Hash& hashFunction = Hash(), const Predicate& predicate = Predicate())
+		: mHash(hashFunction), mEqual(predicate) { reserve(n); }
+	flat_hashtable(const this_type& x) : mHash(x.mHash), mEqual(x.mEqual) { copyFrom(x); }
+	flat_hashtable(this_type&& x) noexcept : mHash(x.mHash), mEqual(x.mEqual) { stealFrom(x); }
+	flat_hashtable(std::initializer_list<value_type> ilist, size_type n = 0, const Hash& hashFunction = Hash(), const Predicate& predicate = Predicate())
+		: mHash(hashFunction), mEqual(predicate) {
+		reserve(n > ilist.size() ? n : ilist.size());
+		insert(ilist);
+	}
+
+	~flat_hashtable() { destroySlab(); }
+
+	this_type& operator=(const this_type& x) {
+		if(this != &x) {
+			destroySlab();
+			mHash = x.mHash;
+			mEqual = x.mEqual;
+			copyFrom(x);
+		}
+		return *this;
+	}
+
+	this_type& operator=(this_type&& x) noexcept {
+		if(this != &x) {
+			destroySlab();
+			mHash = x.mHash;
+			mEqual = x.mEqual;
+			stealFrom(x);
+		}
+		return *this;
+	}
+
+	this_type& operator=(std::initializer_list<value_type> ilist) {
+		clear();
+		insert(ilist);
+		return *this;
+	}
+
+	void swap(this_type& x) noexcept {
+		std::swap(mpSlab, x.mpSlab);
+		std::swap(mnCapacity, x.mnCapacity);
+		std::swap(mnSize, x.mnSize);
+		std::swap(mnGrowthLeft, x.mnGrowthLeft);
+		std::swap(mHash, x.mHash);
+		std::swap(mEqual, x.mEqual);
+	}
+
+	iterator       begin() { return makeIt(firstFull()); }
+	const_iterator begin() const { return makeIt(firstFull()); }
+	const_iterator cbegin() const { return makeIt(firstFull()); }
+
+	iterator       end() { return makeIt(mnCapacity); }
+	const_iterator end() const { return makeIt(mnCapacity); }
+	const_iterator cend() const { return makeIt(mnCapacity); }
+
+	iterator_safe       begin_safe() { return makeSafeIt(firstFull()); }
+	const_iterator_safe begin_safe() const { return makeSafeIt(firstFull()); }
+	const_iterator_safe cbegin_safe() const { return makeSafeIt(firstFull()); }
+
+	iterator_safe       end_safe() { return makeSafeIt(mnCapacity); }
+	const_iterator_safe end_safe() const { return makeSafeIt(mnCapacity); }
+	const_iterator_safe cend_safe() const { return makeSafeIt(mnCapacity); }
+
+	bool empty() const noexcept { return mnSize == 0; }
+	size_type size() const noexcept { return mnSize; }
+	size_type capacity() const noexcept { return mnCapacity; }
+	size_type bucket_count() const noexcept { return mnCapacity; }
+	float load_factor() const noexcept { return mnCapacity ? (float)mnSize / (float)mnCapacity : 0.f; }
+
+	hasher hash_function() const { return mHash; }
+	key_equal key_eq() const { return mEqual; }
+
+	insert_return_type insert(const value_type& value) { return makeIt(emplaceImpl(value)); }
+	insert_return_type insert(value_type&& value) { return makeIt(emplaceImpl(std::move(value))); }
+	insert_return_type_safe insert_safe(const value_type& value) { return makeSafeIt(emplaceImpl(value)); }
+	insert_return_type_safe insert_safe(value_type&& value) { return makeSafeIt(emplaceImpl(std::move(value))); }
+
+	void insert(std::initializer_list<value_type> ilist) {
+		for(const value_type& value : ilist)
+			emplaceImpl(value);
+	}
+
+	template <typename InputIterator>
+	void insert_unsafe(InputIterator first, InputIterator last) {
+		for(; first != last; ++first)
+			emplaceImpl(*first);
+	}
+
+	template <class... Args>
+	insert_return_type emplace(Args&&... args) { return makeIt(emplaceImpl(value_type(std::forward<Args>(args)...))); }
+
+	template <class... Args>
+	insert_return_type_safe emplace_safe(Args&&... args) { return makeSafeIt(emplaceImpl(value_type(std::forward<Args>(args)...))); }
+
+	iterator       find(const key_type& key) { return makeIt(findIndex(key)); }
+	const_iterator find(const key_type& key) const { return makeIt(findIndex(key)); }
+	iterator_safe       find_safe(const key_type& key) { return makeSafeIt(findIndex(key)); }
+	const_iterator_safe find_safe(const key_type& key) const { return makeSafeIt(findIndex(key)); }
+
+	size_type count(const key_type& key) const { return findIndex(key) != mnCapacity ? 1 : 0; }
+	bool contains(const key_type& key) const { return findIndex(key) != mnCapacity; }
+
+	iterator erase(const const_iterator& position) { return makeIt(eraseAt(toIndex(position))); }
+	iterator_safe erase_safe(const const_iterator_safe& position) { return makeSafeIt(eraseAt(toIndex(position))); }
+
+	iterator erase(const const_iterator& first, const const_iterator& last) {
+		return makeIt(eraseRange(toIndex(first), toIndex(last)));
+	}
+
+	iterator_safe erase_safe(const const_iterator_safe& first, const const_iterator_safe& last) {
+		return makeSafeIt(eraseRange(toIndex(first), toIndex(last)));
+	}
+
+	size_type erase(const key_type& key) {
+		size_type ix = findIndex(key);
+		if(ix == mnCapacity)
+			return 0;
+		eraseAt(ix);
+		return 1;
+	}
+
+	void clear() {
+		if(mnCapacity == 0)
+			return;
+		destroyElements();
+		std::memset(ctrl(), (uint8_t)flat_ctrl_empty, layout::ctrlByteCount(mnCapacity));
+		mnSize = 0;
+		mnGrowthLeft = capacityToGrowth(mnCapacity);
+	}
+
+	void reserve(size_type nElementCount) {
+		if(nElementCount > mnSize + mnGrowthLeft)
+			resize(growthToCapacity(nElementCount));
+	}
+
+	void rehash(size_type nCapacity) {
+		size_type c = growthToCapacity(mnSize);
+		while(c < nCapacity)
+			c *= 2;
+		resize(c);
+	}
+
+	iterator_safe make_safe(const const_iterator& it) { return makeSafeIt(toIndex(it)); }
+	const_iterator_safe make_safe(const const_iterator& it) const { return makeSafeIt(toIndex(it)); }
+
+	bool operator==(const this_type& other) const {
+		if(mnSize != other.mnSize)
+			return false;
+		for(size_type i = 0; i < mnCapacity; ++i) {
+			if(flat_ctrl_is_full(ctrl()[i])) {
+				size_type j = other.findIndex(Policy::key(slotAt(i)));
+				if(j == other.mnCapacity || !(other.slotAt(j) == slotAt(i)))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool operator!=(const this_type& other) const { return !operator==(other); }
+
+protected:
+	[[noreturn]] static void ThrowRangeException() { throw nodecpp::error::out_of_range; }
+
+	static size_type capacityToGrowth(size_type capacity) { return capacity - capacity / 8; } // max load factor is 7/8
+	static size_type growthToCapacity(size_type growth) {
+		size_type c = min_capacity;
+		while(capacityToGrowth(c) < growth)
+			c *= 2;
+		return c;
+	}
+
+	flexible_array<slot_type>* rawSlab() const { return mpSlab.get_raw_ptr(); }
+	flat_ctrl_t* ctrl() const { return layout::ctrl(rawSlab(), mnCapacity); }
+	value_type& slotAt(size_type ix) const { return *reinterpret_cast<value_type*>(rawSlab()->data() + ix); }
+
+	// control bytes of the first group are cloned after the last one
+	void setCtrl(size_type ix, flat_ctrl_t c) {
+		flat_ctrl_t* ct = ctrl();
+		ct[ix] = c;
+		if(ix < flat_group::width)
+			ct[mnCapacity + ix] = c;
+	}
+
+	// hash is mixed, as probing start is taken from low bits and 7 bits of control byte from high ones,
+	// high half is folded into low one, so that keys differing only in high bits don't collide
+	size_t hashOf(const key_type& key) const {
+		constexpr size_t halfBits = sizeof(size_t) * 4;
+		size_t h;
+		if constexpr (sizeof(size_t) == 8)
+			h = static_cast<size_t>(mHash(key)) * (size_t)0x9E3779B97F4A7C15ull;
+		else
+			h = static_cast<size_t>(mHash(key)) * (size_t)0x9E3779B9u;
+		return h ^ (h >> halfBits);
+	}
+	static flat_ctrl_t h2(size_t h) { return static_cast<flat_ctrl_t>(h >> (sizeof(size_t) * 8 - 7)); }
+
+	// returns mnCapacity if not found
+	size_type findIndex(const key_type& key) const {
+		if(mnSize == 0)
+			return mnCapacity;
+		size_t h = hashOf(key);
+		const flat_ctrl_t* ct = ctrl();
+		size_type mask = mnCapacity - 1;
+		size_type pos = h & mask;
+		size_type step = 0;
+		for(;;) {
+			flat_group g(ct + pos);
+			for(auto m = g.match(h2(h)); m; m.clear_lowest()) {
+				size_type ix = (pos + m.lowest()) & mask;
+				if(NODECPP_LIKELY(mEqual(Policy::key(slotAt(ix)), key)))
+					return ix;
+			}
+			if(g.match_empty())
+				return mnCapacity;
+			// triangular probing visits every group, as number of groups is a power of 2
+			step += flat_group::width;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	size_type findFirstNonFull(size_t h) const {
+		const flat_ctrl_t* ct = ctrl();
+		size_type mask = mnCapacity - 1;
+		size_type pos = h & mask;
+		size_type step = 0;
+		for(;;) {
+			auto m = flat_group(ct + pos).match_empty_or_deleted();
+			if(m)
+				return (pos + m.lowest()) & mask;
+			step += flat_group::width;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	// takes a slot for an element with hash h (which is not in the table yet)
+	size_type prepareInsert(size_t h) {
+		if(mnCapacity == 0) {
+			resize(min_capacity);
+		}
+		size_type ix = findFirstNonFull(h);
+		if(NODECPP_UNLIKELY(mnGrowthLeft == 0 && ctrl()[ix] != flat_ctrl_deleted)) {
+			// with many tombstones rehash to the same capacity, otherwise grow
+			resize(mnSize * 2 <= capacityToGrowth(mnCapacity) ? mnCapacity : mnCapacity * 2);
+			ix = findFirstNonFull(h);
+		}
+		if(ctrl()[ix] == flat_ctrl_empty)
+			--mnGrowthLeft;
+		setCtrl(ix, h2(h));
+		++mnSize;
+		return ix;
+	}
+
+	// true if taking a slot for an element with hash h will rehash (and so move all elements)
+	bool insertWillRehash(size_t h) const {
+		return mnCapacity != 0 && mnGrowthLeft == 0 && ctrl()[findFirstNonFull(h)] != flat_ctrl_deleted;
+	}
+
+	// constructs element from args only if key is not in the table yet
+	template <class... Args>
+	eastl::pair<size_type, bool> emplaceKeyImpl(const key_type& key, Args&&... args) {
+		size_type ix = findIndex(key);
+		if(ix != mnCapacity)
+			return { ix, false };
+		size_t h = hashOf(key);
+		if(NODECPP_UNLIKELY(insertWillRehash(h))) {
+			// key and args may refer to elements of the slab that rehash releases,
+			// so element is constructed aside first and relocated after rehash
+			slot_type tmp;
+			value_type* val = ::new (&tmp) value_type(std::forward<Args>(args)...);
+			try {
+				ix = prepareInsert(h);
+			}
+			catch(...) {
+				val->~value_type();
+				throw;
+			}
+			Policy::relocate(&slotAt(ix), val);
+			return { ix, true };
+		}
+		ix = prepareInsert(h);
+		constructAt(ix, std::forward<Args>(args)...);
+		return { ix, true };
+	}
+
+	template <class V>
+	eastl::pair<size_type, bool> emplaceImpl(V&& value) {
+		return emplaceKeyImpl(Policy::key(value), std::forward<V>(value));
+	}
+
+	template <class... Args>
+	void constructAt(size_type ix, Args&&... args) {
+		try {
+			::new (&slotAt(ix)) value_type(std::forward<Args>(args)...);
+		}
+		catch(...) {
+			setCtrl(ix, flat_ctrl_deleted);
+			--mnSize;
+			throw;
+		}
+	}
+
+	size_type eraseAt(size_type ix) {
+		if(ix >= mnCapacity || !flat_ctrl_is_full(ctrl()[ix]))
+			ThrowRangeException();
+		slotAt(ix).~value_type();
+		setCtrl(ix, flat_ctrl_deleted);
+		--mnSize;
+		return nextFull(ix);
+	}
+
+	size_type eraseRange(size_type first, size_type last) {
+		if(last > mnCapacity || first > last)
+			ThrowRangeException();
+		for(size_type ix = first; ix < last; ++ix) {
+			if(flat_ctrl_is_full(ctrl()[ix])) {
+				slotAt(ix).~value_type();
+				setCtrl(ix, flat_ctrl_deleted);
+				--mnSize;
+			}
+		}
+		return last;
+	}
+
+	size_type nextFull(size_type ix) const {
+		const flat_ctrl_t* ct = ctrl();
+		do {
+			++ix;
+		} while(ix < mnCapacity && !flat_ctrl_is_full(ct[ix]));
+		return ix;
+	}
+
+	size_type firstFull() const {
+		if(mnSize == 0)
+			return mnCapacity;
+		return flat_ctrl_is_full(ctrl()[0]) ? 0 : nextFull(0);
+	}
+
+	void resize(size_type newCapacity) {
+		NODECPP_ASSERT(module_id, nodecpp::assert::AssertLevel::regular, newCapacity >= min_capacity && (newCapacity & (newCapacity - 1)) == 0);
+		NODECPP_ASSERT(module_id, nodecpp::assert::AssertLevel::regular, capacityToGrowth(newCapacity) >= mnSize);
+		allocator_type alloc;
+		array_pointer oldSlab = mpSlab;
+		size_type oldCapacity = mnCapacity;
+
+		mpSlab = alloc.template allocate_array<slot_type>(layout::slabSize(newCapacity));
+		mnCapacity = newCapacity;
+		std::memset(ctrl(), (uint8_t)flat_ctrl_empty, layout::ctrlByteCount(newCapacity));
+		mnGrowthLeft = capacityToGrowth(newCapacity) - mnSize;
+
+		if(oldSlab) {
+			const flat_ctrl_t* oldCtrl = layout::ctrl(oldSlab.get_raw_ptr(), oldCapacity);
+			slot_type* oldSlots = oldSlab.get_raw_ptr()->data();
+			for(size_type i = 0; i < oldCapacity; ++i) {
+				if(flat_ctrl_is_full(oldCtrl[i])) {
+					value_type* src = reinterpret_cast<value_type*>(oldSlots + i);
+					size_t h = hashOf(Policy::key(*src));
+					size_type ix = findFirstNonFull(h);
+					setCtrl(ix, h2(h));
+					Policy::relocate(&slotAt(ix), src);
+				}
+			}
+			alloc.template deallocate_array<slot_type>(oldSlab, layout::slabSize(oldCapacity));
+		}
+	}
+
+	void destroyElements() {
+		if constexpr (!std::is_trivially_destructible_v<value_type>) {
+			const flat_ctrl_t* ct = ctrl();
+			for(size_type i = 0; i < mnCapacity; ++i)
+				if(flat_ctrl_is_full(ct[i]))
+					slotAt(i).~value_type();
+		}
+	}
+
+	void destroySlab() {
+		if(mpSlab) {
+			destroyElements();
+			allocator_type alloc;
+			alloc.template deallocate_array<slot_type>(mpSlab, layout::slabSize(mnCapacity));
+			mpSlab = nullptr;
+		}
+		mnCapacity = 0;
+		mnSize = 0;
+		mnGrowthLeft = 0;
+	}
+
+	void copyFrom(const this_type& x) {
+		if(x.mnSize == 0)
+			return;
+		reserve(x.mnSize);
+		const flat_ctrl_t* ct = x.ctrl();
+		for(size_type i = 0; i < x.mnCapacity; ++i) {
+			if(flat_ctrl_is_full(ct[i])) {
+				const value_type& value = x.slotAt(i);
+				constructAt(prepareInsert(hashOf(Policy::key(value))), value);
+			}
+		}
+	}
+
+	void stealFrom(this_type& x) {
+		mpSlab = x.mpSlab;
+		mnCapacity = x.mnCapacity;
+		mnSize = x.mnSize;
+		mnGrowthLeft = x.mnGrowthLeft;
+		x.mpSlab = nullptr;
+		x.mnCapacity = 0;
+		x.mnSize = 0;
+		x.mnGrowthLeft = 0;
+	}
+
+	template <class It>
+	size_type toIndex(const It& it) const { return it.toIndex(rawSlab()); }
+
+	iterator makeIt(size_type ix) { return iterator::makeIx(rawSlab(), ix, mnCapacity); }
+	const_iterator makeIt(size_type ix) const { return const_iterator::makeIx(rawSlab(), ix, mnCapacity); }
+	insert_return_type makeIt(const eastl::pair<size_type, bool>& r) { return { makeIt(r.first), r.second }; }
+
+	iterator_safe makeSafeIt(size_type ix) { return iterator_safe::makeIx(allocator_type::to_soft(mpSlab), ix, mnCapacity); }
+	const_iterator_safe makeSafeIt(size_type ix) const { return const_iterator_safe::makeIx(allocator_type::to_soft(mpSlab), ix, mnCapacity); }
+	insert_return_type_safe makeSafeIt(const eastl::pair<size_type, bool>& r) { return { makeSafeIt(r.first), r.second }; }
+};
+
+} // namespace safememory::detail
+
+#endif // SAFE_MEMORY_DETAIL_FLAT_HASHTABLE_H
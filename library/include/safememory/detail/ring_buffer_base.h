@@ -0,0 +1,418 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_DETAIL_RING_BUFFER_BASE_H
+#define SAFE_MEMORY_DETAIL_RING_BUFFER_BASE_H
+
+#include <utility>
+#include <memory> // for std::uninitialized_move and friends
+#include <algorithm>
+#include <limits>
+#include <initializer_list>
+#include <safememory/detail/allocator_to_eastl.h>
+
+/** \file
+ * \brief Storage of \c safememory::deque and \c safememory::ring_buffer
+ * 
+ * Elements live in a single array allocated through the same allocator as \c safememory::vector
+ * (that is, zombie protected), used as a circular buffer. \c mnBegin is the physical position
+ * of the first element, and logical index \c i is at physical \c (mnBegin+i)%capacity
+ * 
+ * Pushing or popping at either end is O(1) and never moves other elements,
+ * the array is only reallocated when it is full and the container must grow.
+ * 
+ * Like \c small_vector_base this class doesn't check anything, it works with logical indexes
+ * and raw pointers, checks are done at \c safememory::deque
+ */
+
+namespace safememory::detail {
+
+template<typename T, memory_safety Safety>
+class ring_buffer_base
+{
+public:
+	typedef ring_buffer_base<T, Safety>                              this_type;
+	typedef allocator_to_eastl_vector<Safety>                        allocator_type;
+	typedef typename allocator_type::template array_pointer<T>      array_pointer;
+
+	typedef T                                                        value_type;
+	typedef T*                                                       pointer;
+	typedef const T*                                                 const_pointer;
+	typedef T&                                                       reference;
+	typedef const T&                                                 const_reference;
+	typedef eastl_size_t                                             size_type;
+	typedef eastl_ssize_t                                            difference_type;
+
+protected:
+	array_pointer mpBuffer; // null while capacity is zero
+	size_type mnCapacity = 0;
+	size_type mnBegin = 0;
+	size_type mnSize = 0;
+
+public:
+	ring_buffer_base() {}
+	explicit ring_buffer_base(size_type n) { resize(n); }
+	ring_buffer_base(size_type n, const value_type& value) { assign(n, value); }
+	ring_buffer_base(std::initializer_list<value_type> ilist) { assign(ilist); }
+
+	ring_buffer_base(const this_type& x) { copyFrom(x); }
+	ring_buffer_base(this_type&& x) noexcept { moveFrom(x); }
+
+	~ring_buffer_base() {
+		clear();
+		freeBuffer();
+	}
+
+	this_type& operator=(const this_type& x) {
+		if(this != &x)
+			copyFrom(x);
+		return *this;
+	}
+
+	this_type& operator=(this_type&& x) noexcept {
+		if(this != &x) {
+			clear();
+			freeBuffer();
+			moveFrom(x);
+		}
+		return *this;
+	}
+
+	this_type& operator=(std::initializer_list<value_type> ilist) {
+		assign(ilist);
+		return *this;
+	}
+
+	void swap(this_type& x) noexcept {
+		// elements never move, only the array changes hands
+		mpBuffer.swap(x.mpBuffer);
+		std::swap(mnCapacity, x.mnCapacity);
+		std::swap(mnBegin, x.mnBegin);
+		std::swap(mnSize, x.mnSize);
+	}
+
+	void assign(size_type n, const value_type& value) {
+		value_type tmp(value); // value may be one of our elements
+		clear();
+		reserve(n);
+		std::uninitialized_fill_n(buffer(), n, tmp);
+		mnSize = n;
+	}
+
+	void assign(std::initializer_list<value_type> ilist) {
+		const size_type n = static_cast<size_type>(ilist.size());
+		clear();
+		reserve(n);
+		std::uninitialized_copy(ilist.begin(), ilist.end(), buffer());
+		mnSize = n;
+	}
+
+	bool empty() const noexcept { return mnSize == 0; }
+	bool full() const noexcept { return mnSize == mnCapacity; }
+	size_type size() const noexcept { return mnSize; }
+	size_type capacity() const noexcept { return mnCapacity; }
+	size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+	/// physical position of the first element
+	size_type head() const noexcept { return mnBegin; }
+
+	pointer       buffer() noexcept { return mpBuffer ? allocator_type::to_raw(mpBuffer) : nullptr; }
+	const_pointer buffer() const noexcept { return mpBuffer ? allocator_type::to_raw(mpBuffer) : nullptr; }
+
+	/// pointer to logical index \p ix , valid for \c ix<capacity()
+	pointer       slot(size_type ix) noexcept { return buffer() + physical(ix); }
+	const_pointer slot(size_type ix) const noexcept { return buffer() + physical(ix); }
+
+	void reserve(size_type n) {
+		if(n > mnCapacity)
+			reallocate(n);
+	}
+
+	void resize(size_type n) {
+		if(n > mnSize) {
+			reserve(n);
+			while(mnSize < n) {
+				::new(static_cast<void*>(slot(mnSize))) value_type();
+				++mnSize;
+			}
+		}
+		else
+			eraseBack(mnSize - n);
+	}
+
+	void resize(size_type n, const value_type& value) {
+		if(n > mnSize) {
+			value_type tmp(value);
+			reserve(n);
+			while(mnSize < n) {
+				::new(static_cast<void*>(slot(mnSize))) value_type(tmp);
+				++mnSize;
+			}
+		}
+		else
+			eraseBack(mnSize - n);
+	}
+
+	void shrink_to_fit() {
+		if(mnSize == mnCapacity)
+			return;
+
+		if(mnSize == 0)
+			freeBuffer();
+		else
+			reallocate(mnSize);
+	}
+
+	/**
+	 * \brief Change the capacity to exactly \p n
+	 * 
+	 * Like \c eastl::ring_buffer when \p n is lower than \c size() the newest elements are kept,
+	 * and the ones at the front are destroyed.
+	 */
+	void set_capacity(size_type n) {
+		if(n == mnCapacity)
+			return;
+
+		if(n < mnSize)
+			eraseFront(mnSize - n);
+
+		if(n == 0)
+			freeBuffer();
+		else
+			reallocate(n);
+	}
+
+	void clear() noexcept {
+		eraseBack(mnSize);
+		mnBegin = 0;
+	}
+
+	template<class... Args>
+	reference emplace_back(Args&&... args) {
+		if(mnSize == mnCapacity) {
+			value_type tmp(std::forward<Args>(args)...); // args may reference our elements
+			reallocate(growCapacity(mnSize + 1));
+			::new(static_cast<void*>(slot(mnSize))) value_type(std::move(tmp));
+		}
+		else
+			::new(static_cast<void*>(slot(mnSize))) value_type(std::forward<Args>(args)...);
+
+		++mnSize;
+		return *slot(mnSize - 1);
+	}
+
+	template<class... Args>
+	reference emplace_front(Args&&... args) {
+		if(mnSize == mnCapacity) {
+			value_type tmp(std::forward<Args>(args)...); // args may reference our elements
+			reallocate(growCapacity(mnSize + 1));
+			::new(static_cast<void*>(slot(mnCapacity - 1))) value_type(std::move(tmp));
+		}
+		else
+			::new(static_cast<void*>(slot(mnCapacity - 1))) value_type(std::forward<Args>(args)...);
+
+		mnBegin = physical(mnCapacity - 1);
+		++mnSize;
+		return *slot(0);
+	}
+
+	/// when full, the new element replaces the front one. Only grows when capacity is zero
+	template<class... Args>
+	reference emplace_back_overwrite(Args&&... args) {
+		if(mnSize == mnCapacity && mnCapacity != 0) {
+			value_type tmp(std::forward<Args>(args)...);
+			pointer p = slot(0);
+			p->~value_type();
+			::new(static_cast<void*>(p)) value_type(std::move(tmp));
+			mnBegin = physical(1);
+			return *p;
+		}
+		else
+			return emplace_back(std::forward<Args>(args)...);
+	}
+
+	/// when full, the new element replaces the back one. Only grows when capacity is zero
+	template<class... Args>
+	reference emplace_front_overwrite(Args&&... args) {
+		if(mnSize == mnCapacity && mnCapacity != 0) {
+			value_type tmp(std::forward<Args>(args)...);
+			pointer p = slot(mnSize - 1);
+			p->~value_type();
+			::new(static_cast<void*>(p)) value_type(std::move(tmp));
+			mnBegin = physical(mnCapacity - 1);
+			return *p;
+		}
+		else
+			return emplace_front(std::forward<Args>(args)...);
+	}
+
+	void pop_front() {
+		slot(0)->~value_type();
+		mnBegin = physical(1);
+		--mnSize;
+	}
+
+	void pop_back() {
+		--mnSize;
+		slot(mnSize)->~value_type();
+	}
+
+	/// insert at logical index \p ix , moving the shorter side of the buffer
+	template<class... Args>
+	void emplace(size_type ix, Args&&... args) {
+		if(ix == mnSize) {
+			emplace_back(std::forward<Args>(args)...);
+			return;
+		}
+		else if(ix == 0) {
+			emplace_front(std::forward<Args>(args)...);
+			return;
+		}
+
+		value_type tmp(std::forward<Args>(args)...); // args may reference elements we are about to move
+		if(ix < mnSize / 2) {
+			emplace_front(std::move(*slot(0)));
+			for(size_type i = 1; i < ix; ++i)
+				*slot(i) = std::move(*slot(i + 1));
+		}
+		else {
+			emplace_back(std::move(*slot(mnSize - 1)));
+			for(size_type i = mnSize - 2; i > ix; --i)
+				*slot(i) = std::move(*slot(i - 1));
+		}
+		*slot(ix) = std::move(tmp);
+	}
+
+	/// erase logical range [first, last), moving the shorter side of the buffer
+	void erase(size_type first, size_type last) {
+		const size_type n = last - first;
+		if(n == 0)
+			return;
+
+		if(first < mnSize - last) {
+			for(size_type i = first; i > 0; --i)
+				*slot(i - 1 + n) = std::move(*slot(i - 1));
+			eraseFront(n);
+		}
+		else {
+			for(size_type i = last; i < mnSize; ++i)
+				*slot(i - n) = std::move(*slot(i));
+			eraseBack(n);
+		}
+	}
+
+protected:
+	size_type physical(size_type ix) const noexcept {
+		const size_type p = mnBegin + ix;
+		return p >= mnCapacity ? p - mnCapacity : p;
+	}
+
+	size_type growCapacity(size_type required) const noexcept {
+		return std::max(required, mnCapacity * 2);
+	}
+
+	void eraseFront(size_type n) noexcept {
+		for(size_type i = 0; i < n; ++i)
+			slot(i)->~value_type();
+		mnBegin = physical(n);
+		mnSize -= n;
+	}
+
+	void eraseBack(size_type n) noexcept {
+		for(size_type i = mnSize - n; i < mnSize; ++i)
+			slot(i)->~value_type();
+		mnSize -= n;
+	}
+
+	void freeBuffer() noexcept {
+		if(mpBuffer) {
+			allocator_type alloc;
+			alloc.template deallocate_array<T>(mpBuffer, mnCapacity);
+			mpBuffer = nullptr;
+		}
+		mnCapacity = 0;
+		mnBegin = 0;
+	}
+
+	/// move elements to a new array of \p newCapacity , the first element goes to position zero
+	void reallocate(size_type newCapacity) {
+		NODECPP_ASSERT(module_id, nodecpp::assert::AssertLevel::regular, newCapacity >= mnSize);
+		allocator_type alloc;
+		array_pointer newBuffer = alloc.template allocate_array<T>(newCapacity);
+		pointer newBegin = allocator_type::to_raw(newBuffer);
+		if(mnSize) {
+			// at most two contiguous segments
+			pointer b = buffer();
+			const size_type first = std::min(mnSize, mnCapacity - mnBegin);
+			try {
+				pointer mid = std::uninitialized_move(b + mnBegin, b + mnBegin + first, newBegin);
+				try {
+					std::uninitialized_move(b, b + (mnSize - first), mid);
+				}
+				catch(...) {
+					std::destroy(newBegin, mid);
+					throw;
+				}
+			}
+			catch(...) {
+				alloc.template deallocate_array<T>(newBuffer, newCapacity);
+				throw;
+			}
+			std::destroy(b + mnBegin, b + mnBegin + first);
+			std::destroy(b, b + (mnSize - first));
+		}
+		freeBuffer();
+		mpBuffer = newBuffer;
+		mnCapacity = newCapacity;
+	}
+
+	void copyFrom(const this_type& x) {
+		clear();
+		reserve(x.mnSize);
+		for(size_type i = 0; i < x.mnSize; ++i) {
+			::new(static_cast<void*>(slot(i))) value_type(*x.slot(i));
+			++mnSize;
+		}
+	}
+
+	/// this must be empty and without array
+	void moveFrom(this_type& x) noexcept {
+		mpBuffer = x.mpBuffer;
+		mnCapacity = x.mnCapacity;
+		mnBegin = x.mnBegin;
+		mnSize = x.mnSize;
+		x.mpBuffer = nullptr;
+		x.mnCapacity = 0;
+		x.mnBegin = 0;
+		x.mnSize = 0;
+	}
+};
+
+} // namespace safememory::detail
+
+#endif // SAFE_MEMORY_DETAIL_RING_BUFFER_BASE_H
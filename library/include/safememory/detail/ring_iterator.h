@@ -0,0 +1,330 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_DETAIL_RING_ITERATOR_H
+#define SAFE_MEMORY_DETAIL_RING_ITERATOR_H
+
+#include <utility>
+#include <iterator> //for std::random_access_iterator_tag
+#include <cstddef>
+#include <safememory/memory_safety.h>
+#include <nodecpp_assert.h>
+#include <safe_memory_error.h>
+#include <safememory/detail/instrument.h>
+#include <safememory/detail/dezombiefy_iterators.h>
+
+namespace safememory::detail {
+
+/**
+ * \brief Safe iterator for circular buffers.
+ * 
+ * Used by \c safememory::deque and \c safememory::ring_buffer.
+ * Same idea as \c array_heap_safe_iterator , it holds a \c soft_ptr to the array
+ * and an index checked on every dereference, but the index is logical, relative to the
+ * position of the first element (the head) at the time the iterator was created.
+ * The physical position wraps around the end of the array.
+ * 
+ * Since the array size is always taken from the array itself, a bad index can only
+ * reach the wrong element, never memory outside the array. And a reallocated array
+ * is detected as zombie by the \c soft_ptr
+ * 
+ * Iterators are invalidated when the head moves (\c push_front and \c pop_front ,
+ * also \c push_back on a full \c ring_buffer ), comparing or passing to the container
+ * an iterator with an old head will throw.
+ * 
+ * All iterators are invalidated when the container is moved or destructed.
+ */
+template <typename T, bool is_const, typename ArrPtr, bool is_dezombiefy = false>
+class ring_heap_safe_iterator
+{
+protected:
+	typedef ring_heap_safe_iterator<T, is_const, ArrPtr, is_dezombiefy>    this_type;
+	typedef ring_heap_safe_iterator<T, false, ArrPtr, is_dezombiefy>       this_type_non_const;
+
+	typedef ArrPtr                                                         array_pointer;
+
+	// for non-const to const conversion
+	template<typename, bool, typename, bool>
+	friend class ring_heap_safe_iterator;
+
+	template<typename TT>
+	static constexpr bool sfinae = is_const && std::is_same_v<TT, this_type_non_const>;
+
+	// default to 'safe', only on soft_ptr_no_checks we can relax to 'none'
+	template <typename>
+	struct ring_heap_safe_iterator_safety_helper {
+		static constexpr memory_safety is_safe = memory_safety::safe;
+	};
+
+	template<typename> class soft_ptr_no_checks; //fwd
+	template<typename TT>
+	struct ring_heap_safe_iterator_safety_helper<soft_ptr_no_checks<TT>> {
+		static constexpr memory_safety is_safe = memory_safety::none;
+	};
+
+public:
+	typedef std::random_access_iterator_tag             iterator_category;
+	typedef std::conditional_t<is_const, const T, T>    value_type;
+	typedef eastl_ssize_t                               difference_type;
+	typedef eastl_size_t                                size_type;
+	typedef value_type*                                 pointer;
+	typedef value_type&                                 reference;
+
+	static constexpr memory_safety is_safe = ring_heap_safe_iterator_safety_helper<array_pointer>::is_safe;
+
+	using size_f_type = std::conditional_t<is_dezombiefy, iterator_dezombiefier, size_type>;
+
+protected:
+	array_pointer _array = nullptr;
+	size_type _head = 0;
+	size_type _index = 0;
+	size_f_type _size = 0;
+
+	/// this ctor is private because it is unsafe and shouldn't be reached by user
+	constexpr ring_heap_safe_iterator(array_pointer arr, size_type head, size_type ix, size_f_type sz)
+		: _array(arr), _head(head), _index(ix), _size(sz) {}
+
+	template <typename Container>
+	constexpr ring_heap_safe_iterator(array_pointer arr, size_type head, size_type ix, Container* container)
+		: _array(arr), _head(head), _index(ix), _size(container) {}
+
+	[[noreturn]] static void ThrowRangeException() { throw nodecpp::error::out_of_range; }
+	[[noreturn]] static void ThrowZombieException() { throw nodecpp::error::early_detected_zombie_pointer_access; }
+	[[noreturn]] static void ThrowNullException() { throw nodecpp::error::zero_pointer_access; }
+	[[noreturn]] static void ThrowInvalidArgumentException() { throw nodecpp::error::out_of_range; }
+
+public:
+	/// default ctor must always be available for iterators
+	constexpr ring_heap_safe_iterator() {}
+
+	/**
+	 * \brief Static factory, unsafe but static checker tool will keep user hands away.
+	 * 
+	 * Without dezombiefy, \p ix is bounded by the capacity of the container,
+	 * like \c array_heap_safe_iterator does on \c vector
+	 */
+	template <typename Container>
+	static constexpr this_type makeIx(array_pointer arr, size_type head, size_type ix, Container* container) {
+
+		if constexpr (is_dezombiefy)
+			return {arr, head, ix, container};
+		else
+			return {arr, head, ix, container->capacity()};
+	}
+
+	ring_heap_safe_iterator(const ring_heap_safe_iterator& ri) = default;
+	ring_heap_safe_iterator& operator=(const ring_heap_safe_iterator& ri) = default;
+
+	ring_heap_safe_iterator(ring_heap_safe_iterator&& ri) = default; 
+	ring_heap_safe_iterator& operator=(ring_heap_safe_iterator&& ri) = default;
+
+	/// allow non-const to const constructor
+	template<typename Other, std::enable_if_t<sfinae<Other>, bool> = true>
+	ring_heap_safe_iterator(const Other& ri)
+		: _array(ri._array), _head(ri._head), _index(ri._index), _size(ri._size) {}
+
+	/// allow non-const to const assignment
+	template<typename Other, std::enable_if_t<sfinae<Other>, bool> = true>
+	ring_heap_safe_iterator& operator=(const Other& ri) {
+		this->_array = ri._array;
+		this->_head = ri._head;
+		this->_index = ri._index;
+		this->_size = ri._size;
+		return *this;
+	}
+
+	~ring_heap_safe_iterator() {
+		_head = 0;
+		_index = 0;
+
+		if constexpr (!is_dezombiefy)
+			_size = 0;
+	}
+
+	reference operator*() const { return *getDereferenceablePtr(_index); }
+	pointer operator->() const { return getDereferenceablePtr(_index); }
+
+	this_type& operator++() noexcept { ++_index; return *this; }
+	this_type& operator--() noexcept { --_index; return *this; }
+
+	this_type operator++(int) noexcept { this_type ri(*this); ++_index; return ri; }
+	this_type operator--(int) noexcept { this_type ri(*this); --_index; return ri; }
+
+	this_type operator+(difference_type n) const noexcept { return this_type(_array, _head, _index + n, _size); }
+	this_type operator-(difference_type n) const noexcept { return this_type(_array, _head, _index - n, _size); }
+
+	this_type& operator+=(difference_type n) noexcept { _index += n; return *this; }
+	this_type& operator-=(difference_type n) noexcept { _index -= n; return *this; }
+
+	reference operator[](difference_type n) const { return *getDereferenceablePtr(_index + n); }
+
+	difference_type operator-(const this_type& ri) const {
+
+		checkSameRing(ri);
+		return static_cast<difference_type>(_index - ri._index);
+	}
+
+	bool operator==(const this_type& ri) const {
+
+		if(_array == ri._array) {
+			if(NODECPP_UNLIKELY(_head != ri._head))
+				ThrowInvalidArgumentException();
+			return _index == ri._index;
+		}
+		else if(!_array || !ri._array)
+			return false;
+		else
+			ThrowInvalidArgumentException();
+	}
+
+	bool operator!=(const this_type& ri) const {
+		return !operator==(ri);
+	}
+
+	bool operator<(const this_type& ri) const {
+
+		if(_array == ri._array) {
+			if(NODECPP_UNLIKELY(_head != ri._head))
+				ThrowInvalidArgumentException();
+			return _index < ri._index;
+		}
+		else if(!_array)
+			return true;
+		else if(!ri._array)
+			return false;
+		else
+			ThrowInvalidArgumentException();
+	}
+
+	bool operator>(const this_type& ri) const {
+		return ri.operator<(*this);
+	}
+
+	bool operator<=(const this_type& ri) const {
+		return !this->operator>(ri);
+	}
+
+	bool operator>=(const this_type& ri) const {
+		return !this->operator<(ri);
+	}
+
+	/**
+	 * \brief Convert this iterator to a logical index of the container.
+	 * 
+	 * Called on all iterators comming from user side, before going into the container.
+	 * We check that this iterator references the array \p arr with the same head
+	 * the container has now. The container still has to check the index against its size.
+	 */
+	size_type toIndex(const T* arr, size_type head) const {
+
+		if constexpr (is_safe == memory_safety::safe) {
+			checkArray(arr, head);
+			checkIndex();
+		}
+
+		return _index;
+	}
+
+	/// same as above, for a pair of iterators, checking also the order
+	std::pair<size_type, size_type> toIndex(const T* arr, size_type head, const this_type& ri) const {
+
+		if constexpr (is_safe == memory_safety::safe) {
+			checkArray(arr, head);
+			ri.checkArray(arr, head);
+			if(NODECPP_UNLIKELY(!(_index <= ri._index)))
+				ThrowRangeException();
+			ri.checkIndex();
+		}
+
+		return {_index, ri._index};
+	}
+
+protected:
+	/**
+	 * \brief get a pointer to an index that is checked to be dereferenceable.
+	 * 
+	 * \c _array must not be null, and \c tmp strictly lower than size.
+	 * The wrap around uses the real size of the array, so it can't go outside.
+	 */
+	pointer getDereferenceablePtr(size_type tmp) const {
+
+		if constexpr (is_safe == memory_safety::safe) {
+			if(NODECPP_UNLIKELY(!_array))
+				ThrowNullException();
+
+			if constexpr (is_dezombiefy) {
+				checkNotInvalidated(_array);
+				if(NODECPP_UNLIKELY(!(tmp < _size.size())))
+					ThrowZombieException();
+			}
+			else {
+				if(NODECPP_UNLIKELY(!(tmp < _size)))
+					ThrowRangeException();
+			}
+		}
+
+		auto& arr = *_array;
+		size_type p = _head + tmp;
+		if(p >= arr.size())
+			p -= arr.size();
+
+		return arr.data() + p;
+	}
+
+	void checkIndex() const {
+		if(_array) {
+			if constexpr (is_dezombiefy) {
+				checkNotInvalidated(_array);
+				if(NODECPP_UNLIKELY(!(_index <= _size.size())))
+					ThrowZombieException();
+			}
+			else {
+				if(NODECPP_UNLIKELY(!(_index <= _size)))
+					ThrowRangeException();
+			}
+		}
+		else if(_index != 0)
+			ThrowRangeException();
+	}
+
+	void checkArray(const T* arr, size_type head) const {
+		if(arr != (_array ? _array->data() : nullptr))
+			ThrowRangeException();
+		else if(_array && _head != head)
+			ThrowRangeException();
+	}
+
+	void checkSameRing(const this_type& ri) const {
+		if(NODECPP_UNLIKELY(_array != ri._array || _head != ri._head))
+			ThrowInvalidArgumentException();
+	}
+};
+
+} // namespace safememory::detail
+
+#endif // SAFE_MEMORY_DETAIL_RING_ITERATOR_H
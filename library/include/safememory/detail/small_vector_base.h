@@ -0,0 +1,444 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_DETAIL_SMALL_VECTOR_BASE_H
+#define SAFE_MEMORY_DETAIL_SMALL_VECTOR_BASE_H
+
+#include <utility>
+#include <memory> // for std::uninitialized_move and friends
+#include <algorithm>
+#include <limits>
+#include <initializer_list>
+#include <safememory/detail/allocator_to_eastl.h>
+
+/** \file
+ * \brief Storage of \c safememory::small_vector
+ * 
+ * Up to \c N elements are kept inline, in a buffer inside the object itself, no allocation
+ * is made at all. When more room is needed, elements are moved (spilled) to an array allocated
+ * through the same allocator as \c safememory::vector (that is, zombie protected).
+ * Once on the heap, elements only move back inline at \c shrink_to_fit
+ * 
+ * Like \c eastl::vector this class works with raw pointers and doesn't check anything,
+ * checks are done at \c safememory::small_vector
+ */
+
+namespace safememory::detail {
+
+template<typename T, eastl_size_t N, memory_safety Safety>
+class small_vector_base
+{
+	static_assert(N > 0, "small_vector needs room for at least one inline element, use vector instead");
+
+public:
+	typedef small_vector_base<T, N, Safety>                          this_type;
+	typedef allocator_to_eastl_vector<Safety>                        allocator_type;
+	typedef typename allocator_type::template array_pointer<T>      array_pointer;
+
+	typedef T                                                        value_type;
+	typedef T*                                                       pointer;
+	typedef const T*                                                 const_pointer;
+	typedef T&                                                       reference;
+	typedef const T&                                                 const_reference;
+	typedef eastl_size_t                                             size_type;
+	typedef eastl_ssize_t                                            difference_type;
+
+	static constexpr size_type inline_capacity = N;
+
+protected:
+	array_pointer mpHeap; // null while elements are inline
+	size_type mnSize = 0;
+	size_type mnCapacity = N;
+	alignas(T) unsigned char mBuffer[sizeof(T) * N];
+
+public:
+	small_vector_base() {}
+	explicit small_vector_base(size_type n) { resize(n); }
+	small_vector_base(size_type n, const value_type& value) { assign(n, value); }
+	small_vector_base(std::initializer_list<value_type> ilist) { assign(ilist); }
+
+	small_vector_base(const this_type& x) { assignRange(x.begin(), x.end()); }
+	small_vector_base(this_type&& x) noexcept(std::is_nothrow_move_constructible_v<T>) { moveFrom(x); }
+
+	~small_vector_base() {
+		clear();
+		freeHeap();
+	}
+
+	this_type& operator=(const this_type& x) {
+		if(this != &x)
+			assignRange(x.begin(), x.end());
+		return *this;
+	}
+
+	this_type& operator=(this_type&& x) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if(this != &x) {
+			clear();
+			freeHeap();
+			moveFrom(x);
+		}
+		return *this;
+	}
+
+	this_type& operator=(std::initializer_list<value_type> ilist) {
+		assign(ilist);
+		return *this;
+	}
+
+	void swap(this_type& x) {
+		this_type tmp(std::move(x));
+		x = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	void assign(size_type n, const value_type& value) {
+		value_type tmp(value); // value may be one of our elements
+		clear();
+		reserve(n);
+		std::uninitialized_fill_n(begin(), n, tmp);
+		mnSize = n;
+	}
+
+	void assign(std::initializer_list<value_type> ilist) { assignRange(ilist.begin(), ilist.end()); }
+
+	void assign(const_pointer first, const_pointer last) {
+		if(first >= begin() && first < end()) {
+			// assigning part of ourselves, take a copy first
+			this_type tmp;
+			tmp.assignRange(first, last);
+			*this = std::move(tmp);
+		}
+		else
+			assignRange(first, last);
+	}
+
+	pointer       begin() noexcept { return mpHeap ? allocator_type::to_raw(mpHeap) : inlineBegin(); }
+	const_pointer begin() const noexcept { return mpHeap ? allocator_type::to_raw(mpHeap) : inlineBegin(); }
+
+	pointer       end() noexcept { return begin() + mnSize; }
+	const_pointer end() const noexcept { return begin() + mnSize; }
+
+	bool empty() const noexcept { return mnSize == 0; }
+	size_type size() const noexcept { return mnSize; }
+	size_type capacity() const noexcept { return mnCapacity; }
+	size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+	/// \c true while elements are in the inline buffer
+	bool is_inline() const noexcept { return !mpHeap; }
+
+	void reserve(size_type n) {
+		if(n > mnCapacity)
+			reallocate(n);
+	}
+
+	void resize(size_type n) {
+		if(n > mnSize) {
+			reserve(n);
+			std::uninitialized_value_construct(end(), begin() + n);
+			mnSize = n;
+		}
+		else
+			erase(begin() + n, end());
+	}
+
+	void resize(size_type n, const value_type& value) {
+		if(n > mnSize) {
+			value_type tmp(value);
+			reserve(n);
+			std::uninitialized_fill(end(), begin() + n, tmp);
+			mnSize = n;
+		}
+		else
+			erase(begin() + n, end());
+	}
+
+	void shrink_to_fit() {
+		if(!mpHeap || mnSize == mnCapacity)
+			return;
+
+		if(mnSize <= N) {
+			// back to inline buffer
+			std::uninitialized_move(begin(), end(), inlineBegin());
+			std::destroy(begin(), end());
+			freeHeap();
+		}
+		else
+			reallocate(mnSize);
+	}
+
+	/// move elements to the heap, if not already there
+	void spill() {
+		if(!mpHeap)
+			reallocate(growCapacity(N + 1));
+	}
+
+	void clear() noexcept {
+		std::destroy(begin(), end());
+		mnSize = 0;
+	}
+
+	void push_back(const value_type& value) { emplace_back(value); }
+	void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+	template<class... Args>
+	reference emplace_back(Args&&... args) {
+		if(mnSize < mnCapacity)
+			::new(static_cast<void*>(end())) value_type(std::forward<Args>(args)...);
+		else
+			reallocateAndEmplace(mnSize, std::forward<Args>(args)...);
+
+		++mnSize;
+		return *(end() - 1);
+	}
+
+	void pop_back() {
+		--mnSize;
+		end()->~value_type();
+	}
+
+	template<class... Args>
+	pointer emplace(const_pointer position, Args&&... args) {
+		const size_type ix = static_cast<size_type>(position - begin());
+
+		if(mnSize == mnCapacity) {
+			reallocateAndEmplace(ix, std::forward<Args>(args)...);
+			++mnSize;
+		}
+		else if(ix == mnSize) {
+			::new(static_cast<void*>(end())) value_type(std::forward<Args>(args)...);
+			++mnSize;
+		}
+		else {
+			value_type tmp(std::forward<Args>(args)...); // args may reference elements we are about to move
+			pointer e = end();
+			::new(static_cast<void*>(e)) value_type(std::move(*(e - 1)));
+			++mnSize;
+			std::move_backward(begin() + ix, e - 1, e);
+			begin()[ix] = std::move(tmp);
+		}
+
+		return begin() + ix;
+	}
+
+	pointer insert(const_pointer position, const value_type& value) { return emplace(position, value); }
+	pointer insert(const_pointer position, value_type&& value) { return emplace(position, std::move(value)); }
+
+	pointer insert(const_pointer position, size_type n, const value_type& value) {
+		const size_type ix = static_cast<size_type>(position - begin());
+		if(n == 0)
+			return begin() + ix;
+
+		value_type tmp(value);
+		if(mnSize + n > mnCapacity)
+			reallocate(growCapacity(mnSize + n));
+
+		pointer p = begin() + ix;
+		pointer e = end();
+		const size_type tail = mnSize - ix;
+		if(n < tail) {
+			std::uninitialized_move(e - n, e, e);
+			mnSize += n;
+			std::move_backward(p, e - n, e);
+			std::fill_n(p, n, tmp);
+		}
+		else {
+			std::uninitialized_fill_n(e, n - tail, tmp);
+			mnSize += n - tail;
+			std::uninitialized_move(p, e, p + n);
+			mnSize += tail;
+			std::fill(p, e, tmp);
+		}
+		return p;
+	}
+
+	pointer insert(const_pointer position, std::initializer_list<value_type> ilist) {
+		return insertRange(position, ilist.begin(), ilist.end());
+	}
+
+	pointer insert(const_pointer position, const_pointer first, const_pointer last) {
+		if(first >= begin() && first < end()) {
+			// inserting part of ourselves, take a copy first
+			this_type tmp;
+			tmp.assignRange(first, last);
+			return insertRange(position, tmp.begin(), tmp.end());
+		}
+		return insertRange(position, first, last);
+	}
+
+	pointer erase(const_pointer position) { return erase(position, position + 1); }
+
+	pointer erase(const_pointer first, const_pointer last) {
+		pointer f = begin() + (first - begin());
+		if(first != last) {
+			pointer e = end();
+			pointer newEnd = std::move(f + (last - first), e, f);
+			std::destroy(newEnd, e);
+			mnSize -= static_cast<size_type>(last - first);
+		}
+		return f;
+	}
+
+	pointer erase_unsorted(const_pointer position) {
+		pointer p = begin() + (position - begin());
+		pointer last = end() - 1;
+		if(p != last)
+			*p = std::move(*last);
+		last->~value_type();
+		--mnSize;
+		return p;
+	}
+
+protected:
+	pointer inlineBegin() noexcept { return reinterpret_cast<pointer>(mBuffer); }
+	const_pointer inlineBegin() const noexcept { return reinterpret_cast<const_pointer>(mBuffer); }
+
+	size_type growCapacity(size_type required) const noexcept {
+		return std::max(required, mnCapacity * 2);
+	}
+
+	void freeHeap() noexcept {
+		if(mpHeap) {
+			allocator_type alloc;
+			alloc.template deallocate_array<T>(mpHeap, mnCapacity);
+			mpHeap = nullptr;
+		}
+		mnCapacity = N;
+	}
+
+	void reallocate(size_type newCapacity) {
+		NODECPP_ASSERT(module_id, nodecpp::assert::AssertLevel::regular, newCapacity >= mnSize);
+		allocator_type alloc;
+		array_pointer newHeap = alloc.template allocate_array<T>(newCapacity);
+		try {
+			std::uninitialized_move(begin(), end(), allocator_type::to_raw(newHeap));
+		}
+		catch(...) {
+			alloc.template deallocate_array<T>(newHeap, newCapacity);
+			throw;
+		}
+		std::destroy(begin(), end());
+		freeHeap();
+		mpHeap = newHeap;
+		mnCapacity = newCapacity;
+	}
+
+	/// new element is constructed before old ones are moved, as \p args may reference one of them
+	template<class... Args>
+	void reallocateAndEmplace(size_type ix, Args&&... args) {
+		const size_type newCapacity = growCapacity(mnSize + 1);
+		allocator_type alloc;
+		array_pointer newHeap = alloc.template allocate_array<T>(newCapacity);
+		pointer newBegin = allocator_type::to_raw(newHeap);
+		try {
+			::new(static_cast<void*>(newBegin + ix)) value_type(std::forward<Args>(args)...);
+		}
+		catch(...) {
+			alloc.template deallocate_array<T>(newHeap, newCapacity);
+			throw;
+		}
+		try {
+			std::uninitialized_move(begin(), begin() + ix, newBegin);
+			try {
+				std::uninitialized_move(begin() + ix, end(), newBegin + ix + 1);
+			}
+			catch(...) {
+				std::destroy(newBegin, newBegin + ix);
+				throw;
+			}
+		}
+		catch(...) {
+			newBegin[ix].~value_type();
+			alloc.template deallocate_array<T>(newHeap, newCapacity);
+			throw;
+		}
+		std::destroy(begin(), end());
+		freeHeap();
+		mpHeap = newHeap;
+		mnCapacity = newCapacity;
+	}
+
+	/// [first, last) must not be inside this
+	pointer insertRange(const_pointer position, const_pointer first, const_pointer last) {
+		const size_type ix = static_cast<size_type>(position - begin());
+		const size_type n = static_cast<size_type>(last - first);
+		if(n == 0)
+			return begin() + ix;
+
+		if(mnSize + n > mnCapacity)
+			reallocate(growCapacity(mnSize + n));
+
+		pointer p = begin() + ix;
+		pointer e = end();
+		const size_type tail = mnSize - ix;
+		if(n < tail) {
+			std::uninitialized_move(e - n, e, e);
+			mnSize += n;
+			std::move_backward(p, e - n, e);
+			std::copy(first, last, p);
+		}
+		else {
+			const_pointer mid = first + tail;
+			std::uninitialized_copy(mid, last, e);
+			mnSize += n - tail;
+			std::uninitialized_move(p, e, p + n);
+			mnSize += tail;
+			std::copy(first, mid, p);
+		}
+		return p;
+	}
+
+	/// [first, last) must not be inside this
+	void assignRange(const_pointer first, const_pointer last) {
+		const size_type n = static_cast<size_type>(last - first);
+		clear();
+		reserve(n);
+		std::uninitialized_copy(first, last, begin());
+		mnSize = n;
+	}
+
+	/// this must be empty and inline
+	void moveFrom(this_type& x) {
+		if(x.mpHeap) {
+			mpHeap = x.mpHeap;
+			mnCapacity = x.mnCapacity;
+			mnSize = x.mnSize;
+			x.mpHeap = nullptr;
+			x.mnCapacity = N;
+			x.mnSize = 0;
+		}
+		else {
+			std::uninitialized_move(x.begin(), x.end(), inlineBegin());
+			mnSize = x.mnSize;
+			x.clear();
+		}
+	}
+};
+
+} // namespace safememory::detail
+
+#endif // SAFE_MEMORY_DETAIL_SMALL_VECTOR_BASE_H
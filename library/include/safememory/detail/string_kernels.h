@@ -0,0 +1,66 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_DETAIL_STRING_KERNELS_H
+#define SAFE_MEMORY_DETAIL_STRING_KERNELS_H
+
+#include <cstddef>
+
+/** \file
+ * \brief Search and hash functions over single byte characters, used by \c basic_string .
+ * 
+ * All functions take a range as pointer and length, never read outside of it, and return an index
+ * relative to its beginning, or \c kernel_npos when nothing was found.
+ * Bounds of the range are the responsibility of the caller.
+ * 
+ * On x86-64 they are vectorized with SSE2, on Linux the AVX2 version is selected at startup
+ * when the cpu supports it. On other platforms plain loops are used.
+ */
+
+namespace safememory::detail {
+
+constexpr std::size_t kernel_npos = static_cast<std::size_t>(-1);
+
+/// first occurrence of \p c in \p p [0, \p n)
+std::size_t find_char(const char* p, std::size_t n, char c) noexcept;
+
+/// first occurrence of substring \p s [0, \p m) in \p p [0, \p n), empty substring is found at 0
+std::size_t find_substring(const char* p, std::size_t n, const char* s, std::size_t m) noexcept;
+
+/// first character in \p p [0, \p n) that is one of \p set [0, \p m)
+std::size_t find_first_of_chars(const char* p, std::size_t n, const char* set, std::size_t m) noexcept;
+
+/// last character in \p p [0, \p n) that is one of \p set [0, \p m)
+std::size_t find_last_of_chars(const char* p, std::size_t n, const char* set, std::size_t m) noexcept;
+
+/// hash of all \p n bytes at \p p (embedded zeros included)
+std::size_t hash_chars(const char* p, std::size_t n) noexcept;
+
+} // namespace safememory::detail
+
+#endif // SAFE_MEMORY_DETAIL_STRING_KERNELS_H
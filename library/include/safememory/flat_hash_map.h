@@ -0,0 +1,173 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_FLAT_HASH_MAP_H
+#define SAFE_MEMORY_FLAT_HASH_MAP_H
+
+#include <utility>
+#include <EASTL/tuple.h>
+#include <safememory/functional.h>
+#include <safememory/detail/flat_hashtable.h>
+
+namespace safememory
+{
+	namespace detail {
+		template <typename Key, typename T>
+		struct flat_hash_map_policy
+		{
+			typedef Key                          key_type;
+			typedef eastl::pair<const Key, T>    value_type;
+
+			static const Key& key(const value_type& value) { return value.first; }
+
+			static void relocate(value_type* dst, value_type* src) {
+				// mb: key is const only for the user, the table may move it when slot is relocated
+				::new (dst) value_type(std::move(const_cast<Key&>(src->first)), std::move(src->second));
+				src->~value_type();
+			}
+		};
+	} // namespace detail
+
+	/**
+	 * \brief Open addressing hash map.
+	 * 
+	 * Elements are stored in place in a single array, and are moved when the table grows,
+	 * so unlike \c unordered_map references to elements are invalidated at rehash.
+	 * Heap safe iterators throw after that, instead of pointing into released memory.
+	 * See \c detail::flat_hashtable for details.
+	 */
+	template <typename Key, typename T, typename Hash = hash<Key>, typename Predicate = equal_to<Key>, 
+			  memory_safety Safety = safeness_declarator<Key>::is_safe>
+	class SAFEMEMORY_DEEP_CONST_WHEN_PARAMS flat_hash_map
+		: public detail::flat_hashtable<detail::flat_hash_map_policy<Key, T>, Hash, Predicate, Safety>
+	{
+	public:
+		typedef detail::flat_hashtable<detail::flat_hash_map_policy<Key, T>, Hash, Predicate, Safety>  base_type;
+		typedef flat_hash_map<Key, T, Hash, Predicate, Safety>                    this_type;
+
+		typedef typename base_type::size_type                                     size_type;
+		typedef typename base_type::key_type                                      key_type;
+		typedef T                                                                 mapped_type;
+		typedef typename base_type::value_type                                    value_type;
+		typedef typename base_type::iterator                                      iterator;
+		typedef typename base_type::const_iterator                                const_iterator;
+		typedef typename base_type::iterator_safe                                 iterator_safe;
+		typedef typename base_type::const_iterator_safe                           const_iterator_safe;
+		typedef typename base_type::insert_return_type                            insert_return_type;
+		typedef typename base_type::insert_return_type_safe                       insert_return_type_safe;
+
+		using base_type::base_type;
+		using base_type::operator=;
+
+		T& at(const key_type& k) { return atImpl(k); }
+		const T& at(const key_type& k) const { return atImpl(k); }
+
+		mapped_type& operator[](const key_type& key) {
+			auto r = base_type::emplaceKeyImpl(key, eastl::piecewise_construct, eastl::forward_as_tuple(key), eastl::tuple<>());
+			return base_type::slotAt(r.first).second;
+		}
+
+		mapped_type& operator[](key_type&& key) {
+			auto r = base_type::emplaceKeyImpl(key, eastl::piecewise_construct, eastl::forward_as_tuple(std::move(key)), eastl::tuple<>());
+			return base_type::slotAt(r.first).second;
+		}
+
+		template <class... Args>
+		insert_return_type try_emplace(const key_type& k, Args&&... args) {
+			return base_type::makeIt(tryEmplaceImpl(k, std::forward<Args>(args)...));
+		}
+
+		template <class... Args>
+		insert_return_type_safe try_emplace_safe(const key_type& k, Args&&... args) {
+			return base_type::makeSafeIt(tryEmplaceImpl(k, std::forward<Args>(args)...));
+		}
+
+		template <class... Args>
+		insert_return_type try_emplace(key_type&& k, Args&&... args) {
+			return base_type::makeIt(tryEmplaceImpl(std::move(k), std::forward<Args>(args)...));
+		}
+
+		template <class... Args>
+		insert_return_type_safe try_emplace_safe(key_type&& k, Args&&... args) {
+			return base_type::makeSafeIt(tryEmplaceImpl(std::move(k), std::forward<Args>(args)...));
+		}
+
+		template <class M>
+		insert_return_type insert_or_assign(const key_type& k, M&& obj) {
+			return base_type::makeIt(insertOrAssignImpl(k, std::forward<M>(obj)));
+		}
+
+		template <class M>
+		insert_return_type_safe insert_or_assign_safe(const key_type& k, M&& obj) {
+			return base_type::makeSafeIt(insertOrAssignImpl(k, std::forward<M>(obj)));
+		}
+
+		template <class M>
+		insert_return_type insert_or_assign(key_type&& k, M&& obj) {
+			return base_type::makeIt(insertOrAssignImpl(std::move(k), std::forward<M>(obj)));
+		}
+
+		template <class M>
+		insert_return_type_safe insert_or_assign_safe(key_type&& k, M&& obj) {
+			return base_type::makeSafeIt(insertOrAssignImpl(std::move(k), std::forward<M>(obj)));
+		}
+
+	protected:
+		T& atImpl(const key_type& k) const {
+			size_type ix = base_type::findIndex(k);
+			if(ix == base_type::mnCapacity)
+				base_type::ThrowRangeException();
+			return base_type::slotAt(ix).second;
+		}
+
+		template <class K, class... Args>
+		eastl::pair<size_type, bool> tryEmplaceImpl(K&& k, Args&&... args) {
+			return base_type::emplaceKeyImpl(k, eastl::piecewise_construct,
+				eastl::forward_as_tuple(std::forward<K>(k)), eastl::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		template <class K, class M>
+		eastl::pair<size_type, bool> insertOrAssignImpl(K&& k, M&& obj) {
+			size_type ix = base_type::findIndex(k);
+			if(ix != base_type::mnCapacity) {
+				base_type::slotAt(ix).second = std::forward<M>(obj);
+				return { ix, false };
+			}
+			return tryEmplaceImpl(std::forward<K>(k), std::forward<M>(obj));
+		}
+	};
+
+	template <typename K, typename T, typename H, typename P, memory_safety S>
+	inline void swap(flat_hash_map<K, T, H, P, S>& a, flat_hash_map<K, T, H, P, S>& b)
+	{
+		a.swap(b);
+	}
+
+} // namespace safememory
+
+#endif // SAFE_MEMORY_FLAT_HASH_MAP_H
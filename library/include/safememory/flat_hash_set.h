@@ -0,0 +1,81 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_FLAT_HASH_SET_H
+#define SAFE_MEMORY_FLAT_HASH_SET_H
+
+#include <utility>
+#include <safememory/functional.h>
+#include <safememory/detail/flat_hashtable.h>
+
+namespace safememory
+{
+	namespace detail {
+		template <typename Value>
+		struct flat_hash_set_policy
+		{
+			typedef Value    key_type;
+			typedef Value    value_type;
+
+			static const Value& key(const value_type& value) { return value; }
+
+			static void relocate(value_type* dst, value_type* src) {
+				::new (dst) value_type(std::move(*src));
+				src->~value_type();
+			}
+		};
+	} // namespace detail
+
+	/**
+	 * \brief Open addressing hash set.
+	 * 
+	 * Same as \c flat_hash_map , elements are moved when the table grows.
+	 * Elements must not be modified through iterators, as that would change their hash.
+	 */
+	template <typename Value, typename Hash = hash<Value>, typename Predicate = equal_to<Value>, 
+			  memory_safety Safety = safeness_declarator<Value>::is_safe>
+	class SAFEMEMORY_DEEP_CONST_WHEN_PARAMS flat_hash_set
+		: public detail::flat_hashtable<detail::flat_hash_set_policy<Value>, Hash, Predicate, Safety>
+	{
+	public:
+		typedef detail::flat_hashtable<detail::flat_hash_set_policy<Value>, Hash, Predicate, Safety>  base_type;
+		typedef flat_hash_set<Value, Hash, Predicate, Safety>                     this_type;
+
+		using base_type::base_type;
+		using base_type::operator=;
+	};
+
+	template <typename V, typename H, typename P, memory_safety S>
+	inline void swap(flat_hash_set<V, H, P, S>& a, flat_hash_set<V, H, P, S>& b)
+	{
+		a.swap(b);
+	}
+
+} // namespace safememory
+
+#endif // SAFE_MEMORY_FLAT_HASH_SET_H
@@ -0,0 +1,191 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFEMEMORY_OWNING_LIST_H
+#define SAFEMEMORY_OWNING_LIST_H
+
+#include <safememory/safe_ptr.h>
+
+namespace safememory
+{
+
+template<class T, memory_safety Safety> class owning_list; // forward declaration
+
+/** 
+ * \brief Links of a node of \c owning_list; a node type \c T derives from \c owning_list_hook<T>.
+ * 
+ * A node is owned by its predecessor (or by the list itself, for the first one), and refers back
+ * to it with a \c soft_ptr. Both links live in the node, so no allocations are made by the list,
+ * and a back link takes one of inline \c soft_ptr slots of the predecessor's control block.
+ */
+template<class T, memory_safety Safety = safeness_declarator<T>::is_safe>
+class owning_list_hook
+{
+	friend class owning_list<T, Safety>;
+
+	owning_ptr<T, Safety> next_;
+	soft_ptr<T, Safety> prev_;
+
+public:
+	owning_list_hook() {}
+	owning_list_hook( const owning_list_hook& ) : owning_list_hook() {} // a copy of a node is not linked
+	owning_list_hook& operator = ( const owning_list_hook& ) { return *this; }
+
+	bool is_linked() const { return next_ != nullptr || prev_ != nullptr; }
+};
+
+/** 
+ * \brief Intrusive doubly-linked list owning its nodes.
+ * 
+ * Nodes are created by \c make_owning and passed in as \c owning_ptr; removed ones are given back the same way.
+ * Destruction (and \c clear) goes node by node, so a long list doesn't recurse through its owning links.
+ * 
+ * Iteration: \code for ( auto p = l.front(); p != nullptr; p = l.next( *p ) ) \endcode
+ */
+template<class T, memory_safety Safety = safeness_declarator<T>::is_safe>
+class owning_list
+{
+public:
+	typedef T                                 value_type;
+	typedef owning_ptr<T, Safety>             owning_ptr_type;
+	typedef soft_ptr<T, Safety>               soft_ptr_type;
+	typedef owning_list_hook<T, Safety>       hook_type;
+	typedef size_t                            size_type;
+
+private:
+	owning_ptr_type head_;
+	soft_ptr_type tail_;
+	size_type size_ = 0;
+
+	static hook_type& hook( T& node ) { return static_cast<hook_type&>( node ); }
+
+	// owning_ptr that owns a node of this list
+	owning_ptr_type& owner_of( T& node ) {
+		hook_type& h = hook( node );
+		owning_ptr_type& owner = h.prev_ != nullptr ? hook( *(h.prev_) ).next_ : head_;
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, owner != nullptr && &*owner == &node, "node is not in this list" );
+		return owner;
+	}
+
+public:
+	owning_list() {}
+	owning_list( const owning_list& ) = delete;
+	owning_list& operator = ( const owning_list& ) = delete;
+	~owning_list() { clear(); }
+
+	bool empty() const { return head_ == nullptr; }
+	size_type size() const { return size_; }
+
+	soft_ptr_type front() const { return soft_ptr_type( head_ ); }
+	soft_ptr_type back() const { return tail_; }
+	static soft_ptr_type next( T& node ) { return soft_ptr_type( hook( node ).next_ ); }
+	static soft_ptr_type prev( T& node ) { return hook( node ).prev_; }
+
+	void push_front( owning_ptr_type node ) {
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, node != nullptr && !hook( *node ).is_linked() );
+		hook_type& h = hook( *node );
+		if ( head_ != nullptr ) {
+			hook( *head_ ).prev_ = node;
+			h.next_ = std::move( head_ );
+		}
+		else
+			tail_ = node;
+		head_ = std::move( node );
+		++size_;
+	}
+
+	void push_back( owning_ptr_type node ) {
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, node != nullptr && !hook( *node ).is_linked() );
+		soft_ptr_type last = node;
+		if ( tail_ != nullptr ) {
+			hook( *node ).prev_ = tail_;
+			hook( *tail_ ).next_ = std::move( node );
+		}
+		else
+			head_ = std::move( node );
+		tail_ = last;
+		++size_;
+	}
+
+	void insert_after( T& pos, owning_ptr_type node ) {
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, node != nullptr && !hook( *node ).is_linked() );
+		hook_type& hp = hook( pos );
+		hook_type& h = hook( *node );
+		h.prev_ = owner_of( pos );
+		if ( hp.next_ != nullptr ) {
+			hook( *(hp.next_) ).prev_ = node;
+			h.next_ = std::move( hp.next_ );
+		}
+		else
+			tail_ = node;
+		hp.next_ = std::move( node );
+		++size_;
+	}
+
+	// removes node from the list and passes its ownership to the caller
+	owning_ptr_type unlink( T& node ) {
+		owning_ptr_type& owner = owner_of( node );
+		owning_ptr_type ret = std::move( owner );
+		hook_type& h = hook( *ret );
+		if ( h.next_ != nullptr )
+			hook( *(h.next_) ).prev_ = h.prev_;
+		else
+			tail_ = h.prev_;
+		owner = std::move( h.next_ );
+		h.prev_ = nullptr;
+		--size_;
+		return ret;
+	}
+
+	owning_ptr_type pop_front() {
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, !empty() );
+		return unlink( *head_ );
+	}
+
+	owning_ptr_type pop_back() {
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, !empty() );
+		return unlink( *tail_ );
+	}
+
+	void clear() {
+		tail_ = nullptr;
+		while ( head_ != nullptr ) {
+			owning_ptr_type node = std::move( head_ );
+			hook_type& h = hook( *node );
+			if ( h.next_ != nullptr )
+				hook( *(h.next_) ).prev_ = nullptr;
+			head_ = std::move( h.next_ );
+			// node is destroyed here, with no links left
+		}
+		size_ = 0;
+	}
+};
+
+} // namespace safememory
+
+#endif // SAFEMEMORY_OWNING_LIST_H
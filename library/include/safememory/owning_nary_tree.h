@@ -0,0 +1,137 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFEMEMORY_OWNING_NARY_TREE_H
+#define SAFEMEMORY_OWNING_NARY_TREE_H
+
+#include <safememory/owning_list.h>
+
+namespace safememory
+{
+
+template<class T, memory_safety Safety> class owning_nary_tree; // forward declaration
+
+/** 
+ * \brief Links of a node of \c owning_nary_tree; a node type \c T derives from \c owning_nary_tree_hook<T>.
+ * 
+ * Children of a node are kept in an intrusive \c owning_list (using sibling links inherited from
+ * \c owning_list_hook), and each child refers to its parent with a \c soft_ptr.
+ * Thus a node takes no separate allocations for its children, unlike one with a \c vector<owning_ptr<T>>.
+ */
+template<class T, memory_safety Safety = safeness_declarator<T>::is_safe>
+class owning_nary_tree_hook : public owning_list_hook<T, Safety>
+{
+	friend class owning_nary_tree<T, Safety>;
+
+	owning_list<T, Safety> children_;
+	soft_ptr<T, Safety> parent_;
+
+public:
+	owning_nary_tree_hook() {}
+	owning_nary_tree_hook( const owning_nary_tree_hook& ) : owning_nary_tree_hook() {} // a copy of a node has no parent or children
+	owning_nary_tree_hook& operator = ( const owning_nary_tree_hook& ) { return *this; }
+
+	// descendants are moved to a worklist level by level and destroyed from there with no children left,
+	// so that destruction of a deep subtree doesn't recurse through its owning links (cf. owning_list::clear())
+	~owning_nary_tree_hook() {
+		if ( children_.empty() )
+			return;
+		owning_list<T, Safety> pending;
+		while ( !children_.empty() )
+			pending.push_back( children_.pop_front() );
+		while ( !pending.empty() ) {
+			owning_ptr<T, Safety> node = pending.pop_front();
+			owning_nary_tree_hook& h = static_cast<owning_nary_tree_hook&>( *node );
+			h.parent_ = nullptr;
+			while ( !h.children_.empty() )
+				pending.push_back( h.children_.pop_front() );
+			// node is destroyed here, with no children left
+		}
+	}
+};
+
+/** 
+ * \brief Unordered n-ary tree of nodes owned by their parents, with an owning root.
+ * 
+ * Nodes are created by \c make_owning and attached to a parent given by a \c soft_ptr;
+ * a detached node (along with its subtree) is given back as \c owning_ptr.
+ * The tree keeps no order or balance of its own; children are kept in the order they are added.
+ * Destruction of a subtree goes node by node, so a deep one doesn't recurse through its owning links.
+ */
+template<class T, memory_safety Safety = safeness_declarator<T>::is_safe>
+class owning_nary_tree
+{
+public:
+	typedef T                                 value_type;
+	typedef owning_ptr<T, Safety>             owning_ptr_type;
+	typedef soft_ptr<T, Safety>               soft_ptr_type;
+	typedef owning_nary_tree_hook<T, Safety>       hook_type;
+	typedef owning_list<T, Safety>            children_type;
+	typedef size_t                            size_type;
+
+private:
+	owning_ptr_type root_;
+
+	static hook_type& hook( T& node ) { return static_cast<hook_type&>( node ); }
+
+public:
+	owning_nary_tree() {}
+	explicit owning_nary_tree( owning_ptr_type root ) : root_( std::move( root ) ) {}
+	owning_nary_tree( const owning_nary_tree& ) = delete;
+	owning_nary_tree& operator = ( const owning_nary_tree& ) = delete;
+
+	soft_ptr_type root() const { return soft_ptr_type( root_ ); }
+	void set_root( owning_ptr_type root ) { root_ = std::move( root ); }
+	owning_ptr_type release_root() { return std::move( root_ ); }
+
+	static soft_ptr_type parent( T& node ) { return hook( node ).parent_; }
+	static soft_ptr_type first_child( T& node ) { return hook( node ).children_.front(); }
+	static soft_ptr_type last_child( T& node ) { return hook( node ).children_.back(); }
+	static soft_ptr_type next_sibling( T& node ) { return children_type::next( node ); }
+	static soft_ptr_type prev_sibling( T& node ) { return children_type::prev( node ); }
+	static size_type child_count( T& node ) { return hook( node ).children_.size(); }
+
+	static void add_child( const soft_ptr_type& parent, owning_ptr_type child ) {
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, parent != nullptr && child != nullptr && hook( *child ).parent_ == nullptr );
+		hook( *child ).parent_ = parent;
+		hook( *parent ).children_.push_back( std::move( child ) );
+	}
+
+	// detaches node (which must not be the root) from its parent and passes ownership of its subtree to the caller
+	static owning_ptr_type remove( T& node ) {
+		hook_type& h = hook( node );
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, h.parent_ != nullptr );
+		owning_ptr_type ret = hook( *(h.parent_) ).children_.unlink( node );
+		h.parent_ = nullptr;
+		return ret;
+	}
+};
+
+} // namespace safememory
+
+#endif // SAFEMEMORY_OWNING_NARY_TREE_H
@@ -0,0 +1,149 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_RING_BUFFER_H
+#define SAFE_MEMORY_RING_BUFFER_H
+
+#include <safememory/deque.h>
+
+namespace safememory
+{
+	/**
+	 * \brief Fixed capacity circular queue.
+	 * 
+	 * Same storage and iterators as \c safememory::deque , but the capacity is set by the user
+	 * and pushing into a full \c ring_buffer doesn't grow it, like \c eastl::ring_buffer
+	 * \c push_back overwrites the front (oldest) element and \c push_front overwrites the back one.
+	 * Use \c full() to detect this condition.
+	 * 
+	 * Since overwriting moves the head, iterators created before are invalidated (see
+	 * \c detail::ring_heap_safe_iterator ). Elements never move in memory.
+	 * 
+	 * Unlike \c eastl::ring_buffer there is no unused slot, and elements are constructed and destroyed
+	 * as they are pushed and popped.
+	 */
+	template <typename T, memory_safety Safety = safeness_declarator<T>::is_safe>
+	class SAFEMEMORY_DEEP_CONST_WHEN_PARAMS ring_buffer : protected deque<T, Safety>
+	{
+		typedef ring_buffer<T, Safety>                                     this_type;
+		typedef deque<T, Safety>                                           base_type;
+		typedef detail::ring_buffer_base<T, Safety>                        ring_type;
+
+	public:
+		using typename base_type::value_type;
+		using typename base_type::pointer;
+		using typename base_type::const_pointer;
+		using typename base_type::reference;
+		using typename base_type::const_reference;
+		using typename base_type::size_type;
+		using typename base_type::difference_type;
+		using typename base_type::allocator_type;
+
+		using typename base_type::iterator;
+		using typename base_type::const_iterator;
+		using typename base_type::reverse_iterator;
+		using typename base_type::const_reverse_iterator;
+
+		using base_type::is_safe;
+
+	public:
+		ring_buffer() {}
+		explicit ring_buffer(size_type capacity) { ring_type::set_capacity(capacity); }
+		ring_buffer(const this_type& x) = default;
+		ring_buffer(this_type&&) = default;
+
+		~ring_buffer() = default;
+
+		this_type& operator=(const this_type& x) = default;
+		this_type& operator=(this_type&& x) = default;
+
+		void swap(this_type& x) { base_type::swap(x); }
+
+		using base_type::begin;
+		using base_type::cbegin;
+		using base_type::end;
+		using base_type::cend;
+		using base_type::rbegin;
+		using base_type::crbegin;
+		using base_type::rend;
+		using base_type::crend;
+
+		using base_type::size;
+		using base_type::empty;
+		using base_type::capacity;
+		using base_type::max_size;
+		using ring_type::full;
+
+		using base_type::reserve;
+		using ring_type::set_capacity;
+
+		using base_type::operator[];
+		using base_type::at;
+		using base_type::front;
+		using base_type::back;
+
+		void push_back(const value_type& value) { ring_type::emplace_back_overwrite(value); }
+		void push_back(value_type&& value) { ring_type::emplace_back_overwrite(std::move(value)); }
+		void push_front(const value_type& value) { ring_type::emplace_front_overwrite(value); }
+		void push_front(value_type&& value) { ring_type::emplace_front_overwrite(std::move(value)); }
+
+		template<class... Args>
+		reference emplace_back(Args&&... args) { return ring_type::emplace_back_overwrite(std::forward<Args>(args)...); }
+
+		template<class... Args>
+		reference emplace_front(Args&&... args) { return ring_type::emplace_front_overwrite(std::forward<Args>(args)...); }
+
+		using base_type::pop_back;
+		using base_type::pop_front;
+
+		using base_type::erase;
+		using base_type::clear;
+	}; // class ring_buffer
+
+
+	template <typename T, memory_safety Safety>
+	inline bool operator==(const ring_buffer<T, Safety>& a, const ring_buffer<T, Safety>& b)
+	{
+		return a.size() == b.size() && eastl::equal(a.begin(), a.end(), b.begin());
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator!=(const ring_buffer<T, Safety>& a, const ring_buffer<T, Safety>& b)
+	{
+		return !(a == b);
+	}
+
+	template <typename T, memory_safety Safety>
+	inline void swap(ring_buffer<T, Safety>& a, ring_buffer<T, Safety>& b)
+	{
+		a.swap(b);
+	}
+
+} // namespace safememory
+
+#endif // SAFE_MEMORY_RING_BUFFER_H
@@ -33,6 +33,8 @@
 
 #include "memory_safety.h"
 #include "../../src/safe_ptr.h"
+#include "../../src/safe_ptr_arena.h"
+#include "../../src/safe_ptr_pool.h"
 
 
 #endif //SAFEMEMORY_SAFE_PTR_H
\ No newline at end of file
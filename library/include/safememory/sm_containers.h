@@ -37,6 +37,7 @@
 
 #include <safememory/vector.h>
 #include <safememory/array.h>
+#include <safememory/deque.h>
 #include <safememory/unordered_map.h>
 #include <safememory/string.h>
 #include <safememory/string_format.h>
@@ -47,6 +48,9 @@ namespace sm
 	template<class T>
 	using vector = safememory::vector<T>;
 
+	template<class T>
+	using deque = safememory::deque<T>;
+
 	template<class T, std::size_t N>
 	using array = safememory::array<T, N>;
 
@@ -78,6 +82,7 @@ namespace sm
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <array>
 #include <utility>
@@ -90,6 +95,9 @@ namespace sm
 	template<class T>
 	using vector = std::vector<T, iiballocator<T>>;
 
+	template<class T>
+	using deque = std::deque<T, iiballocator<T>>;
+
 	template<class T, std::size_t N>
 	using array = std::array<T, N>;
 
@@ -120,6 +128,7 @@ namespace sm
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <array>
 #include <utility>
@@ -129,6 +138,9 @@ namespace sm
 	template<class T>
 	using vector = std::vector<T>;
 
+	template<class T>
+	using deque = std::deque<T>;
+
 	template<class T, std::size_t N>
 	using array = std::array<T, N>;
 
@@ -0,0 +1,440 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_SMALL_VECTOR_H
+#define SAFE_MEMORY_SMALL_VECTOR_H
+
+#include <EASTL/algorithm.h>
+#include <EASTL/iterator.h>
+#include <safememory/detail/checker_attributes.h>
+#include <safememory/detail/small_vector_base.h>
+#include <safememory/detail/array_iterator.h>
+#include <safe_memory_error.h>
+
+namespace safememory
+{
+	/**
+	 * \brief Vector with inline storage for up to \p N elements.
+	 * 
+	 * Same interface and checks as \c safememory::vector , but while \c size() is not greater than \p N
+	 * there is no heap allocation (and no \a ControlBlock) at all.
+	 * 
+	 * Stack only iterators work the same in both modes, they just point to the inline buffer or to the heap array.
+	 * Heap safe iterators need a \c soft_ptr to the array, so like \c basic_string does with SSO,
+	 * asking for one while elements are inline will first move them to the heap.
+	 * From there on heap safe iterators are checked for zombie access as usual.
+	 */
+	template <typename T, eastl_size_t N, memory_safety Safety = safeness_declarator<T>::is_safe>
+	class SAFEMEMORY_DEEP_CONST_WHEN_PARAMS small_vector : protected detail::small_vector_base<T, N, Safety>
+	SAFEMEMORY_DEZOMBIEFY_ITERATORS_REGISTRY
+	{
+		typedef small_vector<T, N, Safety>                                 this_type;
+		typedef detail::small_vector_base<T, N, Safety>                    base_type;
+
+	public:
+		typedef typename base_type::value_type                             value_type;
+		typedef typename base_type::pointer                                pointer;
+		typedef typename base_type::const_pointer                          const_pointer;
+		typedef typename base_type::reference                              reference;
+		typedef typename base_type::const_reference                        const_reference;
+		typedef typename base_type::size_type                              size_type;
+		typedef typename base_type::difference_type                        difference_type;
+		typedef typename base_type::allocator_type                         allocator_type;
+
+		typedef pointer                                                    iterator_base;
+		typedef const_pointer                                              const_iterator_base;
+		typedef eastl::reverse_iterator<iterator_base>                     reverse_iterator_base;
+		typedef eastl::reverse_iterator<const_iterator_base>               const_reverse_iterator_base;
+
+#ifdef SAFEMEMORY_DEZOMBIEFY_ITERATORS
+		static constexpr bool dz_it = true;
+#else
+		static constexpr bool dz_it = false;
+#endif
+
+		typedef typename allocator_type::template soft_array_pointer<T>                   soft_ptr_type;
+		typedef typename detail::array_stack_only_iterator<T, false, T*, dz_it>           stack_only_iterator;
+		typedef typename detail::array_stack_only_iterator<T, true, T*, dz_it>            const_stack_only_iterator;
+		typedef typename detail::array_heap_safe_iterator<T, false, soft_ptr_type, dz_it> heap_safe_iterator;
+		typedef typename detail::array_heap_safe_iterator<T, true, soft_ptr_type, dz_it>  const_heap_safe_iterator;
+
+		static constexpr bool use_base_iterator = Safety == memory_safety::none;
+
+		typedef std::conditional_t<use_base_iterator, iterator_base, stack_only_iterator>               iterator;
+		typedef std::conditional_t<use_base_iterator, const_iterator_base, const_stack_only_iterator>   const_iterator;
+		typedef eastl::reverse_iterator<iterator>                                                 reverse_iterator;
+		typedef eastl::reverse_iterator<const_iterator>                                           const_reverse_iterator;
+
+		typedef heap_safe_iterator                                         iterator_safe;
+		typedef const_heap_safe_iterator                                   const_iterator_safe;
+		typedef eastl::reverse_iterator<iterator_safe>                     reverse_iterator_safe;
+		typedef eastl::reverse_iterator<const_iterator_safe>               const_reverse_iterator_safe;
+
+		typedef std::conditional_t<use_base_iterator, const_iterator, const const_iterator&>           const_iterator_arg;
+
+		using base_type::inline_capacity;
+		static constexpr memory_safety is_safe = Safety;
+
+	public:
+		small_vector() {}
+		explicit small_vector(size_type n) : base_type(n) {}
+		small_vector(size_type n, const value_type& value) : base_type(n, value) {}
+		small_vector(const this_type& x) = default;
+		small_vector(this_type&&) = default;
+		small_vector(std::initializer_list<value_type> ilist) : base_type(ilist) {}
+
+		~small_vector() = default;
+
+		this_type& operator=(const this_type& x) = default;
+		this_type& operator=(std::initializer_list<value_type> ilist) { base_type::operator=(ilist); return *this; }
+		this_type& operator=(this_type&& x) = default;
+
+		void swap(this_type& x) { base_type::swap(x); }
+
+		void assign(size_type n, const value_type& value) { base_type::assign(n, value); }
+		void assign(std::initializer_list<value_type> ilist) { base_type::assign(ilist); }
+
+		void assign(const_iterator_arg first, const_iterator_arg last) {
+			auto p = toBaseOther(first, last);
+			base_type::assign(p.first, p.second);
+		}
+
+		pointer       begin_unsafe() noexcept { return base_type::begin(); }
+		const_pointer begin_unsafe() const noexcept { return base_type::begin(); }
+		const_pointer cbegin_unsafe() const noexcept { return base_type::begin(); }
+
+		pointer       end_unsafe() noexcept { return base_type::end(); }
+		const_pointer end_unsafe() const noexcept { return base_type::end(); }
+		const_pointer cend_unsafe() const noexcept { return base_type::end(); }
+
+		iterator       begin() noexcept { return makeIt(base_type::begin()); }
+		const_iterator begin() const noexcept { return makeIt(base_type::begin()); }
+		const_iterator cbegin() const noexcept { return makeIt(base_type::begin()); }
+
+		iterator       end() noexcept { return makeIt(base_type::end()); }
+		const_iterator end() const noexcept { return makeIt(base_type::end()); }
+		const_iterator cend() const noexcept { return makeIt(base_type::end()); }
+
+		reverse_iterator       rbegin() noexcept { return reverse_iterator(makeIt(end_unsafe())); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(makeIt(end_unsafe())); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(makeIt(end_unsafe())); }
+
+		reverse_iterator       rend() noexcept { return reverse_iterator(makeIt(begin_unsafe())); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(makeIt(begin_unsafe())); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(makeIt(begin_unsafe())); }
+
+		// mb: not noexcept, if elements are inline they are moved to the heap first
+		iterator_safe       begin_safe() { return makeSafeIt(base_type::begin()); }
+		const_iterator_safe begin_safe() const { return makeSafeIt(base_type::begin()); }
+		const_iterator_safe cbegin_safe() const { return makeSafeIt(base_type::begin()); }
+
+		iterator_safe       end_safe() { return makeSafeIt(base_type::end()); }
+		const_iterator_safe end_safe() const { return makeSafeIt(base_type::end()); }
+		const_iterator_safe cend_safe() const { return makeSafeIt(base_type::end()); }
+
+		reverse_iterator_safe       rbegin_safe() { return reverse_iterator_safe(makeSafeIt(end_unsafe())); }
+		const_reverse_iterator_safe rbegin_safe() const { return const_reverse_iterator_safe(makeSafeIt(end_unsafe())); }
+		const_reverse_iterator_safe crbegin_safe() const { return const_reverse_iterator_safe(makeSafeIt(end_unsafe())); }
+
+		reverse_iterator_safe       rend_safe() { return reverse_iterator_safe(makeSafeIt(begin_unsafe())); }
+		const_reverse_iterator_safe rend_safe() const { return const_reverse_iterator_safe(makeSafeIt(begin_unsafe())); }
+		const_reverse_iterator_safe crend_safe() const { return const_reverse_iterator_safe(makeSafeIt(begin_unsafe())); }
+
+#ifdef SAFEMEMORY_DEZOMBIEFY_ITERATORS
+		size_type size() const noexcept { return base_type::size(); }
+#else
+		using base_type::size;
+#endif
+
+		using base_type::empty;
+		using base_type::capacity;
+		using base_type::max_size;
+		using base_type::is_inline;
+
+		using base_type::resize;
+		using base_type::reserve;
+		using base_type::shrink_to_fit;
+
+		pointer       data_unsafe() noexcept { return base_type::begin(); }
+		const_pointer data_unsafe() const noexcept { return base_type::begin(); }
+
+		reference       operator[](size_type n) { return at(n); }
+		const_reference operator[](size_type n) const { return at(n); }
+
+		reference at(size_type n) {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(n >= size()))
+					ThrowRangeException();
+			}
+			return base_type::begin()[n];
+		}
+
+		const_reference at(size_type n) const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(n >= size()))
+					ThrowRangeException();
+			}
+			return base_type::begin()[n];
+		}
+
+		reference       front() { checkNotEmpty(); return *base_type::begin(); }
+		const_reference front() const { checkNotEmpty(); return *base_type::begin(); }
+
+		reference       back() { checkNotEmpty(); return *(base_type::end() - 1); }
+		const_reference back() const { checkNotEmpty(); return *(base_type::end() - 1); }
+
+		using base_type::push_back;
+		using base_type::emplace_back;
+
+		void pop_back() {
+			checkNotEmpty();
+			base_type::pop_back();
+		}
+
+		template<class... Args>
+		pointer emplace_unsafe(const_pointer position, Args&&... args) {
+			return base_type::emplace(position, std::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		iterator emplace(const_iterator_arg position, Args&&... args) {
+			return makeIt(base_type::emplace(toBase(position), std::forward<Args>(args)...));
+		}
+
+		template<class... Args>
+		iterator_safe emplace_safe(const const_iterator_safe& position, Args&&... args) {
+			return makeSafeIt(base_type::emplace(toBase(position), std::forward<Args>(args)...));
+		}
+
+		pointer insert_unsafe(const_pointer position, const value_type& value) { return base_type::insert(position, value); }
+		pointer insert_unsafe(const_pointer position, size_type n, const value_type& value) { return base_type::insert(position, n, value); }
+		pointer insert_unsafe(const_pointer position, value_type&& value) { return base_type::insert(position, std::move(value)); }
+		pointer insert_unsafe(const_pointer position, std::initializer_list<value_type> ilist) { return base_type::insert(position, ilist); }
+
+		iterator insert(const_iterator_arg position, const value_type& value) {
+			return makeIt(base_type::insert(toBase(position), value));
+		}
+
+		iterator insert(const_iterator_arg position, size_type n, const value_type& value) {
+			return makeIt(base_type::insert(toBase(position), n, value));
+		}
+
+		iterator insert(const_iterator_arg position, value_type&& value) {
+			return makeIt(base_type::insert(toBase(position), std::move(value)));
+		}
+
+		iterator insert(const_iterator_arg position, std::initializer_list<value_type> ilist) {
+			return makeIt(base_type::insert(toBase(position), ilist));
+		}
+
+		iterator insert(const_iterator_arg position, const_iterator_arg first, const_iterator_arg last) {
+			auto other = toBaseOther(first, last);
+			return makeIt(base_type::insert(toBase(position), other.first, other.second));
+		}
+
+		iterator_safe insert_safe(const const_iterator_safe& position, const value_type& value) {
+			return makeSafeIt(base_type::insert(toBase(position), value));
+		}
+
+		iterator_safe insert_safe(const const_iterator_safe& position, size_type n, const value_type& value) {
+			return makeSafeIt(base_type::insert(toBase(position), n, value));
+		}
+
+		iterator_safe insert_safe(const const_iterator_safe& position, value_type&& value) {
+			return makeSafeIt(base_type::insert(toBase(position), std::move(value)));
+		}
+
+		iterator_safe insert_safe(const const_iterator_safe& position, std::initializer_list<value_type> ilist) {
+			return makeSafeIt(base_type::insert(toBase(position), ilist));
+		}
+
+		pointer erase_unsafe(const_pointer position) { return base_type::erase(position); }
+		pointer erase_unsafe(const_pointer first, const_pointer last) { return base_type::erase(first, last); }
+		pointer erase_unsorted_unsafe(const_pointer position) { return base_type::erase_unsorted(position); }
+
+		iterator erase(const_iterator_arg position) {
+			return makeIt(base_type::erase(toBaseDereferenceable(position)));
+		}
+
+		iterator erase(const_iterator_arg first, const_iterator_arg last) {
+			auto p = toBase(first, last);
+			return makeIt(base_type::erase(p.first, p.second));
+		}
+
+		iterator erase_unsorted(const_iterator_arg position) {
+			return makeIt(base_type::erase_unsorted(toBaseDereferenceable(position)));
+		}
+
+		iterator_safe erase_safe(const const_iterator_safe& position) {
+			return makeSafeIt(base_type::erase(toBaseDereferenceable(position)));
+		}
+
+		iterator_safe erase_safe(const const_iterator_safe& first, const const_iterator_safe& last) {
+			auto p = toBase(first, last);
+			return makeSafeIt(base_type::erase(p.first, p.second));
+		}
+
+		iterator_safe erase_unsorted_safe(const const_iterator_safe& position) {
+			return makeSafeIt(base_type::erase_unsorted(toBaseDereferenceable(position)));
+		}
+
+		using base_type::clear;
+
+		iterator_safe make_safe(const iterator& position) { return makeSafeIt(toBase(position)); }
+		const_iterator_safe make_safe(const const_iterator_arg& position) const { return makeSafeIt(toBase(position)); }
+
+	protected:
+		[[noreturn]] static void ThrowRangeException() { throw nodecpp::error::out_of_range; }
+
+		void checkNotEmpty() const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(empty()))
+					ThrowRangeException();
+			}
+		}
+
+		// Safety == none
+		const_pointer toBase(const_pointer it) const { return it; }
+		std::pair<const_pointer, const_pointer> toBase(const_pointer it, const_pointer it2) const { return { it, it2 }; }
+		std::pair<const_pointer, const_pointer> toBaseOther(const_pointer it, const_pointer it2) const { return { it, it2 }; }
+		const_pointer toBaseDereferenceable(const_pointer it) const { return it; }
+
+		// Safety == safe
+		// mb: iterators are only checked against capacity, but base needs them inside [begin, end]
+		const_pointer checkNotAfterEnd(const_pointer p) const {
+			if(NODECPP_UNLIKELY(p > end_unsafe()))
+				ThrowRangeException();
+			return p;
+		}
+
+		const_pointer toBase(const const_stack_only_iterator& it) const { return checkNotAfterEnd(it.toRaw(begin_unsafe())); }
+
+		std::pair<const_pointer, const_pointer> toBase(const const_stack_only_iterator& it, const const_stack_only_iterator& it2) const {
+			auto p = it.toRaw(begin_unsafe(), it2);
+			checkNotAfterEnd(p.second);
+			return p;
+		}
+
+		std::pair<const_pointer, const_pointer> toBaseOther(const const_stack_only_iterator& it, const const_stack_only_iterator& it2) const {
+			return it.toRawOther(it2);
+		}
+
+		const_pointer toBase(const const_heap_safe_iterator& it) const { return checkNotAfterEnd(it.toRaw(begin_unsafe())); }
+
+		std::pair<const_pointer, const_pointer> toBase(const const_heap_safe_iterator& it, const const_heap_safe_iterator& it2) const {
+			auto p = it.toRaw(begin_unsafe(), it2);
+			checkNotAfterEnd(p.second);
+			return p;
+		}
+
+		/// erase needs an iterator to an element, not \c end()
+		template <typename It>
+		const_pointer toBaseDereferenceable(const It& it) const {
+			const_pointer p = toBase(it);
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(p == end_unsafe()))
+					ThrowRangeException();
+			}
+			return p;
+		}
+
+		iterator makeIt(pointer it) {
+			if constexpr (use_base_iterator)
+				return it;
+			else
+				return iterator::makePtr(base_type::begin(), it, this);
+		}
+
+		const_iterator makeIt(const_pointer it) const {
+			if constexpr (use_base_iterator)
+				return it;
+			else
+				return const_iterator::makePtr(const_cast<this_type*>(this)->base_type::begin(), it, const_cast<this_type*>(this));
+		}
+
+		iterator_safe makeSafeIt(const_pointer it) {
+			const size_type ix = static_cast<size_type>(it - base_type::begin());
+			// heap safe iterators can't point to the inline buffer
+			base_type::spill();
+			return iterator_safe::makeIx(allocator_type::to_soft(base_type::mpHeap), ix, this);
+		}
+
+		const_iterator_safe makeSafeIt(const_pointer it) const {
+			const size_type ix = static_cast<size_type>(it - base_type::begin());
+			// heap safe iterators can't point to the inline buffer
+			const_cast<this_type*>(this)->base_type::spill();
+			return const_iterator_safe::makeIx(allocator_type::to_soft(base_type::mpHeap), ix, const_cast<this_type*>(this));
+		}
+	}; // class small_vector
+
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline bool operator==(const small_vector<T, N, Safety>& a, const small_vector<T, N, Safety>& b)
+	{
+		return a.size() == b.size() && eastl::equal(a.begin_unsafe(), a.end_unsafe(), b.begin_unsafe());
+	}
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline bool operator!=(const small_vector<T, N, Safety>& a, const small_vector<T, N, Safety>& b)
+	{
+		return !(a == b);
+	}
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline bool operator<(const small_vector<T, N, Safety>& a, const small_vector<T, N, Safety>& b)
+	{
+		return eastl::lexicographical_compare(a.begin_unsafe(), a.end_unsafe(), b.begin_unsafe(), b.end_unsafe());
+	}
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline bool operator>(const small_vector<T, N, Safety>& a, const small_vector<T, N, Safety>& b)
+	{
+		return b < a;
+	}
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline bool operator<=(const small_vector<T, N, Safety>& a, const small_vector<T, N, Safety>& b)
+	{
+		return !(b < a);
+	}
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline bool operator>=(const small_vector<T, N, Safety>& a, const small_vector<T, N, Safety>& b)
+	{
+		return !(a < b);
+	}
+
+	template <typename T, eastl_size_t N, memory_safety Safety>
+	inline void swap(small_vector<T, N, Safety>& a, small_vector<T, N, Safety>& b)
+	{
+		a.swap(b);
+	}
+
+} // namespace safememory
+
+#endif // SAFE_MEMORY_SMALL_VECTOR_H
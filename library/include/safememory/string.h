@@ -31,7 +31,9 @@
 #include <EASTL/string.h>
 #include <safememory/detail/allocator_to_eastl.h>
 #include <safememory/detail/array_iterator.h>
+#include <safememory/detail/string_kernels.h>
 #include <safememory/string_literal.h>
+#include <safememory/string_view.h>
 #include <safememory/functional.h> //for hash
 #include <safe_memory_error.h>
 
@@ -47,6 +49,7 @@ namespace safememory
 		typedef eastl::basic_string<T, detail::allocator_to_eastl_string<Safety>>  base_type;
         
 		typedef basic_string_literal<T>                         literal_type;
+		typedef basic_string_view<T, Safety>                    view_type;
 		typedef typename base_type::heap_array_type             heap_array_type;
 
 		typedef typename base_type::value_type                  value_type;
@@ -142,6 +145,7 @@ namespace safememory
 		// basic_string(this_type&& x, const allocator_type& allocator);
 
 		// explicit basic_string(const view_type& sv, const allocator_type& allocator = EASTL_BASIC_STRING_DEFAULT_ALLOCATOR);
+		explicit basic_string(const view_type& sv) : base_type(sv.data_unsafe(), sv.size(), allocator_type()) {}
 		// basic_string(const view_type& sv, size_type position, size_type n, const allocator_type& allocator = EASTL_BASIC_STRING_DEFAULT_ALLOCATOR);
 
 		// template <typename OtherCharType>
@@ -168,8 +172,9 @@ namespace safememory
 			return str;
 		}
 
-		// Implicit conversion operator
-		// operator basic_string_view<T>() const EA_NOEXCEPT;
+		// mb: no implicit conversion to view_type, making a view may reallocate,
+		// a string in SSO mode is moved to the heap first (see makeView)
+		view_type view() { return makeView(0, size()); }
 
 		// Operator=
 		this_type& operator=(const this_type& x) = default;
@@ -177,7 +182,7 @@ namespace safememory
 		this_type& operator=(const literal_type& l) { base_type::assign(l.c_str(), l.size()); return *this; }
 		this_type& operator=(value_type c) { base_type::operator=(c); return *this; }
 		this_type& operator=(std::initializer_list<value_type> ilist) { base_type::operator=(ilist); return *this; }
-		// this_type& operator=(view_type v);
+		this_type& operator=(const view_type& v) { base_type::assign(v.data_unsafe(), v.size()); return *this; }
 		this_type& operator=(this_type&& x) = default;
 
 		// #if EASTL_OPERATOR_EQUALS_OTHER_ENABLED
@@ -202,6 +207,7 @@ namespace safememory
 		this_type& assign_unsafe(const value_type* p, size_type n) { base_type::assign(p, n); return *this; }
 		this_type& assign_unsafe(const value_type* p) { base_type::assign(p); return *this; }
 		this_type& assign(const literal_type& l) { base_type::assign(l.c_str(), l.size()); return *this; }
+		this_type& assign(const view_type& v) { base_type::assign(v.data_unsafe(), v.size()); return *this; }
 		this_type& assign(size_type n, value_type c) { base_type::assign(n, c); return *this; }
 		this_type& assign_unsafe(const value_type* pBegin, const value_type* pEnd) { base_type::assign(pBegin, pEnd); return *this; }
 		this_type& assign(this_type&& x) { base_type::assign(std::move(x)); return *this; }
@@ -300,6 +306,7 @@ namespace safememory
 		this_type& operator+=(const this_type& x) { base_type::operator+=(x); return *this; }
 		// this_type& operator+=(const value_type* p) { base_type::operator+=(p); return *this; }
 		this_type& operator+=(const literal_type& l) { base_type::append(l.c_str(), l.size()); return *this; }
+		this_type& operator+=(const view_type& v) { base_type::append(v.data_unsafe(), v.size()); return *this; }
 		this_type& operator+=(value_type c) { base_type::operator+=(c); return *this; }
 
 		this_type& append(const this_type& x) { base_type::append(x); return *this; }
@@ -311,6 +318,7 @@ namespace safememory
 		this_type& append_unsafe(const value_type* p, size_type n) { base_type::append(p, n); return *this; }
 		this_type& append_unsafe(const value_type* p) { base_type::append(p); return *this; }
 		this_type& append(const literal_type& l) { base_type::append(l.c_str(), l.size()); return *this; }
+		this_type& append(const view_type& v) { base_type::append(v.data_unsafe(), v.size()); return *this; }
 		this_type& append(size_type n, value_type c) { base_type::append(n, c); return *this; }
 		this_type& append_unsafe(const value_type* pBegin, const value_type* pEnd) { base_type::append(pBegin, pEnd); return *this; }
 
@@ -520,11 +528,12 @@ namespace safememory
 		// size_type   copy(value_type* p, size_type n, size_type position = 0) const;
 
 		// Find operations
-		size_type find(const this_type& x,  size_type position = 0) const noexcept { return base_type::find(x.toBase(), position); }
+		size_type find(const this_type& x,  size_type position = 0) const noexcept { return findImpl(x.data(), position, x.size()); }
 		size_type find_unsafe(const value_type* p, size_type position = 0) const { return base_type::find(p, position); }
-		size_type find_unsafe(const value_type* p, size_type position, size_type n) { return base_type::find(p, position, n); }
-		size_type find(value_type c, size_type position = 0) const noexcept { return base_type::find(c, position); }
-		size_type find(const literal_type& l, size_type position = 0) const noexcept { return base_type::find(l.c_str(), position, l.size()); }
+		size_type find_unsafe(const value_type* p, size_type position, size_type n) { return findImpl(p, position, n); }
+		size_type find(value_type c, size_type position = 0) const noexcept { return findCharImpl(c, position); }
+		size_type find(const literal_type& l, size_type position = 0) const noexcept { return findImpl(l.c_str(), position, l.size()); }
+		size_type find(const view_type& v, size_type position = 0) const { return findImpl(v.data_unsafe(), position, v.size()); }
 
 		// Reverse find operations
 		size_type rfind(const this_type& x,  size_type position = npos) const noexcept { return base_type::rfind(x.toBase(), position); }
@@ -532,20 +541,23 @@ namespace safememory
 		size_type rfind_unsafe(const value_type* p, size_type position, size_type n) { return base_type::rfind(p, position, n); }
 		size_type rfind(value_type c, size_type position = npos) const noexcept { return base_type::rfind(c, position); }
 		size_type rfind(const literal_type& l, size_type position = npos) const noexcept { return base_type::rfind(l.c_str(), position, l.size()); }
+		size_type rfind(const view_type& v, size_type position = npos) const { return base_type::rfind(v.data_unsafe(), position, v.size()); }
 
 		// Find first-of operations
-		size_type find_first_of(const this_type& x, size_type position = 0) const noexcept { return base_type::find_first_of(x.toBase(), position); }
+		size_type find_first_of(const this_type& x, size_type position = 0) const noexcept { return findFirstOfImpl(x.data(), position, x.size()); }
 		size_type find_first_of_unsafe(const value_type* p, size_type position = 0) const { return base_type::find_first_of(p, position); }
-		size_type find_first_of_unsafe(const value_type* p, size_type position, size_type n) { return base_type::find_first_of(p, position, n); }
-		size_type find_first_of(value_type c, size_type position = 0) const noexcept { return base_type::find_first_of(c, position); }
-		size_type find_first_of(const literal_type& l, size_type position = 0) const noexcept { return base_type::find_first_of(l.c_str(), position, l.size()); }
+		size_type find_first_of_unsafe(const value_type* p, size_type position, size_type n) { return findFirstOfImpl(p, position, n); }
+		size_type find_first_of(value_type c, size_type position = 0) const noexcept { return findCharImpl(c, position); }
+		size_type find_first_of(const literal_type& l, size_type position = 0) const noexcept { return findFirstOfImpl(l.c_str(), position, l.size()); }
+		size_type find_first_of(const view_type& v, size_type position = 0) const { return findFirstOfImpl(v.data_unsafe(), position, v.size()); }
 
 		// Find last-of operations
-		size_type find_last_of(const this_type& x, size_type position = npos) const noexcept { return base_type::find_last_of(x.toBase(), position); }
+		size_type find_last_of(const this_type& x, size_type position = npos) const noexcept { return findLastOfImpl(x.data(), position, x.size()); }
 		size_type find_last_of_unsafe(const value_type* p, size_type position = npos) const { return base_type::find_last_of(p, position); }
-		size_type find_last_of_unsafe(const value_type* p, size_type position, size_type n) { return base_type::find_last_of(p, position, n); }
+		size_type find_last_of_unsafe(const value_type* p, size_type position, size_type n) { return findLastOfImpl(p, position, n); }
 		size_type find_last_of(value_type c, size_type position = npos) const noexcept { return base_type::find_last_of(c, position); }
-		size_type find_last_of(const literal_type& l, size_type position = npos) const noexcept { return base_type::find_last_of(l.c_str(), position, l.size()); }
+		size_type find_last_of(const literal_type& l, size_type position = npos) const noexcept { return findLastOfImpl(l.c_str(), position, l.size()); }
+		size_type find_last_of(const view_type& v, size_type position = npos) const { return findLastOfImpl(v.data_unsafe(), position, v.size()); }
 
 		// Find first not-of operations
 		size_type find_first_not_of(const this_type& x, size_type position = 0) const noexcept { return base_type::find_first_not_of(x.toBase(), position); }
@@ -567,6 +579,13 @@ namespace safememory
             return {CtorBaseType(), base_type::substr(position, n)};
         }
 
+		// zero copy substr, the view shares (and zombie checks) this string heap buffer
+		// not const, same as view()
+		view_type substr_view(size_type position = 0, size_type n = npos) {
+            checkPos(position);
+            return makeView(position, eastl::min_alt(n, size() - position));
+        }
+
 		// Comparison operations
 		int        compare(const this_type& x) const noexcept { return base_type::compare(x); }
 		int        compare(size_type pos1, size_type n1, const this_type& x) const {
@@ -597,6 +616,15 @@ namespace safememory
             return base_type::compare(pos1, n1, l.c_str(), l.size());
         }
 
+		int        compare(const view_type& v) const {
+            return base_type::compare(0, size(), v.data_unsafe(), v.size());
+        }
+
+		int        compare(size_type pos1, size_type n1, const view_type& v) const {
+            checkPos(pos1);
+            return base_type::compare(pos1, n1, v.data_unsafe(), v.size());
+        }
+
 		// static int compare(const value_type* pBegin1, const value_type* pEnd1, const value_type* pBegin2, const value_type* pEnd2);
 
 		// Case-insensitive comparison functions. Not part of C++ this_type. Only ASCII-level locale functionality is supported. Thus this is not suitable for localization purposes.
@@ -679,6 +707,60 @@ namespace safememory
 			return it.toRaw(begin_unsafe(), it2);
 		}
 
+		// mb: single byte chars go to vectorized kernels (see string_kernels.h),
+		// range checks are the same as in eastl::basic_string, kernels only see [data(), data() + size())
+		static constexpr bool use_kernels = sizeof(T) == 1;
+
+		static const char* toChars(const value_type* p) noexcept { return reinterpret_cast<const char*>(p); }
+		static size_type fromKernel(size_type offset, std::size_t r) noexcept {
+			return r == detail::kernel_npos ? npos : offset + static_cast<size_type>(r);
+		}
+
+		size_type findImpl(const value_type* p, size_type position, size_type n) const noexcept {
+			if constexpr (use_kernels) {
+				const size_type sz = size();
+				if(position > sz || n > sz - position)
+					return npos;
+				return fromKernel(position, detail::find_substring(toChars(data()) + position, sz - position, toChars(p), n));
+			}
+			else
+				return base_type::find(p, position, n);
+		}
+
+		size_type findCharImpl(value_type c, size_type position) const noexcept {
+			if constexpr (use_kernels) {
+				const size_type sz = size();
+				if(position >= sz)
+					return npos;
+				return fromKernel(position, detail::find_char(toChars(data()) + position, sz - position, static_cast<char>(c)));
+			}
+			else
+				return base_type::find(c, position);
+		}
+
+		size_type findFirstOfImpl(const value_type* p, size_type position, size_type n) const noexcept {
+			if constexpr (use_kernels) {
+				const size_type sz = size();
+				if(position >= sz)
+					return npos;
+				return fromKernel(position, detail::find_first_of_chars(toChars(data()) + position, sz - position, toChars(p), n));
+			}
+			else
+				return base_type::find_first_of(p, position, n);
+		}
+
+		size_type findLastOfImpl(const value_type* p, size_type position, size_type n) const noexcept {
+			if constexpr (use_kernels) {
+				const size_type sz = size();
+				if(sz == 0)
+					return npos;
+				const size_type last = position < sz ? position : sz - 1;
+				return fromKernel(0, detail::find_last_of_chars(toChars(data()), last + 1, toChars(p), n));
+			}
+			else
+				return base_type::find_last_of(p, position, n);
+		}
+
         size_type checkPos(size_type position) const {
             // mb: when EASTL_STRING_OPT_RANGE_ERRORS is 1, position is already checked at
             // eastl::basic_string. However, we prefer to check ourselves depending on
@@ -761,6 +843,20 @@ namespace safememory
 			return const_reverse_iterator_safe(makeSafeIt(it.base()));
 		}
 
+		view_type makeView(size_type position, size_type n) {
+			// mb: empty views don't need to keep the buffer, so don't move SSO strings for them
+			if(n == 0)
+				return view_type();
+
+			if(base_type::internalLayout().IsSSO()) {
+				// its on the stack, move it to heap
+				base_type::reserve(base_type::SSOLayout::SSO_CAPACITY + 1);
+			}
+
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::regular, base_type::internalLayout().IsHeap());
+			return view_type::makeView(allocator_type::to_soft(base_type::internalLayout().GetHeapBeginPtr()), position, n);
+		}
+
 	}; // basic_string
 
 	// non members operators
@@ -780,6 +876,16 @@ namespace safememory
     //     return eastl::operator==(a.to_base_unsafe(), ptr);
 	// }
 
+	template <typename T, memory_safety Safety>
+	inline bool operator==(const basic_string_view<T, Safety>& v, const basic_string<T, Safety>& b) {
+        return eastl::operator==(v.to_string_view_unsafe(), b.to_string_view_unsafe());
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator==(const basic_string<T, Safety>& a, const basic_string_view<T, Safety>& v) {
+        return eastl::operator==(a.to_string_view_unsafe(), v.to_string_view_unsafe());
+	}
+
 	template <typename T, memory_safety Safety>
 	inline bool operator==(const typename basic_string<T, Safety>::literal_type& lit, const basic_string<T, Safety>& b) {
         return eastl::operator==(lit.to_string_view_unsafe(), b.to_string_view_unsafe());
@@ -806,6 +912,16 @@ namespace safememory
     //     return eastl::operator!=(a.to_base_unsafe(), ptr);
 	// }
 
+	template <typename T, memory_safety Safety>
+	inline bool operator!=(const basic_string_view<T, Safety>& v, const basic_string<T, Safety>& b) {
+        return eastl::operator!=(v.to_string_view_unsafe(), b.to_string_view_unsafe());
+	}
+
+	template <typename T, memory_safety Safety>
+	inline bool operator!=(const basic_string<T, Safety>& a, const basic_string_view<T, Safety>& v) {
+        return eastl::operator!=(a.to_string_view_unsafe(), v.to_string_view_unsafe());
+	}
+
 	template <typename T, memory_safety Safety>
 	inline bool operator!=(const typename basic_string<T, Safety>::literal_type& lit, const basic_string<T, Safety>& b) {
         return eastl::operator!=(lit.to_string_view_unsafe(), b.to_string_view_unsafe());
@@ -947,7 +1063,10 @@ namespace safememory
 		typedef eastl::hash<typename safememory::basic_string<T, safememory::memory_safety::none>::base_type> base_type;
 		SAFEMEMORY_NO_SIDE_EFFECT std::size_t operator()(const basic_string<T, memory_safety::none>& x) const
 		{
-			return base_type::operator()(x.to_base_unsafe());
+			if constexpr (sizeof(T) == 1)
+				return detail::hash_chars(reinterpret_cast<const char*>(x.data()), x.size());
+			else
+				return base_type::operator()(x.to_base_unsafe());
 		}
 	};
 
@@ -957,7 +1076,10 @@ namespace safememory
 		typedef eastl::hash<typename safememory::basic_string<T, safememory::memory_safety::safe>::base_type> base_type;
 		SAFEMEMORY_NO_SIDE_EFFECT std::size_t operator()(const basic_string<T, memory_safety::safe>& x) const
 		{
-			return base_type::operator()(x.to_base_unsafe());
+			if constexpr (sizeof(T) == 1)
+				return detail::hash_chars(reinterpret_cast<const char*>(x.data()), x.size());
+			else
+				return base_type::operator()(x.to_base_unsafe());
 		}
 	};
 
@@ -1045,6 +1167,7 @@ namespace safememory
 		typedef basic_string<T, Safety>                         base_type;
 		typedef typename base_type::allocator_type              allocator_type;
         typedef typename base_type::literal_type                literal_type;
+        typedef typename base_type::view_type                   view_type;
 
 		typedef typename base_type::value_type                  value_type;
 		typedef typename base_type::pointer                     pointer;
@@ -1069,6 +1192,7 @@ namespace safememory
 		basic_string_safe(const this_type& x, size_type position, size_type n = npos) : base_type(x, position, n) {}
 		// basic_string_safe(const value_type* p) : base_type(p) {}
 		basic_string_safe(const literal_type& l) : base_type(l) {}
+		explicit basic_string_safe(const view_type& v) : base_type(v) {}
 		basic_string_safe(size_type n, value_type c) : base_type(n, c) {}
 		basic_string_safe(const this_type& x) = default;
 		basic_string_safe(std::initializer_list<value_type> init) : base_type(init) {}
@@ -1080,6 +1204,7 @@ namespace safememory
 		this_type& operator=(const this_type& x) = default;
 		// this_type& operator=(const value_type* p) { base_type::operator=(p); return *this; }
 		this_type& operator=(const literal_type& l) { base_type::operator=(l); return *this; }
+		this_type& operator=(const view_type& v) { base_type::operator=(v); return *this; }
 		this_type& operator=(value_type c) { base_type::operator=(c); return *this; }
 		this_type& operator=(std::initializer_list<value_type> ilist) { base_type::operator=(ilist); return *this; }
 		this_type& operator=(this_type&& x) = default;
@@ -1091,6 +1216,7 @@ namespace safememory
 		this_type& assign(const this_type& x, size_type position, size_type n = npos) { base_type::assign(x, position, n); return *this; }
 		// this_type& assign(const value_type* p) { base_type::assign(p); return *this; }
 		this_type& assign(const literal_type& l) { base_type::assign(l); return *this; }
+		this_type& assign(const view_type& v) { base_type::assign(v); return *this; }
 		this_type& assign(size_type n, value_type c) { base_type::assign(n, c); return *this; }
 		this_type& assign(this_type&& x) { base_type::assign(std::move(x)); return *this; }
 		this_type& assign(std::initializer_list<value_type> init) { base_type::assign(init); return *this; }
@@ -1149,12 +1275,14 @@ namespace safememory
 		this_type& operator+=(const this_type& x) { base_type::operator+=(x); return *this; }
 		// this_type& operator+=(const value_type* p) { base_type::operator+=(p); return *this; }
 		this_type& operator+=(const literal_type& l) { base_type::operator+=(l); return *this; }
+		this_type& operator+=(const view_type& v) { base_type::operator+=(v); return *this; }
 		this_type& operator+=(value_type c) { base_type::operator+=(c); return *this; }
 
 		this_type& append(const this_type& x) { base_type::append(x); return *this; }
 		this_type& append(const this_type& x,  size_type position, size_type n = npos) { base_type::append(x, position, n); return *this; }
 		// this_type& append(const value_type* p) { base_type::append(p); return *this; }
 		this_type& append(const literal_type& l) { base_type::append(l); return *this; }
+		this_type& append(const view_type& v) { base_type::append(v); return *this; }
 		this_type& append(size_type n, value_type c) { base_type::append(n, c); return *this; }
 
         // using base_type::push_back;
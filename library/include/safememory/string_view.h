@@ -0,0 +1,356 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_MEMORY_STRING_VIEW_H
+#define SAFE_MEMORY_STRING_VIEW_H
+
+#include <EASTL/string_view.h>
+#include <safememory/detail/allocator_to_eastl.h>
+#include <safememory/detail/array_iterator.h>
+#include <safememory/detail/string_kernels.h>
+#include <safememory/string_literal.h>
+#include <safememory/functional.h> //for hash
+#include <safe_memory_error.h>
+
+namespace safememory
+{
+	/**
+	 * \brief Non owning view of a range of chars inside a \c basic_string buffer.
+	 * 
+	 * Holds a soft pointer to the string heap array plus offset and length,
+	 * so slicing a large buffer doesn't copy anything.
+	 * Every access goes through the soft pointer, if the string is destroyed or
+	 * its buffer reallocated, the view is a zombie and access will throw.
+	 * Changes to the string that don't reallocate are visible through the view,
+	 * but the view never reaches outside the array it points to.
+	 * 
+	 * Views are only created by \c basic_string (see \c view and \c substr_view),
+	 * that moves SSO strings to the heap first, so neither of them is \c const.
+	 */
+	template<typename T, memory_safety Safety = safeness_declarator<T>::is_safe>
+	class SAFEMEMORY_DEEP_CONST_WHEN_PARAMS basic_string_view
+	{
+	public:
+		typedef basic_string_view<T, Safety>                              this_type;
+		typedef basic_string_literal<T>                                   literal_type;
+		typedef detail::allocator_to_eastl_string<Safety>                 allocator_type;
+		typedef typename allocator_type::template soft_array_pointer<T>   soft_ptr_type;
+
+		typedef T                                                         value_type;
+		typedef const T*                                                  const_pointer;
+		typedef const T&                                                  const_reference;
+		typedef eastl_size_t                                              size_type;
+		typedef eastl_ssize_t                                             difference_type;
+
+		typedef detail::array_heap_safe_iterator<T, true, soft_ptr_type>  const_heap_safe_iterator;
+		typedef const_heap_safe_iterator                                  const_iterator_safe;
+		typedef eastl::reverse_iterator<const_iterator_safe>              const_reverse_iterator_safe;
+		typedef const_iterator_safe                                       const_iterator;
+		typedef const_reverse_iterator_safe                               const_reverse_iterator;
+
+		static constexpr size_type npos = size_type(-1);
+		static constexpr memory_safety is_safe = Safety;
+
+	private:
+		soft_ptr_type arr;
+		size_type offset = 0;
+		size_type sz = 0;
+
+		basic_string_view(const soft_ptr_type& arr, size_type offset, size_type sz)
+			: arr(arr), offset(offset), sz(sz) {}
+
+		[[noreturn]] static void ThrowRangeException() { throw nodecpp::error::out_of_range; }
+
+	public:
+		basic_string_view() {}
+
+		basic_string_view(const basic_string_view& other) = default;
+		basic_string_view& operator=(const basic_string_view& other) = default;
+		basic_string_view(basic_string_view&& other) = default;
+		basic_string_view& operator=(basic_string_view&& other) = default;
+
+		~basic_string_view() = default;
+
+		/// static factory methods are unsafe but static checker tool will keep user hands away
+		static this_type makeView(const soft_ptr_type& arr, size_type offset, size_type sz) {
+			NODECPP_ASSERT(module_id, nodecpp::assert::AssertLevel::regular, arr || (offset == 0 && sz == 0));
+			NODECPP_ASSERT(module_id, nodecpp::assert::AssertLevel::regular, !arr || offset + sz <= arr->size());
+			return {arr, offset, sz};
+		}
+
+		const_iterator_safe begin() const noexcept { return const_iterator_safe::makeIx(arr, offset, offset + sz); }
+		const_iterator_safe cbegin() const noexcept { return const_iterator_safe::makeIx(arr, offset, offset + sz); }
+
+		const_iterator_safe end() const noexcept { return const_iterator_safe::makeIx(arr, offset + sz, offset + sz); }
+		const_iterator_safe cend() const noexcept { return const_iterator_safe::makeIx(arr, offset + sz, offset + sz); }
+
+		const_reverse_iterator_safe rbegin() const noexcept { return const_reverse_iterator_safe(cend()); }
+		const_reverse_iterator_safe crbegin() const noexcept { return const_reverse_iterator_safe(cend()); }
+
+		const_reverse_iterator_safe rend() const noexcept { return const_reverse_iterator_safe(cbegin()); }
+		const_reverse_iterator_safe crend() const noexcept { return const_reverse_iterator_safe(cbegin()); }
+
+		bool empty() const noexcept { return sz == 0; }
+		size_type size() const noexcept { return sz; }
+		size_type length() const noexcept { return sz; }
+
+		/// raw pointer to first char, dereference of the soft pointer does the zombie check
+		const_pointer data_unsafe() const { return arr ? arr->data() + offset : nullptr; }
+
+		const_reference operator[](size_type i) const { return at(i); }
+
+		const_reference at(size_type i) const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(i >= size()))
+					ThrowRangeException();
+			}
+
+			return data_unsafe()[i];
+		}
+
+		const_reference front() const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(empty()))
+					ThrowRangeException();
+			}
+
+			return data_unsafe()[0];
+		}
+
+		const_reference back() const {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(empty()))
+					ThrowRangeException();
+			}
+
+			return data_unsafe()[size() - 1];
+		}
+
+		void remove_prefix(size_type n) {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(n > size()))
+					ThrowRangeException();
+			}
+
+			offset += n;
+			sz -= n;
+		}
+
+		void remove_suffix(size_type n) {
+			if constexpr(is_safe == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(n > size()))
+					ThrowRangeException();
+			}
+
+			sz -= n;
+		}
+
+		void swap(this_type& v) {
+			eastl::swap(arr, v.arr);
+			eastl::swap(offset, v.offset);
+			eastl::swap(sz, v.sz);
+		}
+
+		/// zero copy, the returned view shares the same heap array
+		this_type substr(size_type position = 0, size_type n = npos) const {
+			checkPos(position);
+			return {arr, offset + position, eastl::min_alt(n, sz - position)};
+		}
+
+		int compare(const this_type& v) const { return to_string_view_unsafe().compare(v.to_string_view_unsafe()); }
+		int compare(size_type pos1, size_type n1, const this_type& v) const { return substr(pos1, n1).compare(v); }
+		int compare(const literal_type& l) const { return to_string_view_unsafe().compare(l.to_string_view_unsafe()); }
+		int compare(size_type pos1, size_type n1, const literal_type& l) const { return substr(pos1, n1).compare(l); }
+
+		bool starts_with(const this_type& v) const { return to_string_view_unsafe().starts_with(v.to_string_view_unsafe()); }
+		bool starts_with(value_type c) const { return to_string_view_unsafe().starts_with(c); }
+		bool starts_with(const literal_type& l) const { return to_string_view_unsafe().starts_with(l.to_string_view_unsafe()); }
+
+		bool ends_with(const this_type& v) const { return to_string_view_unsafe().ends_with(v.to_string_view_unsafe()); }
+		bool ends_with(value_type c) const { return to_string_view_unsafe().ends_with(c); }
+		bool ends_with(const literal_type& l) const { return to_string_view_unsafe().ends_with(l.to_string_view_unsafe()); }
+
+		size_type find(const this_type& v, size_type position = 0) const { return findImpl(v.data_unsafe(), position, v.size()); }
+		size_type find(value_type c, size_type position = 0) const { return findCharImpl(c, position); }
+		size_type find(const literal_type& l, size_type position = 0) const { return findImpl(l.c_str(), position, l.size()); }
+
+		size_type rfind(const this_type& v, size_type position = npos) const { return fromView(to_string_view_unsafe().rfind(v.to_string_view_unsafe(), position)); }
+		size_type rfind(value_type c, size_type position = npos) const { return fromView(to_string_view_unsafe().rfind(c, position)); }
+		size_type rfind(const literal_type& l, size_type position = npos) const { return fromView(to_string_view_unsafe().rfind(l.to_string_view_unsafe(), position)); }
+
+		size_type find_first_of(const this_type& v, size_type position = 0) const { return findFirstOfImpl(v.data_unsafe(), position, v.size()); }
+		size_type find_first_of(value_type c, size_type position = 0) const { return findCharImpl(c, position); }
+		size_type find_first_of(const literal_type& l, size_type position = 0) const { return findFirstOfImpl(l.c_str(), position, l.size()); }
+
+		size_type find_last_of(const this_type& v, size_type position = npos) const { return findLastOfImpl(v.data_unsafe(), position, v.size()); }
+		size_type find_last_of(value_type c, size_type position = npos) const { return fromView(to_string_view_unsafe().find_last_of(c, position)); }
+		size_type find_last_of(const literal_type& l, size_type position = npos) const { return findLastOfImpl(l.c_str(), position, l.size()); }
+
+		size_type find_first_not_of(const this_type& v, size_type position = 0) const { return fromView(to_string_view_unsafe().find_first_not_of(v.to_string_view_unsafe(), position)); }
+		size_type find_first_not_of(value_type c, size_type position = 0) const { return fromView(to_string_view_unsafe().find_first_not_of(c, position)); }
+		size_type find_first_not_of(const literal_type& l, size_type position = 0) const { return fromView(to_string_view_unsafe().find_first_not_of(l.to_string_view_unsafe(), position)); }
+
+		size_type find_last_not_of(const this_type& v, size_type position = npos) const { return fromView(to_string_view_unsafe().find_last_not_of(v.to_string_view_unsafe(), position)); }
+		size_type find_last_not_of(value_type c, size_type position = npos) const { return fromView(to_string_view_unsafe().find_last_not_of(c, position)); }
+		size_type find_last_not_of(const literal_type& l, size_type position = npos) const { return fromView(to_string_view_unsafe().find_last_not_of(l.to_string_view_unsafe(), position)); }
+
+		eastl::basic_string_view<T> to_string_view_unsafe() const {
+			return eastl::basic_string_view<T>(data_unsafe(), size());
+		}
+
+	private:
+		size_type checkPos(size_type position) const {
+			if constexpr (Safety == memory_safety::safe) {
+				if(NODECPP_UNLIKELY(position > size()))
+					ThrowRangeException();
+			}
+			return position;
+		}
+
+		// mb: same as basic_string, single byte chars go to vectorized kernels (see string_kernels.h)
+		static constexpr bool use_kernels = sizeof(T) == 1;
+
+		static const char* toChars(const value_type* p) noexcept { return reinterpret_cast<const char*>(p); }
+		static size_type fromKernel(size_type offset, std::size_t r) noexcept {
+			return r == detail::kernel_npos ? npos : offset + static_cast<size_type>(r);
+		}
+		static size_type fromView(std::size_t r) noexcept {
+			return r == eastl::basic_string_view<T>::npos ? npos : static_cast<size_type>(r);
+		}
+
+		size_type findImpl(const value_type* p, size_type position, size_type n) const {
+			if constexpr (use_kernels) {
+				if(position > sz || n > sz - position)
+					return npos;
+				return fromKernel(position, detail::find_substring(toChars(data_unsafe()) + position, sz - position, toChars(p), n));
+			}
+			else
+				return fromView(to_string_view_unsafe().find(p, position, n));
+		}
+
+		size_type findCharImpl(value_type c, size_type position) const {
+			if constexpr (use_kernels) {
+				if(position >= sz)
+					return npos;
+				return fromKernel(position, detail::find_char(toChars(data_unsafe()) + position, sz - position, static_cast<char>(c)));
+			}
+			else
+				return fromView(to_string_view_unsafe().find(c, position));
+		}
+
+		size_type findFirstOfImpl(const value_type* p, size_type position, size_type n) const {
+			if constexpr (use_kernels) {
+				if(position >= sz)
+					return npos;
+				return fromKernel(position, detail::find_first_of_chars(toChars(data_unsafe()) + position, sz - position, toChars(p), n));
+			}
+			else
+				return fromView(to_string_view_unsafe().find_first_of(p, position, n));
+		}
+
+		size_type findLastOfImpl(const value_type* p, size_type position, size_type n) const {
+			if constexpr (use_kernels) {
+				if(sz == 0)
+					return npos;
+				const size_type last = position < sz ? position : sz - 1;
+				return fromKernel(0, detail::find_last_of_chars(toChars(data_unsafe()), last + 1, toChars(p), n));
+			}
+			else
+				return fromView(to_string_view_unsafe().find_last_of(p, position, n));
+		}
+	};
+
+	template<class T, memory_safety S>
+	bool operator==(const basic_string_view<T, S>& a, const basic_string_view<T, S>& b) {
+		return a.size() == b.size() && a.compare(b) == 0;
+	}
+
+	template<class T, memory_safety S>
+	bool operator!=(const basic_string_view<T, S>& a, const basic_string_view<T, S>& b) {
+		return !(a == b);
+	}
+
+	template<class T, memory_safety S>
+	bool operator<(const basic_string_view<T, S>& a, const basic_string_view<T, S>& b) {
+		return a.compare(b) < 0;
+	}
+
+	template<class T, memory_safety S>
+	bool operator<=(const basic_string_view<T, S>& a, const basic_string_view<T, S>& b) {
+		return a.compare(b) <= 0;
+	}
+
+	template<class T, memory_safety S>
+	bool operator>(const basic_string_view<T, S>& a, const basic_string_view<T, S>& b) {
+		return a.compare(b) > 0;
+	}
+
+	template<class T, memory_safety S>
+	bool operator>=(const basic_string_view<T, S>& a, const basic_string_view<T, S>& b) {
+		return a.compare(b) >= 0;
+	}
+
+	template<class T, memory_safety S>
+	bool operator==(const basic_string_view<T, S>& a, const typename basic_string_view<T, S>::literal_type& l) {
+		return a.size() == l.size() && a.compare(l) == 0;
+	}
+
+	template<class T, memory_safety S>
+	bool operator==(const typename basic_string_view<T, S>::literal_type& l, const basic_string_view<T, S>& b) {
+		return b == l;
+	}
+
+	template<class T, memory_safety S>
+	bool operator!=(const basic_string_view<T, S>& a, const typename basic_string_view<T, S>::literal_type& l) {
+		return !(a == l);
+	}
+
+	template<class T, memory_safety S>
+	bool operator!=(const typename basic_string_view<T, S>::literal_type& l, const basic_string_view<T, S>& b) {
+		return !(b == l);
+	}
+
+	template<typename T, memory_safety Safety>
+	struct SAFEMEMORY_DEEP_CONST hash<basic_string_view<T, Safety>>
+	{
+		SAFEMEMORY_NO_SIDE_EFFECT std::size_t operator()(const basic_string_view<T, Safety>& x) const
+		{
+			return detail::hash_chars(reinterpret_cast<const char*>(x.data_unsafe()), x.size() * sizeof(T));
+		}
+	};
+
+	typedef basic_string_view<char>    string_view;
+	typedef basic_string_view<wchar_t> wstring_view;
+
+	typedef basic_string_view<char8_t>  u8string_view;
+	typedef basic_string_view<char16_t> u16string_view;
+	typedef basic_string_view<char32_t> u32string_view;
+
+} //namespace safememory
+
+#endif // SAFE_MEMORY_STRING_VIEW_H
@@ -0,0 +1,254 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#include <safememory/detail/string_kernels.h>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SAFEMEMORY_STRING_KERNELS_SSE2
+#include <emmintrin.h>
+#if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define SAFEMEMORY_STRING_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace safememory::detail {
+
+namespace {
+
+inline std::size_t lowestBit(uint32_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long ix;
+	_BitScanForward(&ix, x);
+	return ix;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+inline std::size_t highestBit(uint32_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long ix;
+	_BitScanReverse(&ix, x);
+	return ix;
+#else
+	return 31 - __builtin_clz(x);
+#endif
+}
+
+inline std::size_t offsetResult(std::size_t offset, std::size_t r) { return r == kernel_npos ? kernel_npos : offset + r; }
+
+/// 256 bit set of chars, for \c find_first_of with many chars
+struct char_set
+{
+	uint64_t bits[4] = {0, 0, 0, 0};
+
+	char_set(const char* s, std::size_t m) {
+		for(std::size_t j = 0; j != m; ++j) {
+			unsigned char c = static_cast<unsigned char>(s[j]);
+			bits[c >> 6] |= uint64_t(1) << (c & 63);
+		}
+	}
+
+	bool contains(char ch) const {
+		unsigned char c = static_cast<unsigned char>(ch);
+		return (bits[c >> 6] >> (c & 63)) & 1;
+	}
+};
+
+inline std::size_t findCharScalar(const char* p, std::size_t n, char c)
+{
+	const void* r = n ? std::memchr(p, c, n) : nullptr;
+	return r ? static_cast<const char*>(r) - p : kernel_npos;
+}
+
+inline std::size_t findSubstringScalar(const char* p, std::size_t n, const char* s, std::size_t m)
+{
+	if(m == 0)
+		return 0;
+	if(m > n)
+		return kernel_npos;
+
+	const std::size_t end = n - m + 1; // candidate positions are [0, end)
+	std::size_t i = 0;
+	while(i < end) {
+		std::size_t f = findCharScalar(p + i, end - i, s[0]);
+		if(f == kernel_npos)
+			return kernel_npos;
+		i += f;
+		if(std::memcmp(p + i + 1, s + 1, m - 1) == 0)
+			return i;
+		++i;
+	}
+	return kernel_npos;
+}
+
+inline std::size_t findFirstOfScalar(const char* p, std::size_t n, const char_set& set)
+{
+	for(std::size_t i = 0; i != n; ++i)
+		if(set.contains(p[i]))
+			return i;
+	return kernel_npos;
+}
+
+inline std::size_t findLastOfScalar(const char* p, std::size_t n, const char_set& set)
+{
+	while(n != 0) {
+		--n;
+		if(set.contains(p[n]))
+			return n;
+	}
+	return kernel_npos;
+}
+
+#ifdef SAFEMEMORY_STRING_KERNELS_SSE2
+
+namespace sse2 {
+	typedef __m128i vreg;
+	constexpr std::size_t vwidth = 16;
+
+	inline vreg vload(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+	inline vreg vbroadcast(char c) { return _mm_set1_epi8(c); }
+	inline vreg vcmpeq(vreg a, vreg b) { return _mm_cmpeq_epi8(a, b); }
+	inline vreg vor(vreg a, vreg b) { return _mm_or_si128(a, b); }
+	inline uint32_t vmovemask(vreg a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+
+#include "string_kernels.inl"
+} // namespace sse2
+
+#endif // SAFEMEMORY_STRING_KERNELS_SSE2
+
+#ifdef SAFEMEMORY_STRING_KERNELS_AVX2
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace avx2 {
+	typedef __m256i vreg;
+	constexpr std::size_t vwidth = 32;
+
+	inline vreg vload(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+	inline vreg vbroadcast(char c) { return _mm256_set1_epi8(c); }
+	inline vreg vcmpeq(vreg a, vreg b) { return _mm256_cmpeq_epi8(a, b); }
+	inline vreg vor(vreg a, vreg b) { return _mm256_or_si256(a, b); }
+	inline uint32_t vmovemask(vreg a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+
+#include "string_kernels.inl"
+} // namespace avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif // SAFEMEMORY_STRING_KERNELS_AVX2
+
+#ifdef SAFEMEMORY_STRING_KERNELS_SSE2
+
+struct string_kernels_table
+{
+	std::size_t (*findChar)(const char*, std::size_t, char) noexcept;
+	std::size_t (*findSubstring)(const char*, std::size_t, const char*, std::size_t) noexcept;
+	std::size_t (*findFirstOf)(const char*, std::size_t, const char*, std::size_t) noexcept;
+	std::size_t (*findLastOf)(const char*, std::size_t, const char*, std::size_t) noexcept;
+};
+
+// mb: SSE2 version is set at constant initialization, so that strings used by other
+// static initializers work before the AVX2 version is selected below
+string_kernels_table kernels = { sse2::findChar, sse2::findSubstring, sse2::findFirstOf, sse2::findLastOf };
+
+#ifdef SAFEMEMORY_STRING_KERNELS_AVX2
+bool selectAvx2Kernels()
+{
+	__builtin_cpu_init(); // required when called before main
+	if(!__builtin_cpu_supports("avx2"))
+		return false;
+
+	kernels = { avx2::findChar, avx2::findSubstring, avx2::findFirstOf, avx2::findLastOf };
+	return true;
+}
+
+const bool avx2KernelsSelected = selectAvx2Kernels();
+#endif // SAFEMEMORY_STRING_KERNELS_AVX2
+
+#endif // SAFEMEMORY_STRING_KERNELS_SSE2
+
+inline uint64_t rotateLeft(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+} // unnamed namespace
+
+
+#ifdef SAFEMEMORY_STRING_KERNELS_SSE2
+
+std::size_t find_char(const char* p, std::size_t n, char c) noexcept { return kernels.findChar(p, n, c); }
+std::size_t find_substring(const char* p, std::size_t n, const char* s, std::size_t m) noexcept { return kernels.findSubstring(p, n, s, m); }
+std::size_t find_first_of_chars(const char* p, std::size_t n, const char* set, std::size_t m) noexcept { return kernels.findFirstOf(p, n, set, m); }
+std::size_t find_last_of_chars(const char* p, std::size_t n, const char* set, std::size_t m) noexcept { return kernels.findLastOf(p, n, set, m); }
+
+#else
+
+std::size_t find_char(const char* p, std::size_t n, char c) noexcept { return findCharScalar(p, n, c); }
+std::size_t find_substring(const char* p, std::size_t n, const char* s, std::size_t m) noexcept { return findSubstringScalar(p, n, s, m); }
+std::size_t find_first_of_chars(const char* p, std::size_t n, const char* set, std::size_t m) noexcept { return findFirstOfScalar(p, n, char_set(set, m)); }
+std::size_t find_last_of_chars(const char* p, std::size_t n, const char* set, std::size_t m) noexcept { return findLastOfScalar(p, n, char_set(set, m)); }
+
+#endif // SAFEMEMORY_STRING_KERNELS_SSE2
+
+// 8 bytes per step instead of byte-by-byte FNV of eastl::hash
+std::size_t hash_chars(const char* p, std::size_t n) noexcept
+{
+	constexpr uint64_t k = 0x9E3779B97F4A7C15ull;
+	uint64_t h = 0xcbf29ce484222325ull ^ n;
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		uint64_t w;
+		std::memcpy(&w, p + i, 8);
+		h = (rotateLeft(h, 5) ^ w) * k;
+	}
+	if(i != n) {
+		uint64_t w = 0;
+		std::memcpy(&w, p + i, n - i);
+		h = (rotateLeft(h, 5) ^ w) * k;
+	}
+	return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+} // namespace safememory::detail
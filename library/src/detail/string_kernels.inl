@@ -0,0 +1,123 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+// Vectorized implementation of string kernels, included from string_kernels.cpp
+// once per instruction set, inside a namespace that defines:
+//   vreg, vwidth, vload(p), vbroadcast(c), vcmpeq(a, b), vor(a, b), vmovemask(a)
+// Scalar helpers from string_kernels.cpp are used for tails.
+
+constexpr std::size_t max_vector_set = 8; // larger sets are checked with a bitmap
+
+inline std::size_t findChar(const char* p, std::size_t n, char c) noexcept
+{
+	const vreg vc = vbroadcast(c);
+	std::size_t i = 0;
+	for(; i + vwidth <= n; i += vwidth) {
+		uint32_t mask = vmovemask(vcmpeq(vload(p + i), vc));
+		if(mask)
+			return i + lowestBit(mask);
+	}
+	return offsetResult(i, findCharScalar(p + i, n - i, c));
+}
+
+inline std::size_t findSubstring(const char* p, std::size_t n, const char* s, std::size_t m) noexcept
+{
+	if(m == 0)
+		return 0;
+	if(m > n)
+		return kernel_npos;
+	if(m == 1)
+		return findChar(p, n, s[0]);
+
+	// only positions where both first and last chars match are compared in full
+	const vreg first = vbroadcast(s[0]);
+	const vreg last = vbroadcast(s[m - 1]);
+	const std::size_t end = n - m + 1; // candidate positions are [0, end)
+	std::size_t i = 0;
+	for(; i + vwidth <= end; i += vwidth) {
+		uint32_t mask = vmovemask(vcmpeq(vload(p + i), first)) & vmovemask(vcmpeq(vload(p + i + m - 1), last));
+		while(mask) {
+			std::size_t b = lowestBit(mask);
+			if(std::memcmp(p + i + b + 1, s + 1, m - 2) == 0)
+				return i + b;
+			mask &= mask - 1;
+		}
+	}
+	return offsetResult(i, findSubstringScalar(p + i, n - i, s, m));
+}
+
+inline std::size_t findFirstOf(const char* p, std::size_t n, const char* set, std::size_t m) noexcept
+{
+	if(m == 0)
+		return kernel_npos;
+	if(m == 1)
+		return findChar(p, n, set[0]);
+	if(m > max_vector_set)
+		return findFirstOfScalar(p, n, char_set(set, m));
+
+	vreg vs[max_vector_set];
+	for(std::size_t j = 0; j != m; ++j)
+		vs[j] = vbroadcast(set[j]);
+
+	std::size_t i = 0;
+	for(; i + vwidth <= n; i += vwidth) {
+		const vreg x = vload(p + i);
+		vreg acc = vcmpeq(x, vs[0]);
+		for(std::size_t j = 1; j != m; ++j)
+			acc = vor(acc, vcmpeq(x, vs[j]));
+		uint32_t mask = vmovemask(acc);
+		if(mask)
+			return i + lowestBit(mask);
+	}
+	return offsetResult(i, findFirstOfScalar(p + i, n - i, char_set(set, m)));
+}
+
+inline std::size_t findLastOf(const char* p, std::size_t n, const char* set, std::size_t m) noexcept
+{
+	if(m == 0)
+		return kernel_npos;
+	if(m > max_vector_set)
+		return findLastOfScalar(p, n, char_set(set, m));
+
+	vreg vs[max_vector_set];
+	for(std::size_t j = 0; j != m; ++j)
+		vs[j] = vbroadcast(set[j]);
+
+	std::size_t i = n;
+	while(i >= vwidth) {
+		i -= vwidth;
+		const vreg x = vload(p + i);
+		vreg acc = vcmpeq(x, vs[0]);
+		for(std::size_t j = 1; j != m; ++j)
+			acc = vor(acc, vcmpeq(x, vs[j]));
+		uint32_t mask = vmovemask(acc);
+		if(mask)
+			return i + highestBit(mask);
+	}
+	return findLastOfScalar(p, i, char_set(set, m));
+}
@@ -29,6 +29,7 @@
 #define MEMORY_SAFETY_H
 
 #include <cstdint>
+#include <cstddef>
 //mb: temporary hack, until we move all files to their definitive location
 // and rename namespaces acordingly
 
@@ -70,12 +71,21 @@ struct safeness_declarator {
 #endif
 };
 
+/// Number of soft_ptr slots reserved inline (within the same allocation) for objects of type T.
+/// The first 3 live in the control block in front of the object; any extra ones are placed right after it.
+/// Types commonly pointed to by many soft_ptrs at once may specialize it to avoid a separate slot allocation.
+template<class T>
+struct soft_ptr_slots_declarator {
+	static constexpr std::size_t inline_slots = 3;
+};
+
 #ifdef NODECPP_MEMORY_SAFETY_EXCLUSIONS
 #include NODECPP_MEMORY_SAFETY_EXCLUSIONS
 #endif
 
 /* Sample of user-defined exclusion:
 template<> struct safememory::safeness_declarator<double> { static constexpr memory_safety is_safe = memory_safety::none; };
+template<> struct safememory::soft_ptr_slots_declarator<MyNode> { static constexpr std::size_t inline_slots = 8; };
 */
 
 } // namespace safememory
@@ -27,6 +27,12 @@
 
 #include "safe_ptr_common.h"
 #include "safe_ptr_impl.h"
+#include "safe_ptr_shared.h"
+#if defined NODECPP_WINDOWS
+#include <windows.h>
+#elif defined NODECPP_LINUX || defined __linux__ || defined __APPLE__
+#include <pthread.h>
+#endif
 
 
 #ifdef NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING
@@ -42,10 +48,250 @@ thread_local std::size_t safememory::detail::CountSoftPtrBaseDtor = 0;
 thread_local void* safememory::detail::thg_stackPtrForMakeOwningCall = NODECPP_SECOND_NULLPTR;
 
 namespace safememory::detail {
+thread_local StackBounds thg_stackBounds; // zero-initialized
+
+void initThreadStackBounds()
+{
+	uintptr_t lo = 0;
+	uintptr_t hi = 0;
+#if defined NODECPP_WINDOWS
+	ULONG_PTR low, high;
+	GetCurrentThreadStackLimits( &low, &high );
+	lo = low;
+	hi = high;
+#elif defined NODECPP_LINUX || defined __linux__
+	pthread_attr_t attr;
+	if ( pthread_getattr_np( pthread_self(), &attr ) == 0 )
+	{
+		void* addr = nullptr;
+		size_t size = 0;
+		if ( pthread_attr_getstack( &attr, &addr, &size ) == 0 )
+		{
+			lo = reinterpret_cast<uintptr_t>( addr );
+			hi = lo + size;
+		}
+		pthread_attr_destroy( &attr );
+	}
+#elif defined __APPLE__
+	hi = reinterpret_cast<uintptr_t>( pthread_get_stackaddr_np( pthread_self() ) ); // stack grows down from here
+	lo = hi - pthread_get_stacksize_np( pthread_self() );
+#endif
+	if ( hi == 0 || lo >= hi )
+		lo = hi = 1; // empty range, but marks bounds as initialized
+	// sanity check: we are on this stack right now
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, hi == 1 || ( reinterpret_cast<uintptr_t>( &lo ) >= lo && reinterpret_cast<uintptr_t>( &lo ) < hi ) );
+	thg_stackBounds.lo = lo;
+	thg_stackBounds.hi = hi;
+}
+
+OnStackSafePtrMetrics getOnStackSafePtrMetrics()
+{
+#ifdef NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING
+	return { onStackSafePtrCreationCount, onStackSafePtrDestructionCount };
+#else
+	return { 0, 0 };
+#endif
+}
+
+std::atomic<size_t> secondCBBytesInUse{0};
+std::atomic<size_t> secondCBBytesPooled{0};
+thread_local SecondCBPool thg_secondCBPool; // zero-initialized
+
+static void emptySecondCBPool( bool deallocateBlocks )
+{
+	SecondCBPool& pool = thg_secondCBPool;
+	for ( size_t k=0; k<SecondCBPool::sizeClassCount; ++k )
+	{
+		size_t sz = FirstControlBlock::SecondCBHeader::byteSize( ( FirstControlBlock::secondBlockStartSize + 2 ) * ( ((size_t)1) << k ) - 2 );
+		while ( pool.heads[k] != nullptr )
+		{
+			void* next = *reinterpret_cast<void**>( pool.heads[k] );
+			if ( deallocateBlocks )
+				deallocate( pool.heads[k] );
+			pool.heads[k] = next;
+			secondCBBytesPooled.fetch_sub( sz, std::memory_order_relaxed );
+		}
+		pool.counts[k] = 0;
+	}
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+	pool.owner = nullptr;
+#endif
+}
+
+void releaseSecondCBPool()
+{
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, thg_secondCBPool.owner == nullptr || thg_secondCBPool.owner == g_CurrentAllocManager );
+#endif
+	emptySecondCBPool( true );
+}
+
+namespace {
+struct SecondCBPoolReleaser
+{
+	~SecondCBPoolReleaser()
+	{
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		bool allocatorIsCurrent = thg_secondCBPool.owner == g_CurrentAllocManager;
+#elif defined NODECPP_USE_IIBMALLOC
+		bool allocatorIsCurrent = g_CurrentAllocManager != nullptr;
+#else
+		bool allocatorIsCurrent = true;
+#endif
+		emptySecondCBPool( allocatorIsCurrent );
+		thg_secondCBPool.releaseAtThreadExit = false;
+	}
+};
+} // anonymous namespace
+
+void armSecondCBPoolRelease()
+{
+	thread_local SecondCBPoolReleaser releaser; // constructed once per thread, destructed at its exit
+	(void)releaser;
+	thg_secondCBPool.releaseAtThreadExit = true;
+}
+
+#if defined NODECPP_USE_IIBMALLOC && defined NODECPP_MEMORY_SAFETY_ON_DEMAND
+thread_local AllocatorRegistry thg_allocatorRegistry; // zero-initialized
+
+void registerAllocator( nodecpp::iibmalloc::ThreadLocalAllocatorT* allocator, bool isArena )
+{
+	AllocatorRegistry& reg = thg_allocatorRegistry;
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, reg.count < AllocatorRegistry::maxCount, "too many allocators registered" );
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, findRegisteredAllocator( allocator->allocatorID() ) == nullptr );
+	reg.entries[reg.count] = { allocator, allocator->allocatorID(), isArena, 0 };
+	++(reg.count);
+}
+
+void unregisterAllocator( nodecpp::iibmalloc::ThreadLocalAllocatorT* allocator )
+{
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	// owners of the allocator can't be released by allocatorID once it's unregistered
+	releaseDeferredOwners();
+#endif
+	AllocatorRegistry& reg = thg_allocatorRegistry;
+	for ( size_t i=0; i<reg.count; ++i )
+		if ( reg.entries[i].allocator == allocator )
+		{
+			reg.entries[i] = reg.entries[reg.count - 1];
+			--(reg.count);
+			return;
+		}
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, false, "allocator is not registered" );
+}
+
+RegisteredAllocator* findRegisteredAllocator( uint16_t allocatorID )
+{
+	AllocatorRegistry& reg = thg_allocatorRegistry;
+	for ( size_t i=0; i<reg.count; ++i )
+		if ( reg.entries[i].allocatorID == allocatorID )
+			return reg.entries + i;
+	return nullptr;
+}
+
+void countRegisteredAllocation()
+{
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr );
+	RegisteredAllocator* entry = findRegisteredAllocator( g_CurrentAllocManager->allocatorID() );
+	if ( entry != nullptr && entry->isArena )
+		++(entry->liveBlocks);
+}
+
+void countRegisteredDeallocation( uint16_t allocatorID )
+{
+	RegisteredAllocator* entry = findRegisteredAllocator( allocatorID );
+	if ( entry != nullptr && entry->isArena )
+	{
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, entry->liveBlocks != 0 );
+		--(entry->liveBlocks);
+	}
+}
+
+void deallocateByID( void* ptr, uint16_t allocatorID )
+{
+	RegisteredAllocator* entry = findRegisteredAllocator( allocatorID );
+	if ( entry != nullptr )
+	{
+		entry->allocator->deallocate( ptr );
+		return;
+	}
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr );
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager->allocatorID() == allocatorID, "{} vs. {}", g_CurrentAllocManager->allocatorID(), allocatorID );
+	g_CurrentAllocManager->deallocate( ptr );
+}
+
+void zombieDeallocateByID( void* ptr, uint16_t allocatorID )
+{
+	RegisteredAllocator* entry = findRegisteredAllocator( allocatorID );
+	if ( entry != nullptr )
+	{
+		if ( entry->isArena )
+		{
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, entry->liveBlocks != 0 );
+			--(entry->liveBlocks);
+		}
+		entry->allocator->zombieableDeallocate( ptr );
+		return;
+	}
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr );
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager->allocatorID() == allocatorID, "{} vs. {}", g_CurrentAllocManager->allocatorID(), allocatorID );
+	g_CurrentAllocManager->zombieableDeallocate( ptr );
+}
+#endif // NODECPP_USE_IIBMALLOC && NODECPP_MEMORY_SAFETY_ON_DEMAND
+
+static std::atomic<size_t> sharedSlotCounter{0};
+
+size_t SharedControlBlock::currentThreadSlot()
+{
+	// assigned once per thread; consecutive threads get different slots
+	thread_local size_t slot = sharedSlotCounter.fetch_add( 1, std::memory_order_relaxed ) % slotCount;
+	return slot;
+}
+
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+thread_local std::vector<DeferredOwnerRecord> thg_deferredOwners;
+
+bool growDeferredOwners() noexcept
+{
+	std::vector<DeferredOwnerRecord>& owners = thg_deferredOwners;
+	try { owners.reserve( owners.capacity() < 64 ? 64 : owners.capacity() * 2 ); }
+	catch (...) { return false; }
+	return true;
+}
+
+void releaseDeferredOwners()
+{
+	std::vector<DeferredOwnerRecord>& owners = thg_deferredOwners;
+	size_t kept = 0;
+	for ( size_t i=0; i<owners.size(); ++i )
+	{
+		DeferredOwnerRecord rec = owners[i];
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		// only owners allocated by current or a registered allocator can be released now
+		if ( ( g_CurrentAllocManager == nullptr || g_CurrentAllocManager->allocatorID() != rec.allocatorID ) && findRegisteredAllocator( rec.allocatorID ) == nullptr )
+		{
+			owners[kept++] = rec;
+			continue;
+		}
+#endif
+		FirstControlBlock* cb = getControlBlock_( rec.obj );
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, cb->isZombie() );
+		cb->updatePtrForListItemsWithInvalidPtr();
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		zombieDeallocate( getAllocatedBlock_( rec.obj ), rec.allocatorID );
+#else
+		zombieDeallocate( getAllocatedBlock_( rec.obj ) );
+#endif
+		cb->clear();
+	}
+	owners.resize( kept );
+}
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+
 #if defined NODECPP_USE_NEW_DELETE_ALLOC
-thread_local void** zombieList_ = nullptr;
+thread_local ZombieQuarantine zombieQuarantine_;
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-thread_local std::map<uint8_t*, size_t, std::greater<uint8_t*>> zombieMap;
+thread_local ZombieBitmap zombieBitmap;
 thread_local bool doZombieEarlyDetection_ = true;
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 #endif // NODECPP_USE_NEW_DELETE_ALLOC
@@ -32,6 +32,7 @@
 
 #include "safe_ptr_no_checks.h"
 #include "safe_ptr_impl.h"
+#include "safe_ptr_shared.h"
 
 namespace safememory::detail {
 
@@ -52,6 +53,18 @@ template<class T, memory_safety is_safe> struct nullable_ptr_type_ { typedef nul
 template<class T> struct nullable_ptr_type_<T, memory_safety::none> { typedef nullable_ptr_no_checks<T> type; };
 template<class T> struct nullable_ptr_type_<T, memory_safety::safe> { typedef nullable_ptr_impl<T> type; };
 
+template<class T, memory_safety is_safe> struct borrowed_ptr_type_ { typedef borrowed_ptr_impl<T> type; };
+template<class T> struct borrowed_ptr_type_<T, memory_safety::none> { typedef borrowed_ptr_no_checks<T> type; };
+template<class T> struct borrowed_ptr_type_<T, memory_safety::safe> { typedef borrowed_ptr_impl<T> type; };
+
+template<class T, memory_safety is_safe> struct shared_owning_ptr_type_ { typedef shared_owning_ptr_impl<T> type; };
+template<class T> struct shared_owning_ptr_type_<T, memory_safety::none> { typedef owning_ptr_no_checks<T> type; };
+template<class T> struct shared_owning_ptr_type_<T, memory_safety::safe> { typedef shared_owning_ptr_impl<T> type; };
+
+template<class T, memory_safety is_safe> struct shared_soft_ptr_type_ { typedef shared_soft_ptr_impl<T> type; };
+template<class T> struct shared_soft_ptr_type_<T, memory_safety::none> { typedef soft_ptr_no_checks<T> type; };
+template<class T> struct shared_soft_ptr_type_<T, memory_safety::safe> { typedef shared_soft_ptr_impl<T> type; };
+
 } // namespace safememory::detail
 
 namespace safememory {
@@ -67,6 +80,14 @@ using soft_this_ptr2 = std::conditional_t<is_safe == memory_safety::safe, detail
 
 template<class T, memory_safety is_safe = safeness_declarator<T>::is_safe> using nullable_ptr = typename detail::nullable_ptr_type_<T, is_safe>::type;
 
+// unregistered soft reference that must not escape its scope (enforced by the checker)
+template<class T, memory_safety is_safe = safeness_declarator<T>::is_safe> using borrowed_ptr = typename detail::borrowed_ptr_type_<T, is_safe>::type;
+
+// owner and soft pointers to an object shared between threads (see safe_ptr_shared.h)
+template<class T, memory_safety is_safe = safeness_declarator<T>::is_safe> using shared_owning_ptr = typename detail::shared_owning_ptr_type_<T, is_safe>::type;
+
+template<class T, memory_safety is_safe = safeness_declarator<T>::is_safe> using shared_soft_ptr = typename detail::shared_soft_ptr_type_<T, is_safe>::type;
+
 
 
 template<class _Ty,
@@ -101,6 +122,21 @@ NODISCARD auto make_owning_2(_Types&&... _Args) -> owning_ptr<_Ty, is_safe>
 	}
 }
 
+template<class _Ty, memory_safety is_safe = safeness_declarator<_Ty>::is_safe,
+	class... _Types,
+	std::enable_if_t<!std::is_array<_Ty>::value, int> = 0>
+NODISCARD auto make_shared_owning(_Types&&... _Args) -> shared_owning_ptr<_Ty, is_safe>
+{
+	if constexpr ( is_safe == memory_safety::safe )
+	{
+		return detail::make_shared_owning_impl<_Ty, _Types ...>( ::std::forward<_Types>(_Args)... );
+	}
+	else
+	{
+		return detail::make_owning_no_checks<_Ty, _Types ...>( ::std::forward<_Types>(_Args)... );
+	}
+}
+
 template<class T>
 soft_ptr<T> soft_ptr_in_constructor(T* ptr) {
 	if constexpr ( safeness_declarator<T>::is_safe == memory_safety::safe )
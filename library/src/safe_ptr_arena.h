@@ -0,0 +1,122 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_PTR_ARENA_H
+#define SAFE_PTR_ARENA_H
+
+#include "safe_ptr.h"
+
+#if defined NODECPP_USE_IIBMALLOC && defined NODECPP_MEMORY_SAFETY_ON_DEMAND
+
+namespace safememory {
+
+// An arena is a separate allocator (with its own allocatorID) for a subgraph of objects, e.g. those of a single request.
+// Objects are created in an arena either by make_owning_in(), or by anything (make_owning(), vector, basic_string,
+// unordered_map, ...) called while an arena_scope for it is active. Memory of an arena is released by its allocator with
+// arena itself; release() (called by dtor as well) kills all zombies of the arena at once, leaving zombies of other
+// allocators intact.
+// owning_ptrs (and their control blocks) as well as container buffers (that keep allocatorID of their allocation, see
+// allocator_to_eastl.h) are returned to the allocator they come from by allocatorID, whatever allocator is current at
+// that moment. That is, a container created within an arena_scope may be grown or destroyed outside of it, but, as
+// objects of the arena, its buffers must all be gone before the arena is destroyed (asserted).
+class arena
+{
+	friend class arena_scope;
+	nodecpp::iibmalloc::ThreadLocalAllocatorT allocator;
+
+public:
+	arena() { detail::registerAllocator( &allocator, true ); }
+	arena( const arena& ) = delete;
+	arena& operator = ( const arena& ) = delete;
+	arena( arena&& ) = delete;
+	arena& operator = ( arena&& ) = delete;
+
+	uint16_t allocatorID() { return allocator.allocatorID(); }
+	bool isCurrent() const { return detail::g_CurrentAllocManager == &allocator; }
+	// owning_ptrs to objects and container buffers of the arena that are not yet destroyed (including those pending in deferred destruction mode)
+	size_t liveObjectCount() { return detail::findRegisteredAllocator( allocatorID() )->liveBlocks; }
+
+	void release()
+	{
+		auto former = nodecpp::iibmalloc::setCurrneAllocator( &allocator );
+		if ( detail::thg_secondCBPool.owner == &allocator )
+			detail::releaseSecondCBPool();
+		detail::killAllZombies();
+		nodecpp::iibmalloc::setCurrneAllocator( former );
+	}
+
+	~arena()
+	{
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, !isCurrent() );
+		release();
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, liveObjectCount() == 0, "arena is destroyed with {} objects alive", liveObjectCount() );
+		detail::unregisterAllocator( &allocator );
+	}
+};
+
+// makes a given arena current allocator for lifetime of the scope; scopes may nest
+// blocks of the former allocator may still be released within the scope, as it is registered for lifetime of the scope
+class arena_scope
+{
+	nodecpp::iibmalloc::ThreadLocalAllocatorT* former;
+	bool formerRegistered = false;
+
+public:
+	explicit arena_scope( arena& a ) : former( nodecpp::iibmalloc::setCurrneAllocator( &(a.allocator) ) )
+	{
+		if ( former != nullptr && detail::findRegisteredAllocator( former->allocatorID() ) == nullptr )
+		{
+			detail::registerAllocator( former, false );
+			formerRegistered = true;
+		}
+	}
+	arena_scope( const arena_scope& ) = delete;
+	arena_scope& operator = ( const arena_scope& ) = delete;
+	~arena_scope()
+	{
+		if ( formerRegistered )
+			detail::unregisterAllocator( former );
+		nodecpp::iibmalloc::setCurrneAllocator( former );
+	}
+};
+
+// the object may then be destroyed with any allocator current
+template<class _Ty, memory_safety is_safe = safeness_declarator<_Ty>::is_safe,
+	class... _Types,
+	std::enable_if_t<!std::is_array<_Ty>::value, int> = 0>
+NODISCARD auto make_owning_in(arena& a, _Types&&... _Args) -> owning_ptr<_Ty, is_safe>
+{
+	arena_scope scope( a );
+	return make_owning_2<_Ty, is_safe, _Types ...>( ::std::forward<_Types>(_Args)... );
+}
+
+} // namespace safememory
+
+#endif // NODECPP_USE_IIBMALLOC && NODECPP_MEMORY_SAFETY_ON_DEMAND
+
+#endif // SAFE_PTR_ARENA_H
@@ -32,7 +32,12 @@
 #include <nodecpp_assert.h>
 #include <log.h>
 #include <memory>
+#include <cstdlib> // for std::malloc, std::free
+#include <cstddef>
 #include <stdint.h>
+#if defined NODECPP_MSVC
+#include <intrin.h> // for _BitScanForward, _mm_prefetch
+#endif
 #include <safememory/detail/checker_attributes.h>
 #include <allocator_template.h>
 #include "memory_safety.h"
@@ -55,6 +60,19 @@
 
 namespace safememory::detail {
 enum class StdAllocEnforcer { enforce };
+
+// Alignments above what an allocator guarantees are provided by over-allocation: a block of sz + alignment bytes
+// (itself at least pointer-aligned) is allocated, and a pointer to it is kept right before the aligned one
+NODECPP_FORCEINLINE void* alignWithinBlock( void* block, size_t alignment ) {
+	uintptr_t ret = ( reinterpret_cast<uintptr_t>( block ) + sizeof(void*) + alignment - 1 ) & ~( (uintptr_t)alignment - 1 );
+	reinterpret_cast<void**>( ret )[-1] = block;
+	return reinterpret_cast<void*>( ret );
+}
+NODECPP_FORCEINLINE void* blockOfAligned( void* ptr ) { return reinterpret_cast<void**>( ptr )[-1]; }
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+// owners destroyed in deferred mode are finally released (and their soft_ptrs invalidated) at killAllZombies()
+void releaseDeferredOwners();
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
 } // namespace safememory::detail
 
 
@@ -70,12 +88,24 @@ using nodecpp::iibmalloc::ALIGNMENT;
 
 #ifndef NODECPP_MEMORY_SAFETY_ON_DEMAND
 
-NODECPP_FORCEINLINE void* allocate( size_t sz, size_t alignment ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); return g_CurrentAllocManager->allocate( sz ); } // TODO: proper implementation for alignment
 NODECPP_FORCEINLINE void* allocate( size_t sz ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); return g_CurrentAllocManager->allocate( sz ); }
+NODECPP_FORCEINLINE void* allocate( size_t sz, size_t alignment ) { 
+	if ( alignment <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT )
+		return allocate( sz );
+	return alignWithinBlock( allocate( sz + alignment ), alignment );
+}
 template<size_t alignment>
-NODECPP_FORCEINLINE void* allocateAligned( size_t sz ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); return g_CurrentAllocManager->allocateAligned<alignment>( sz ); }
+NODECPP_FORCEINLINE void* allocateAligned( size_t sz ) { 
+	if constexpr ( alignment > NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT )
+		return allocate( sz, alignment );
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
+	return g_CurrentAllocManager->allocateAligned<alignment>( sz );
+}
 NODECPP_FORCEINLINE void deallocate( void* ptr ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); g_CurrentAllocManager->deallocate( ptr ); }
-NODECPP_FORCEINLINE void deallocate( void* ptr, size_t alignment ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); g_CurrentAllocManager->deallocate( ptr ); }
+NODECPP_FORCEINLINE void deallocate( void* ptr, size_t alignment ) { 
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
+	g_CurrentAllocManager->deallocate( alignment <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT ? ptr : blockOfAligned( ptr ) );
+}
 NODECPP_FORCEINLINE void* zombieAllocate( size_t sz ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); return g_CurrentAllocManager->zombieableAllocate( sz ); }
 template<size_t sz, size_t alignment>
 NODECPP_FORCEINLINE void* zombieAllocateAligned() { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); return g_CurrentAllocManager->zombieableAllocateAligned<sz, alignment>(); }
@@ -90,29 +120,81 @@ inline bool doZombieEarlyDetection( bool doIt = true ) { NODECPP_ASSERT(safememo
 constexpr bool isPointerNotZombie(void* ptr ) { return true; }
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 NODECPP_FORCEINLINE constexpr size_t getPrefixByteCount() { static_assert(guaranteed_prefix_size <= 3*sizeof(void*)); return guaranteed_prefix_size; }
-inline void killAllZombies() { g_CurrentAllocManager->killAllZombies(); }
+inline void killAllZombies()
+{
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	releaseDeferredOwners();
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	g_CurrentAllocManager->killAllZombies();
+}
 
 #else // NODECPP_MEMORY_SAFETY_ON_DEMAND
 
-NODECPP_FORCEINLINE void* allocate( size_t sz, size_t alignment )  // TODO: proper implementation for alignment
+// Blocks with allocatorID 0 come from the std heap backend. It is called directly (rather than via operator new/delete,
+// which are routed to the current allocator, if any), so that such blocks are freed without swapping g_CurrentAllocManager
+NODECPP_FORCEINLINE void* stdHeapAllocate( size_t sz )
+{
+	void* ret = std::malloc( sz );
+	if ( NODECPP_UNLIKELY( ret == nullptr ) )
+		throw std::bad_alloc();
+	return ret;
+}
+NODECPP_FORCEINLINE void* stdHeapAllocate( size_t sz, size_t alignment )
+{
+	if ( alignment <= alignof(std::max_align_t) )
+		return stdHeapAllocate( sz );
+	return alignWithinBlock( stdHeapAllocate( sz + alignment ), alignment );
+}
+NODECPP_FORCEINLINE void stdHeapDeallocate( void* ptr ) { std::free( ptr ); }
+NODECPP_FORCEINLINE void stdHeapDeallocate( void* ptr, size_t alignment ) { std::free( alignment <= alignof(std::max_align_t) ? ptr : blockOfAligned( ptr ) ); }
+
+// Allocators other than the current one that blocks may still be returned to, found by allocatorID (see safememory::arena).
+// Their number is expected to be small, so entries are searched linearly; with none registered, a block with a non-zero
+// allocatorID must come from the current allocator (as asserted below). Zombieable blocks and container buffers of each
+// registered arena are counted, so that it is known whether objects it holds are still alive.
+struct RegisteredAllocator
+{
+	nodecpp::iibmalloc::ThreadLocalAllocatorT* allocator;
+	uint16_t allocatorID;
+	bool isArena; // otherwise, it is an allocator that was current when an arena_scope was entered
+	size_t liveBlocks;
+};
+struct AllocatorRegistry
+{
+	static constexpr size_t maxCount = 32;
+	RegisteredAllocator entries[maxCount];
+	size_t count;
+};
+static_assert( std::is_trivial<AllocatorRegistry>::value ); // zero-initialized thread_local, no dynamic init
+extern thread_local AllocatorRegistry thg_allocatorRegistry;
+
+void registerAllocator( nodecpp::iibmalloc::ThreadLocalAllocatorT* allocator, bool isArena );
+void unregisterAllocator( nodecpp::iibmalloc::ThreadLocalAllocatorT* allocator );
+RegisteredAllocator* findRegisteredAllocator( uint16_t allocatorID ); // nullptr if not registered
+NODECPP_NOINLINE void countRegisteredAllocation();
+NODECPP_NOINLINE void countRegisteredDeallocation( uint16_t allocatorID ); // for blocks not freed by zombieDeallocateByID()
+NODECPP_NOINLINE void deallocateByID( void* ptr, uint16_t allocatorID );
+NODECPP_NOINLINE void zombieDeallocateByID( void* ptr, uint16_t allocatorID );
+
+NODECPP_FORCEINLINE bool isCurrentAllocatorOnlyOne( uint16_t allocatorID )
+{
+	return thg_allocatorRegistry.count == 0 && g_CurrentAllocManager != nullptr && g_CurrentAllocManager->allocatorID() == allocatorID;
+}
+
+NODECPP_FORCEINLINE void* allocate( size_t sz, size_t alignment )
 { 
 	if ( g_CurrentAllocManager == nullptr )
-	{
-		void* ret = ::operator new [] (sz, std::align_val_t(alignment)); 
-		return ret;
-	}
+		return stdHeapAllocate( sz, alignment );
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	return g_CurrentAllocManager->allocate( sz );
-
+	if ( alignment <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT )
+		return g_CurrentAllocManager->allocate( sz );
+	return alignWithinBlock( g_CurrentAllocManager->allocate( sz + alignment ), alignment );
 }
 
 NODECPP_FORCEINLINE void* allocate( size_t sz )
 {
 	if ( g_CurrentAllocManager == nullptr )
-	{
-		void* ret = ::operator new [] (sz); 
-		return ret;
-	}
+		return stdHeapAllocate( sz );
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
 	return g_CurrentAllocManager->allocate( sz );
 }
@@ -120,7 +202,7 @@ NODECPP_FORCEINLINE void* allocate( size_t sz )
 template<size_t alignment>
 NODECPP_FORCEINLINE void* allocateAligned( size_t sz )
 {
-	if ( g_CurrentAllocManager == nullptr )
+	if ( g_CurrentAllocManager == nullptr || alignment > NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT )
 		return allocate( sz, alignment );
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
 	return g_CurrentAllocManager->allocateAligned<alignment>( sz );
@@ -130,23 +212,20 @@ NODECPP_FORCEINLINE void deallocate( void* ptr, uint16_t allocatorID )
 {
 	if ( allocatorID == 0 )
 	{
-		auto* formerAlloc = ::nodecpp::iibmalloc::setCurrneAllocator( nullptr );
-		::operator delete [] (ptr);
-		::nodecpp::iibmalloc::setCurrneAllocator( formerAlloc );
+		stdHeapDeallocate( ptr );
 		return;
 	}
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager->allocatorID() == allocatorID, "{} vs. {}", g_CurrentAllocManager->allocatorID(), allocatorID ); 
-	g_CurrentAllocManager->deallocate( ptr );
+	if ( NODECPP_LIKELY( isCurrentAllocatorOnlyOne( allocatorID ) ) )
+		g_CurrentAllocManager->deallocate( ptr );
+	else
+		deallocateByID( ptr, allocatorID );
 }
 
 NODECPP_FORCEINLINE void deallocate( void* ptr, bool isStdHeap )
 {
 	if ( isStdHeap )
 	{
-		auto* formerAlloc = ::nodecpp::iibmalloc::setCurrneAllocator( nullptr );
-		::operator delete [] (ptr);
-		::nodecpp::iibmalloc::setCurrneAllocator( formerAlloc );
+		stdHeapDeallocate( ptr );
 		return;
 	}
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
@@ -157,14 +236,14 @@ NODECPP_FORCEINLINE void deallocate( void* ptr, size_t alignment, uint16_t alloc
 {
 	if ( allocatorID == 0 )
 	{
-		auto* formerAlloc = ::nodecpp::iibmalloc::setCurrneAllocator( nullptr );
-		::operator delete [] (ptr, std::align_val_t(alignment));
-		::nodecpp::iibmalloc::setCurrneAllocator( formerAlloc );
+		stdHeapDeallocate( ptr, alignment );
 		return;
 	}
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager->allocatorID() == allocatorID, "{} vs. {}", g_CurrentAllocManager->allocatorID(), allocatorID ); 
-	g_CurrentAllocManager->deallocate( ptr );
+	void* block = alignment <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT ? ptr : blockOfAligned( ptr );
+	if ( NODECPP_LIKELY( isCurrentAllocatorOnlyOne( allocatorID ) ) )
+		g_CurrentAllocManager->deallocate( block );
+	else
+		deallocateByID( block, allocatorID );
 }
 
 NODECPP_FORCEINLINE void deallocate( void* ptr )
@@ -176,7 +255,7 @@ NODECPP_FORCEINLINE void deallocate( void* ptr )
 NODECPP_FORCEINLINE void deallocate( void* ptr, size_t alignment )
 {
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	g_CurrentAllocManager->deallocate( ptr );
+	g_CurrentAllocManager->deallocate( alignment <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT ? ptr : blockOfAligned( ptr ) );
 }
 
 NODECPP_FORCEINLINE void* zombieAllocate( size_t sz )
@@ -184,39 +263,50 @@ NODECPP_FORCEINLINE void* zombieAllocate( size_t sz )
 	if ( g_CurrentAllocManager == nullptr )
 		return allocate( sz );
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	return g_CurrentAllocManager->zombieableAllocate( sz );
+	void* ret = g_CurrentAllocManager->zombieableAllocate( sz );
+	if ( NODECPP_UNLIKELY( thg_allocatorRegistry.count != 0 ) )
+		countRegisteredAllocation();
+	return ret;
 }
 
 template<size_t sz, size_t alignment>
 NODECPP_FORCEINLINE void* zombieAllocateAligned()
 {
+	// zombieDeallocate() has no alignment to undo over-allocation by stdHeapAllocate()
+	static_assert( alignment <= alignof(std::max_align_t) );
 	if ( g_CurrentAllocManager == nullptr )
 		return allocate( sz, alignment );
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	return g_CurrentAllocManager->zombieableAllocateAligned<sz, alignment>();
+	void* ret = g_CurrentAllocManager->zombieableAllocateAligned<sz, alignment>();
+	if ( NODECPP_UNLIKELY( thg_allocatorRegistry.count != 0 ) )
+		countRegisteredAllocation();
+	return ret;
 }
 
 template<size_t alignment>
 NODECPP_FORCEINLINE void* zombieAllocateAligned(size_t sz)
 {
+	static_assert( alignment <= alignof(std::max_align_t) ); // see above
 	if ( g_CurrentAllocManager == nullptr )
 		return allocate( sz, alignment );
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	return g_CurrentAllocManager->zombieableAllocateAligned<alignment>(sz);
+	void* ret = g_CurrentAllocManager->zombieableAllocateAligned<alignment>(sz);
+	if ( NODECPP_UNLIKELY( thg_allocatorRegistry.count != 0 ) )
+		countRegisteredAllocation();
+	return ret;
 }
 
 NODECPP_FORCEINLINE void zombieDeallocate( void* ptr, uint16_t allocatorID )
 {
 	if ( allocatorID == 0 )
 	{
-		auto* formerAlloc = ::nodecpp::iibmalloc::setCurrneAllocator( nullptr );
-		::operator delete [] (ptr);
-		::nodecpp::iibmalloc::setCurrneAllocator( formerAlloc );
+		stdHeapDeallocate( ptr ); // see zombieAllocateAligned() for alignment
 		return;
 	}
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager->allocatorID() == allocatorID, "{} vs. {}", g_CurrentAllocManager->allocatorID(), allocatorID ); 
-	g_CurrentAllocManager->zombieableDeallocate( ptr );
+	if ( NODECPP_LIKELY( isCurrentAllocatorOnlyOne( allocatorID ) ) )
+		g_CurrentAllocManager->zombieableDeallocate( ptr );
+	else
+		zombieDeallocateByID( ptr, allocatorID );
 }
 
 NODECPP_FORCEINLINE void zombieDeallocate( void* ptr )
@@ -263,6 +353,9 @@ inline void killAllZombies()
 {
 	if ( g_CurrentAllocManager == nullptr )
 		return;
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	releaseDeferredOwners();
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
 	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); 
 	g_CurrentAllocManager->killAllZombies();
 }
@@ -279,11 +372,7 @@ struct IIBRawAllocator
 	static NODECPP_FORCEINLINE void* allocate( size_t allocSize ) { return ::safememory::detail::allocateAligned<alignment>( allocSize ); }
 //	static NODECPP_FORCEINLINE void* allocate( size_t allocSize, size_t allignment ) { return ::safememory::detail::allocate( allocSize ); }
 	template<size_t alignment = 0> 
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-	static NODECPP_FORCEINLINE void deallocate( void* ptr ) { NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr ); g_CurrentAllocManager->deallocate( ptr ); } // TODO: revise!
-#else
-	static NODECPP_FORCEINLINE void deallocate( void* ptr ) { return ::safememory::detail::deallocate( ptr ); }
-#endif// NODECPP_MEMORY_SAFETY_ON_DEMAND
+	static NODECPP_FORCEINLINE void deallocate( void* ptr ) { return ::safememory::detail::deallocate( ptr, alignment ); }
 };
 
 template<class _Ty>
@@ -298,7 +387,7 @@ bool operator!=( const iiballocator<T1>& lhs, const iiballocator<T2>& rhs ) noex
 #elif defined NODECPP_USE_NEW_DELETE_ALLOC
 
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-#include <map>
+#include "zombie_bitmap.h"
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 namespace safememory::detail
 {
@@ -306,26 +395,94 @@ template<class T>
 using iiballocator =  std::allocator<T>;
 
 // NOTE: while being non-optimal, following calls provide safety guarantees and can be used at least for debug purposes
-extern thread_local void** zombieList_; // must be set to zero at the beginning of a thread function
+
+// Zombie blocks are kept in a FIFO quarantine (linked through the first word of the block header; the second one keeps block size).
+// killAllZombies() releases all of them at once. With a non-zero budget, killZombiesStep() called at the same points
+// (e.g. between event loop iterations) releases oldest zombies until bytes held fit into the budget, at most maxBlocks per call,
+// so that both memory held and the pause are bounded. Releasing a zombie at any other point is not safe.
+struct ZombieQuarantine
+{
+	void** head; // oldest
+	void** tail; // newest
+	size_t bytesHeld;
+	size_t blocksHeld;
+	size_t budget; // in bytes; 0 means no bound (zombies are released by killAllZombies() only)
+	size_t releasedBytes; // totals for the thread
+	size_t releasedBlocks;
+};
+static_assert( std::is_trivial<ZombieQuarantine>::value ); // zero-initialized thread_local, no dynamic init
+extern thread_local ZombieQuarantine zombieQuarantine_;
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-extern thread_local std::map<uint8_t*, size_t, std::greater<uint8_t*>> zombieMap;
+extern thread_local ZombieBitmap zombieBitmap;
 extern thread_local bool doZombieEarlyDetection_;
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 
+// release rate is to be obtained by sampling released totals over time
+struct ZombieQuarantineMetrics
+{
+	size_t bytesHeld;
+	size_t blocksHeld;
+	size_t releasedBytes;
+	size_t releasedBlocks;
+};
+inline ZombieQuarantineMetrics getZombieQuarantineMetrics()
+{
+	return { zombieQuarantine_.bytesHeld, zombieQuarantine_.blocksHeld, zombieQuarantine_.releasedBytes, zombieQuarantine_.releasedBlocks };
+}
+inline size_t setZombieQuarantineBudget( size_t bytes )
+{
+	size_t ret = zombieQuarantine_.budget;
+	zombieQuarantine_.budget = bytes;
+	return ret;
+}
+
+inline void releaseOldestZombie( bool updateBitmap )
+{
+	ZombieQuarantine& q = zombieQuarantine_;
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, q.head != nullptr );
+	void** block = q.head;
+	q.head = reinterpret_cast<void**>( *block );
+	if ( q.head == nullptr )
+		q.tail = nullptr;
+	size_t blockSize = reinterpret_cast<uint64_t*>( block )[1];
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+	if ( updateBitmap )
+		zombieBitmap.unmark( block, blockSize );
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+	q.bytesHeld -= blockSize;
+	--q.blocksHeld;
+	q.releasedBytes += blockSize;
+	++q.releasedBlocks;
+	delete [] reinterpret_cast<uint8_t*>( block );
+}
+
 inline void killAllZombies()
 {
-	while ( zombieList_ != nullptr )
-	{
-		void** next = reinterpret_cast<void**>( *zombieList_ );
-		delete [] zombieList_;
-		zombieList_ = next;
-	}
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	releaseDeferredOwners();
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	while ( zombieQuarantine_.head != nullptr )
+		releaseOldestZombie( false );
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, doZombieEarlyDetection_ || ( !doZombieEarlyDetection_ && zombieMap.empty() ) );
-	zombieMap.clear();
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, doZombieEarlyDetection_ || ( !doZombieEarlyDetection_ && zombieBitmap.empty() ) );
+	zombieBitmap.clear();
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 }
-NODECPP_FORCEINLINE void* allocate( size_t sz, size_t alignment ) { void* ret = ::operator new [] (sz, std::align_val_t(alignment)); return ret; } // TODO: proper implementation for alignment
+
+// returns true if zombies over the budget remain (and another step is due)
+inline bool killZombiesStep( size_t maxBlocks = 64 )
+{
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	releaseDeferredOwners();
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	ZombieQuarantine& q = zombieQuarantine_;
+	if ( q.budget == 0 )
+		return false;
+	for ( ; maxBlocks != 0 && q.bytesHeld > q.budget; --maxBlocks )
+		releaseOldestZombie( true );
+	return q.bytesHeld > q.budget;
+}
+NODECPP_FORCEINLINE void* allocate( size_t sz, size_t alignment ) { void* ret = ::operator new [] (sz, std::align_val_t(alignment)); return ret; }
 NODECPP_FORCEINLINE void* allocate( size_t sz ) { void* ret = ::operator new [] (sz); return ret; }
 template<size_t alignment>
 NODECPP_FORCEINLINE void* allocateAligned( size_t sz ) { return allocate( sz, alignment ); }
@@ -350,25 +507,27 @@ NODECPP_FORCEINLINE void* zombieAllocateAligned(size_t sz) {
 }
 NODECPP_FORCEINLINE void zombieDeallocate( void* ptr ) { 
 	void** blockStart = reinterpret_cast<void**>(reinterpret_cast<uint8_t*>(ptr) - 4 * sizeof(uint64_t)); 
+	size_t blockSize = 4 * sizeof(uint64_t) + *reinterpret_cast<uint64_t*>(blockStart);
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-	size_t allocSize = *reinterpret_cast<uint64_t*>(blockStart);
-	zombieMap.insert( std::make_pair( reinterpret_cast<uint8_t*>(blockStart), 4 * sizeof(uint64_t) + allocSize ) );
+	zombieBitmap.mark( blockStart, blockSize );
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-	*blockStart = zombieList_; 
-	zombieList_ = blockStart;
+	ZombieQuarantine& q = zombieQuarantine_;
+	*blockStart = nullptr;
+	reinterpret_cast<uint64_t*>(blockStart)[1] = blockSize;
+	if ( q.tail != nullptr )
+		*q.tail = blockStart;
+	else
+		q.head = blockStart;
+	q.tail = blockStart;
+	q.bytesHeld += blockSize;
+	++q.blocksHeld;
 }
 NODECPP_FORCEINLINE bool isZombieablePointerInBlock(void* allocatedPtr, void* ptr ) { return ptr >= allocatedPtr && reinterpret_cast<uint8_t*>(allocatedPtr) + *(reinterpret_cast<uint64_t*>(allocatedPtr) - 2) > reinterpret_cast<uint8_t*>(ptr); }
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-NODECPP_FORCEINLINE bool isPointerNotZombie(const void* ptr ) { 
-	auto iter = zombieMap.lower_bound( reinterpret_cast<uint8_t*>( const_cast<void*>(ptr) ) );
-	if ( iter != zombieMap.end() )
-		return reinterpret_cast<uint8_t*>( const_cast<void*>(ptr) ) >= iter->first + iter->second;
-	else
-		return true;
-}
+NODECPP_FORCEINLINE bool isPointerNotZombie(const void* ptr ) { return !zombieBitmap.isMarked( ptr ); }
 inline bool doZombieEarlyDetection( bool doIt = true )
 {
-	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, zombieMap.empty(), "to (re)set doZombieEarlyDetection() zombieMap must be empty" );
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, zombieBitmap.empty(), "to (re)set doZombieEarlyDetection() there must be no zombies" );
 	bool ret = doZombieEarlyDetection_;
 	doZombieEarlyDetection_ = doIt;
 	return ret;
@@ -393,6 +552,40 @@ extern void forcePreviousChangesToThisInDtor( void* p );
 #define forcePreviousChangesToThisInDtor(x)
 #endif
 
+// returns index of the lowest set bit; x is expected to be non-zero
+NODECPP_FORCEINLINE size_t countTrailingZeros( uint32_t x )
+{
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, x != 0 );
+#if defined NODECPP_MSVC
+	unsigned long ix;
+	_BitScanForward( &ix, x );
+	return ix;
+#else
+	return __builtin_ctz( x );
+#endif
+}
+
+NODECPP_FORCEINLINE size_t countTrailingZeros( uint64_t x )
+{
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, x != 0 );
+#if defined NODECPP_MSVC
+	unsigned long ix;
+	_BitScanForward64( &ix, x );
+	return ix;
+#else
+	return __builtin_ctzll( x );
+#endif
+}
+
+NODECPP_FORCEINLINE void prefetchForWrite( const void* p )
+{
+#if defined NODECPP_MSVC
+	_mm_prefetch( reinterpret_cast<const char*>(p), _MM_HINT_T0 );
+#else
+	__builtin_prefetch( p, 1 );
+#endif
+}
+
 template<class T>
 void destruct( T* t )
 {
@@ -29,9 +29,14 @@
 #define SAFE_PTR_IMPL_H
 
 #include "safe_ptr_common.h"
+#include "stack_bounds.h"
 #include "memory_safety.h"
 #include "../include/nodecpp_error/nodecpp_error.h"
 #include "safe_memory_error.h"
+#include <atomic>
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+#include <vector>
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
 #ifdef NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
 #include <stack_info.h>
 #endif // NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
@@ -48,6 +53,21 @@ namespace safememory::detail
 	
 extern thread_local void* thg_stackPtrForMakeOwningCall;
 
+// Constructor context of make_owning(): the object under construction, so that its soft_this_ptr members (and
+// soft_ptr_in_constructor()) can find its control block. Contexts of make_owning() calls nested in constructors form
+// a stack whose links are kept by these guards on the regular stack; a previous context is restored on any exit.
+// nullptr stands for an object in common heap (see NODECPP_MEMORY_SAFETY_ON_DEMAND), NODECPP_SECOND_NULLPTR for no context
+class make_owning_context
+{
+	void* prev;
+public:
+	make_owning_context( void* dataForObj ) noexcept : prev( thg_stackPtrForMakeOwningCall ) { thg_stackPtrForMakeOwningCall = dataForObj; }
+	make_owning_context( const make_owning_context& ) = delete;
+	make_owning_context& operator = ( const make_owning_context& ) = delete;
+	~make_owning_context() { thg_stackPtrForMakeOwningCall = prev; }
+	static void* current() noexcept { return thg_stackPtrForMakeOwningCall; }
+};
+
 template<class T>
 void checkNotNullLargeSize( T* ptr )
 {
@@ -179,9 +199,63 @@ template<class T> class soft_ptr_base_impl; // forward declaration
 template<class T> class soft_ptr_impl; // forward declaration
 template<class T> class nullable_ptr_base_impl; // forward declaration
 template<class T> class nullable_ptr_impl; // forward declaration
+template<class T> class borrowed_ptr_impl; // forward declaration
 template<class T> class soft_this_ptr_impl; // forward declaration
 class soft_this_ptr2_impl; // forward declaration
 
+// Process-wide amount of memory held by SecondCBHeader blocks (soft_ptr slots that did not fit into FirstControlBlock)
+// Embedded blocks (see soft_ptr_slots_declarator) are a part of object's allocation and are not counted here
+extern std::atomic<size_t> secondCBBytesInUse; // held by living control blocks
+extern std::atomic<size_t> secondCBBytesPooled; // cached by SecondCBPool's of all threads
+inline size_t getSecondCBBytesInUse() { return secondCBBytesInUse.load( std::memory_order_relaxed ); }
+inline size_t getSecondCBBytesPooled() { return secondCBBytesPooled.load( std::memory_order_relaxed ); }
+
+// Per-thread cache of released SecondCBHeader blocks, one free list per size class
+// (size classes are the ones produced by SecondCBHeader::reallocate(): 8, 18, 38, ... slots)
+struct SecondCBPool
+{
+	static constexpr size_t sizeClassCount = 6;
+	static constexpr size_t maxBlocksPerClass = 16;
+	void* heads[sizeClassCount]; // blocks are linked via their first word
+	uint8_t counts[sizeClassCount];
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+	void* owner; // allocator that all pooled blocks come from; nullptr if pool is empty
+#endif
+	bool releaseAtThreadExit; // see armSecondCBPoolRelease()
+};
+static_assert( std::is_trivial<SecondCBPool>::value ); // zero-initialized thread_local, no dynamic init
+extern thread_local SecondCBPool thg_secondCBPool;
+
+// returns all blocks cached by this thread's pool back to allocator
+// (to be called, for instance, before a thread or its allocator is gone)
+void releaseSecondCBPool();
+// called once per thread when the pool takes its first block; then the pool is released at thread exit, if the allocator
+// of its blocks is still current (otherwise, that allocator may already be gone along with its memory, and blocks are dropped)
+NODECPP_NOINLINE void armSecondCBPoolRelease();
+
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+// Deferred owner destruction mode: destroying an owning_ptr runs the destructor and marks its control block as zombie,
+// but neither walks soft_ptrs pointing to it nor releases memory; soft_ptrs detect the zombie on dereference.
+// Actual invalidation and memory release happen at killAllZombies() (see releaseDeferredOwners()).
+// NOTE: until then the object is not reported by isPointerNotZombie() either
+struct DeferredOwnerRecord
+{
+	void* obj;
+	uint16_t allocatorID; // 0 if NODECPP_MEMORY_SAFETY_ON_DEMAND is not defined
+};
+extern thread_local std::vector<DeferredOwnerRecord> thg_deferredOwners;
+NODECPP_NOINLINE bool growDeferredOwners() noexcept; // false if there is no memory to grow
+// called from owner destructors, that is, must not throw; returns false if the owner can't be recorded
+inline bool deferOwnerRelease( void* obj, uint16_t allocatorID ) noexcept
+{
+	std::vector<DeferredOwnerRecord>& owners = thg_deferredOwners;
+	if ( NODECPP_UNLIKELY( owners.size() == owners.capacity() ) && !growDeferredOwners() )
+		return false;
+	owners.push_back( { obj, allocatorID } ); // within capacity, does not allocate
+	return true;
+}
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+
 struct FirstControlBlock // not reallocatable
 {
 	struct PtrWishFlagsForSoftPtrList : public nodecpp::platform::allocated_ptr_with_flags<2,2> {
@@ -204,8 +278,91 @@ struct FirstControlBlock // not reallocatable
 	{
 		static constexpr size_t secondBlockStartSize = 8;	
 		PtrWishFlagsForSoftPtrList* firstFree;
-		size_t otherAllockedCnt;
+		uint32_t otherAllockedCnt;
+		uint32_t usedCnt : 31;
+		uint32_t embedded : 1; // placed within the object's own allocation (see soft_ptr_slots_declarator)
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		uint16_t allocatorID; // allocator the block comes from; it is returned there whatever allocator is current at release
+#endif
 		PtrWishFlagsForSoftPtrList slots[1];
+		static constexpr size_t byteSize( size_t slotCnt ) { return sizeof(SecondCBHeader) - sizeof(PtrWishFlagsForSoftPtrList) + slotCnt * sizeof(PtrWishFlagsForSoftPtrList); }
+		bool isEmbedded() const { return embedded != 0; }
+
+		// size classes follow growth in reallocate(): cnt(k) = secondBlockStartSize * 2^k + 2 * (2^k - 1)
+		static size_t sizeClassOf( size_t slotCnt ) {
+			static_assert( secondBlockStartSize + 2 == 10 );
+			if ( ( slotCnt + 2 ) % 10 != 0 )
+				return SecondCBPool::sizeClassCount;
+			uint32_t pow2 = (uint32_t)( ( slotCnt + 2 ) / 10 );
+			if ( ( pow2 & ( pow2 - 1 ) ) != 0 )
+				return SecondCBPool::sizeClassCount;
+			size_t k = countTrailingZeros( pow2 );
+			return k < SecondCBPool::sizeClassCount ? k : SecondCBPool::sizeClassCount;
+		}
+		static bool canUsePool() {
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+			return g_CurrentAllocManager != nullptr && ( thg_secondCBPool.owner == nullptr || thg_secondCBPool.owner == g_CurrentAllocManager );
+#else
+			return true;
+#endif
+		}
+		// a block may be taken by the pool only if it comes from the allocator the pool is for
+		bool canReleaseToPool() const {
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+			return canUsePool() && g_CurrentAllocManager->allocatorID() == allocatorID;
+#else
+			return true;
+#endif
+		}
+		static SecondCBHeader* allocBlock( size_t slotCnt ) {
+			SecondCBHeader* ret;
+			size_t k = sizeClassOf( slotCnt );
+			SecondCBPool& pool = thg_secondCBPool;
+			if ( k < SecondCBPool::sizeClassCount && pool.heads[k] != nullptr && canUsePool() ) {
+				ret = reinterpret_cast<SecondCBHeader*>( pool.heads[k] );
+				pool.heads[k] = *reinterpret_cast<void**>( ret );
+				--(pool.counts[k]);
+				secondCBBytesPooled.fetch_sub( byteSize( slotCnt ), std::memory_order_relaxed );
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+				bool empty = true;
+				for ( size_t i=0; i<SecondCBPool::sizeClassCount; ++i )
+					empty = empty && pool.counts[i] == 0;
+				if ( empty )
+					pool.owner = nullptr;
+#endif
+			}
+			else
+				ret = reinterpret_cast<SecondCBHeader*>( allocate( byteSize( slotCnt ) ) );
+			secondCBBytesInUse.fetch_add( byteSize( slotCnt ), std::memory_order_relaxed );
+			ret->otherAllockedCnt = (uint32_t)slotCnt;
+			ret->usedCnt = 0;
+			ret->embedded = 0;
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+			ret->allocatorID = g_CurrentAllocManager != nullptr ? g_CurrentAllocManager->allocatorID() : 0; // see allocate()
+#endif
+			return ret;
+		}
+		// returns true if block is taken by the pool
+		static bool releaseToPool( SecondCBHeader* block ) {
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, !block->isEmbedded() );
+			size_t sz = byteSize( block->otherAllockedCnt );
+			secondCBBytesInUse.fetch_sub( sz, std::memory_order_relaxed );
+			size_t k = sizeClassOf( block->otherAllockedCnt );
+			SecondCBPool& pool = thg_secondCBPool;
+			if ( k < SecondCBPool::sizeClassCount && pool.counts[k] < SecondCBPool::maxBlocksPerClass && block->canReleaseToPool() ) {
+				if ( NODECPP_UNLIKELY( !pool.releaseAtThreadExit ) )
+					armSecondCBPoolRelease();
+				*reinterpret_cast<void**>( block ) = pool.heads[k];
+				pool.heads[k] = block;
+				++(pool.counts[k]);
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+				pool.owner = g_CurrentAllocManager;
+#endif
+				secondCBBytesPooled.fetch_add( sz, std::memory_order_relaxed );
+				return true;
+			}
+			return false;
+		}
 		void addToFreeList( PtrWishFlagsForSoftPtrList* begin, size_t count ) {
 			//NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, firstFree == nullptr );
 			firstFree = begin;
@@ -224,6 +381,7 @@ struct FirstControlBlock // not reallocatable
 			size_t idx;
 			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, !firstFree->is1stBlock() );
 			idx = firstFree - slots;
+			++usedCnt;
 			firstFree->setPtr(ptr);
 			firstFree->setUsed();
 			firstFree = tmp;
@@ -245,6 +403,8 @@ struct FirstControlBlock // not reallocatable
 		void remove( size_t idx ) {
 			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, firstFree == nullptr || !firstFree->isUsed() );
 			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, idx < otherAllockedCnt );
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, usedCnt != 0 );
+			--usedCnt;
 			slots[idx].setPtr( firstFree );
 			firstFree = slots + idx;
 			firstFree->setUnused();
@@ -257,20 +417,19 @@ struct FirstControlBlock // not reallocatable
 			if ( present != nullptr ) {
 				NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, present->otherAllockedCnt != 0 );
 				size_t newSize = (present->otherAllockedCnt << 1) + 2;
-				SecondCBHeader* ret = reinterpret_cast<SecondCBHeader*>( allocate( (newSize + 2) * sizeof(PtrWishFlagsForSoftPtrList) ) );
+				SecondCBHeader* ret = allocBlock( newSize );
 				//PtrWishFlagsForSoftPtrList* newOtherAllockedSlots = 
 				memcpy( ret->slots, present->slots, sizeof(PtrWishFlagsForSoftPtrList) * present->otherAllockedCnt );
 				//otherAllockedSlots.setPtr( newOtherAllockedSlots );
 				ret->addToFreeList( ret->slots + present->otherAllockedCnt, newSize - present->otherAllockedCnt );
-				deallocate( present, false );
-				ret->otherAllockedCnt = newSize;
+				ret->usedCnt = present->usedCnt;
+				present->dealloc(); // embedded one just stays unused till the object is gone
 				//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "after 2nd block relocation: ret = 0x{:x}, ret->otherAllockedCnt = {} (reallocation)", (size_t)ret, ret->otherAllockedCnt );
 				return ret;
 			}
 			else {
 				//NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, otherAllockedCnt == 0 );
-				SecondCBHeader* ret = reinterpret_cast<SecondCBHeader*>( allocate( (secondBlockStartSize + 2) * sizeof(PtrWishFlagsForSoftPtrList) ) );
-				ret->otherAllockedCnt = secondBlockStartSize;
+				SecondCBHeader* ret = allocBlock( secondBlockStartSize );
 				//present->firstFree->set(nullptr);
 				//otherAllockedSlots.setPtr( reinterpret_cast<PtrWishFlagsForSoftPtrList*>( allocate( otherAllockedCnt * sizeof(PtrWishFlagsForSoftPtrList) ) ) );
 				ret->addToFreeList( ret->slots, secondBlockStartSize );
@@ -278,29 +437,87 @@ struct FirstControlBlock // not reallocatable
 				return ret;
 			}
 		}
+		static SecondCBHeader* initEmbedded( void* place, size_t slotCnt )
+		{
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, slotCnt != 0 );
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, ((uintptr_t)place & 7) == 0, "place = 0x{:x}", (uintptr_t)place );
+			SecondCBHeader* ret = reinterpret_cast<SecondCBHeader*>( place );
+			ret->otherAllockedCnt = (uint32_t)slotCnt;
+			ret->usedCnt = 0;
+			ret->embedded = 1;
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+			ret->allocatorID = 0; // not used for embedded blocks
+#endif
+			ret->addToFreeList( ret->slots, slotCnt );
+			return ret;
+		}
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-		void dealloc() { deallocate( this ); }
-		void dealloc( uint16_t AllocatorID ) { deallocate( this, AllocatorID ); }
+		void dealloc() { if ( !isEmbedded() && !releaseToPool( this ) ) deallocate( this, allocatorID ); }
 #else
-		void dealloc() { deallocate( this ); }
+		void dealloc() { if ( !isEmbedded() && !releaseToPool( this ) ) deallocate( this ); }
 #endif
 	};
 
-	struct PtrWithMaskAndFlag : protected nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>
-	{
-		void init() { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::init(); }
-		void setPtr(SecondCBHeader* ptr) { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::set_ptr( ptr ); }
-		SecondCBHeader* getPtr() { return reinterpret_cast<SecondCBHeader*>( nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::get_ptr() ); }
-		const SecondCBHeader* getPtr() const { return reinterpret_cast<SecondCBHeader*>( nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::get_ptr() ); }
-		uint32_t getMask() const { return (uint32_t)(nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::get_mask()); }
-		void setMask(size_t mask) { return nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::set_mask(mask); }
-		void setZombie() { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::init(); nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::set_flag<0>(); }
-		bool isZombie() { return nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,1>::has_flag<0>(); }
+	struct PtrWithMaskAndFlag : protected nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>
+	{
+		void init() { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::init(); }
+		void setPtr(SecondCBHeader* ptr) { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::set_ptr( ptr ); }
+		SecondCBHeader* getPtr() { return reinterpret_cast<SecondCBHeader*>( nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::get_ptr() ); }
+		const SecondCBHeader* getPtr() const { return reinterpret_cast<SecondCBHeader*>( nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::get_ptr() ); }
+		uint32_t getMask() const { return (uint32_t)(nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::get_mask()); }
+		void setMask(size_t mask) { return nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::set_mask(mask); }
+		// the only flag read on dereference (see soft_ptr_base_impl::checkNotZombieByControlBlock()); set by both setZombie() and markZombie()
+		static constexpr size_t zombieFlag = 0;
+		static constexpr size_t overAlignedFlag = 1;
+		static_assert( zombieFlag != overAlignedFlag );
+		void setZombie() { 
+			bool overAligned = isOverAligned(); // layout of the block must still be known
+			nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::init(); 
+			nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::set_flag<zombieFlag>(); 
+			if ( overAligned )
+				setOverAligned();
+		}
+		void markZombie() { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::set_flag<zombieFlag>(); } // slots are kept as is
+		bool isZombie() { return nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::has_flag<zombieFlag>(); }
+		void setOverAligned() { nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::set_flag<overAlignedFlag>(); }
+		bool isOverAligned() const { return nodecpp::platform::allocated_ptr_with_mask_and_flags<3,3,2>::has_flag<overAlignedFlag>(); }
 	};
 
 	static constexpr size_t maxSlots = 3;
+	static constexpr uint32_t fullSlotMask = ( ((uint32_t)1) << maxSlots ) - 1;
 	PtrWishFlagsForSoftPtrList slots[maxSlots];
 	static constexpr size_t secondBlockStartSize = 8;	
+
+	// extra inline slots (see soft_ptr_slots_declarator) are kept in a SecondCBHeader placed right after the object
+	template<class T>
+	static constexpr size_t embeddedSlotCount() {
+		static_assert( soft_ptr_slots_declarator<T>::inline_slots >= maxSlots, "at least FirstControlBlock::maxSlots slots are always inline" );
+		return soft_ptr_slots_declarator<T>::inline_slots - maxSlots;
+	}
+	static constexpr size_t embeddedBlockOffset( size_t objSz ) { return ( objSz + 7 ) & ~((size_t)7); } // PtrWithMaskAndFlag requires 8-byte alignment
+	static constexpr size_t embeddedBlockSize( size_t slotCnt ) { return slotCnt == 0 ? 0 : SecondCBHeader::byteSize( slotCnt ); }
+	template<class T>
+	static constexpr size_t allocSizeAfterControlBlock() {
+		return embeddedSlotCount<T>() == 0 ? sizeof(T) : embeddedBlockOffset( sizeof(T) ) + embeddedBlockSize( embeddedSlotCount<T>() );
+	}
+
+	// An object with alignof(T) above what the allocator guarantees is placed at an aligned position within a larger block.
+	// Distance from the start of the block to where it would be with a regular layout (i.e. cb + getPrefixByteCount())
+	// is kept in a word right before the control block, which is marked as over-aligned.
+	static constexpr bool isOverAlignedType( size_t alignment ) { return alignment > NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT; }
+	static constexpr size_t overAlignedExtraSize( size_t alignment ) { return isOverAlignedType( alignment ) ? alignment : 0; }
+	// returns dataForObj for a block of at least overAlignedExtraSize(alignment) + head + object size bytes
+	static uint8_t* placeOverAligned( uint8_t* data, size_t head, size_t alignment ) {
+		uintptr_t dataForObj = ( reinterpret_cast<uintptr_t>( data ) + head + sizeof(size_t) + alignment - 1 ) & ~( (uintptr_t)alignment - 1 );
+		size_t shift = dataForObj - reinterpret_cast<uintptr_t>( data ) - head;
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, shift >= sizeof(size_t) && shift <= overAlignedExtraSize( alignment ), "shift = {}", shift );
+		reinterpret_cast<size_t*>( reinterpret_cast<FirstControlBlock*>( dataForObj ) - 1 )[-1] = shift;
+		return reinterpret_cast<uint8_t*>( dataForObj );
+	}
+	void setOverAligned() { otherAllockedSlots.setOverAligned(); } // to be called after init() and placeOverAligned()
+	bool isOverAligned() const { return otherAllockedSlots.isOverAligned(); }
+	size_t getOverAlignedShift() const { return reinterpret_cast<const size_t*>( this )[-1]; }
+
 	//PtrWishFlagsForSoftPtrList* firstFree;
 	//size_t otherAllockedCnt = 0; // TODO: try to rely on our allocator on deriving this value
 //	nodecpp::platform::allocated_ptr_with_mask_and_flags<3,1> otherAllockedSlots;
@@ -396,39 +613,68 @@ struct FirstControlBlock // not reallocatable
 		dbgCheckFreeList();
 		dbgCheckValidity<void>();
 	}
+	// soft_ptrs are registered untyped; they are accessed via untypedSoftPtr_() (soft_ptr_base_impl is not yet defined here)
+	static soft_ptr_base_impl<void>* untypedSoftPtr_( void* softPtr );
+	static void setSoftPtrIdx_( void* softPtr, size_t idx );
+	static void invalidateSoftPtr_( void* softPtr );
+	// moves used slots to a block of previous size class; soft_ptrs are updated with their new indexes
+	NODECPP_NOINLINE void shrinkSecondBlock() {
+		SecondCBHeader* present = otherAllockedSlots.getPtr();
+		size_t newSize = ( present->otherAllockedCnt - 2 ) >> 1;
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, present->usedCnt < newSize );
+		SecondCBHeader* ret = SecondCBHeader::allocBlock( newSize );
+		size_t j = 0;
+		for ( size_t i=0; i<present->otherAllockedCnt; ++i )
+			if ( present->slots[i].isUsed() ) {
+				void* softPtr = present->slots[i].getPtr();
+				ret->slots[j].setPtr( softPtr );
+				ret->slots[j].setUsed();
+				ret->slots[j].set2ndBlock();
+				setSoftPtrIdx_( softPtr, maxSlots + j );
+				++j;
+			}
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, j == present->usedCnt, "{} vs. {}", j, (size_t)(present->usedCnt) );
+		ret->usedCnt = (uint32_t)j;
+		ret->addToFreeList( ret->slots + j, newSize - j );
+		present->dealloc();
+		otherAllockedSlots.setPtr( ret );
+		dbgCheckValidity<void>();
+	}
+	void attachEmbeddedSecondBlock( void* place, size_t slotCnt ) {
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, otherAllockedSlots.getPtr() == nullptr );
+		otherAllockedSlots.setPtr( SecondCBHeader::initEmbedded( place, slotCnt ) );
+		dbgCheckValidity<void>();
+	}
 /*	void enlargeSecondBlock() {
 		otherAllockedSlots.setPtr( SecondCBHeader::reallocate( otherAllockedSlots.getPtr() ) );
 	}*/
-	size_t insert( void* ptr ) {
+	NODECPP_FORCEINLINE size_t insert( void* ptr ) {
 		dbgCheckValidity<void>();
 		uint32_t mask = otherAllockedSlots.getMask();
-		//if ( mask != 0x7 )
+		if ( NODECPP_LIKELY( mask != fullSlotMask ) )
 		{
-			// TODO: optimize!
-			for ( size_t i=0; i<3; ++i )
-				if ( ( mask & (((size_t)1)<<i)) == 0 )
-				{
-					mask |= (((size_t)1)<<i);
-					slots[i].setPtr(ptr);
-					slots[i].setUsed();
-					otherAllockedSlots.setMask( mask );
-					//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: inserted 0x{:x} at idx {}", (size_t)this, (size_t)ptr, i );
-					return i;
-				}
+			// first free slot is the lowest zero bit of the mask
+			size_t i = countTrailingZeros( ~mask );
+			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, i < maxSlots, "mask = 0x{:x}", mask );
+			slots[i].setPtr(ptr);
+			slots[i].setUsed();
+			otherAllockedSlots.setMask( mask | (((uint32_t)1)<<i) );
+			//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: inserted 0x{:x} at idx {}", (size_t)this, (size_t)ptr, i );
+			return i;
 		}
-		//else
+		return insertToSecondBlock( ptr );
+	}
+	NODECPP_NOINLINE size_t insertToSecondBlock( void* ptr ) {
+		if ( otherAllockedSlots.getPtr() == nullptr || otherAllockedSlots.getPtr()->firstFree == nullptr )
 		{
-			if ( otherAllockedSlots.getPtr() == nullptr || otherAllockedSlots.getPtr()->firstFree == nullptr )
-			{
-		//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: about to reset 2nd block, otherAllockedSlots.getPtr() = 0x{:x}", (size_t)this, (size_t)(otherAllockedSlots.getPtr()) );
-				otherAllockedSlots.setPtr( SecondCBHeader::reallocate( otherAllockedSlots.getPtr() ) );
-		//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: after reset 2nd block, otherAllockedSlots.getPtr() = 0x{:x}", (size_t)this, (size_t)(otherAllockedSlots.getPtr()) );
-			}
-			NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, otherAllockedSlots.getPtr() && otherAllockedSlots.getPtr()->firstFree );
-			size_t idx = maxSlots + otherAllockedSlots.getPtr()->insert( ptr );
-					//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: inserted 0x{:x} at idx {}", (size_t)this, (size_t)ptr, idx );
-			return idx;
+	//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: about to reset 2nd block, otherAllockedSlots.getPtr() = 0x{:x}", (size_t)this, (size_t)(otherAllockedSlots.getPtr()) );
+			otherAllockedSlots.setPtr( SecondCBHeader::reallocate( otherAllockedSlots.getPtr() ) );
+	//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: after reset 2nd block, otherAllockedSlots.getPtr() = 0x{:x}", (size_t)this, (size_t)(otherAllockedSlots.getPtr()) );
 		}
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, otherAllockedSlots.getPtr() && otherAllockedSlots.getPtr()->firstFree );
+		size_t idx = maxSlots + otherAllockedSlots.getPtr()->insert( ptr );
+				//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: inserted 0x{:x} at idx {}", (size_t)this, (size_t)ptr, idx );
+		return idx;
 	}
 	void resetPtr( size_t idx, void* newPtr ) {
 		//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: about to reset to 0x{:x} at idx {}", (size_t)this, (size_t)newPtr, idx );
@@ -457,14 +703,17 @@ struct FirstControlBlock // not reallocatable
 			//NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, idx - maxSlots < otherAllockedCnt );
 			idx -= maxSlots;
 			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, otherAllockedSlots.getPtr() != nullptr );
-			otherAllockedSlots.getPtr()->remove( idx );
+			SecondCBHeader* header = otherAllockedSlots.getPtr();
+			header->remove( idx );
+			// hysteresis: a block grows when full, and shrinks only when it is at most 1/8 occupied
+			if ( NODECPP_UNLIKELY( header->usedCnt * 8 <= header->otherAllockedCnt && header->otherAllockedCnt > secondBlockStartSize && !header->isEmbedded() ) )
+				shrinkSecondBlock();
 		}
 		//NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, firstFree == nullptr || !firstFree->isUsed() );
 		//dbgCheckFreeList();
 		dbgCheckValidity<void>();
 	}
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-	void clear()
+	void clear() // second block is returned to the allocator it comes from (see SecondCBHeader::dealloc())
 	{
 		//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: clear(), otherAllockedSlots.getPtr() = 0x{:x}", (size_t)this, (size_t)(otherAllockedSlots.getPtr()) );
 		if ( otherAllockedSlots.getPtr() != nullptr )
@@ -472,34 +721,40 @@ struct FirstControlBlock // not reallocatable
 		otherAllockedSlots.setZombie();
 		//dbgCheckValidity<void>();
 	}
-	void clear( uint16_t AllocatorID )
-#else
-	void clear()
-#endif
+	bool isZombie() { return otherAllockedSlots.isZombie(); }
+	void markZombie() { otherAllockedSlots.markZombie(); } // soft_ptrs are still registered (deferred destruction)
+	bool hasSoftPtrs() const { 
+		const SecondCBHeader* header = otherAllockedSlots.getPtr();
+		return otherAllockedSlots.getMask() != 0 || ( header != nullptr && header->usedCnt != 0 );
+	}
+
+	// soft_ptrs are usually scattered over memory; to avoid paying for a cache miss at each of them in turn,
+	// pointers are first gathered (and their targets prefetched) by batches, and only then written
+	static void invalidateSoftPtrs( const PtrWishFlagsForSoftPtrList* slots_, size_t cnt )
 	{
-		//nodecpp::log::default_log::error( nodecpp::log::ModuleID(safememory::safememory_module_id), "1CB 0x{:x}: clear(), otherAllockedSlots.getPtr() = 0x{:x}", (size_t)this, (size_t)(otherAllockedSlots.getPtr()) );
-		if ( otherAllockedSlots.getPtr() != nullptr )
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-			otherAllockedSlots.getPtr()->dealloc( AllocatorID );
-#else
-			otherAllockedSlots.getPtr()->dealloc();
-#endif
-		otherAllockedSlots.setZombie();
-		//dbgCheckValidity<void>();
+		constexpr size_t batchSize = 16;
+		void* batch[batchSize];
+		size_t i = 0;
+		while ( i < cnt )
+		{
+			size_t n = 0;
+			for ( ; i < cnt && n < batchSize; ++i )
+				if ( slots_[i].isUsed() )
+				{
+					batch[n] = slots_[i].getPtr();
+					prefetchForWrite( batch[n] );
+					++n;
+				}
+			for ( size_t j=0; j<n; ++j )
+				invalidateSoftPtr_( batch[j] );
+		}
 	}
-	bool isZombie() { return otherAllockedSlots.isZombie(); }
 
-	template<class T>
 	void updatePtrForListItemsWithInvalidPtr()
 	{
-		FirstControlBlock* cb = this;
-		for ( size_t i=0; i<FirstControlBlock::maxSlots; ++i )
-			if ( cb->slots[i].isUsed() )
-				reinterpret_cast<soft_ptr_impl<T>*>(cb->slots[i].getPtr())->invalidatePtr();
-		if ( cb->otherAllockedSlots.getPtr() )
-			for ( size_t i=0; i<cb->otherAllockedSlots.getPtr()->otherAllockedCnt; ++i )
-				if ( cb->otherAllockedSlots.getPtr()->slots[i].isUsed() )
-					reinterpret_cast<soft_ptr_impl<T>*>(cb->otherAllockedSlots.getPtr()->slots[i].getPtr())->invalidatePtr();
+		invalidateSoftPtrs( slots, maxSlots );
+		if ( otherAllockedSlots.getPtr() )
+			invalidateSoftPtrs( otherAllockedSlots.getPtr()->slots, otherAllockedSlots.getPtr()->otherAllockedCnt );
 	}
 
 };
@@ -510,7 +765,13 @@ struct FirstControlBlock // not reallocatable
 inline
 FirstControlBlock* getControlBlock_(const void* t) { return reinterpret_cast<FirstControlBlock*>(const_cast<void*>(t)) - 1; }
 inline
-uint8_t* getAllocatedBlock_(const void* t) { return reinterpret_cast<uint8_t*>(getControlBlock_(t)) + getPrefixByteCount(); }
+uint8_t* getAllocatedBlock_(const void* t) { 
+	FirstControlBlock* cb = getControlBlock_(t);
+	uint8_t* ret = reinterpret_cast<uint8_t*>(cb) + getPrefixByteCount();
+	if ( NODECPP_UNLIKELY( cb->isOverAligned() ) )
+		ret -= cb->getOverAlignedShift();
+	return ret;
+}
 inline
 uint8_t* getAllocatedBlockFromControlBlock_(void* cb) { return reinterpret_cast<uint8_t*>(cb) + getPrefixByteCount(); }
 inline
@@ -536,9 +797,13 @@ class owning_ptr_base_impl
 	friend class soft_ptr_base_no_checks;
 	template<class TT>
 	friend class soft_ptr_no_checks;
+	template<class TT>
+	friend class borrowed_ptr_impl;
 
 	template<class TT>
 	friend void killUnderconsructedOP( owning_ptr_base_impl<TT>& );
+	template<class TT>
+	friend class object_pool_impl;
 
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 #ifdef NODECPP_SAFE_PTR_DEBUG_MODE
@@ -607,14 +872,37 @@ class owning_ptr_base_impl
 		if ( isInCommonHeap() )
 			return;
 #endif
-		FirstControlBlock* cb = getControlBlock();
-		for ( size_t i=0; i<FirstControlBlock::maxSlots; ++i )
-			if ( cb->slots[i].isUsed() )
-				reinterpret_cast<soft_ptr_impl<T>*>(cb->slots[i].getPtr())->invalidatePtr();
-		if ( cb->otherAllockedSlots.getPtr() )
-			for ( size_t i=0; i<cb->otherAllockedSlots.getPtr()->otherAllockedCnt; ++i )
-				if ( cb->otherAllockedSlots.getPtr()->slots[i].isUsed() )
-					reinterpret_cast<soft_ptr_impl<T>*>(cb->otherAllockedSlots.getPtr()->slots[i].getPtr())->invalidatePtr();
+		getControlBlock()->updatePtrForListItemsWithInvalidPtr();
+	}
+
+	// invalidates soft_ptrs to an object (not in common heap) that is already destructed, and releases its memory
+	void releaseBlock()
+	{
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+		getControlBlock()->markZombie();
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		if ( NODECPP_LIKELY( deferOwnerRelease( t.getPtr(), t.allocatorIdx() ) ) )
+#else
+		if ( NODECPP_LIKELY( deferOwnerRelease( t.getPtr(), 0 ) ) )
+#endif
+			return;
+		// no room to record the owner; it is released right away
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+		updatePtrForListItemsWithInvalidPtr();
+		// marked as zombie before the block goes to the allocator; getAllocatedBlock_() still works then
+		getControlBlock()->clear();
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		zombieDeallocate( getAllocatedBlock_(t.getTypedPtr()), t.allocatorIdx() );
+#else
+		zombieDeallocate( getAllocatedBlock_(t.getTypedPtr()) );
+#endif
+	}
+
+	// remainder of reset() for an object (not in common heap) that is already destructed
+	void releaseDestructed()
+	{
+		releaseBlock();
+		t.reset();
 	}
 
 #ifdef NODECPP_SAFEMEMORY_HEAVY_DEBUG
@@ -782,14 +1070,7 @@ public:
 #ifdef NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
 			dbgSetDestructionPointInfo( DbgDestructionInfo::Destruction::dtoring );
 #endif // NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
-			updatePtrForListItemsWithInvalidPtr();
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-			zombieDeallocate( getAllocatedBlock_(t.getTypedPtr()), t.allocatorIdx() );
-			getControlBlock()->clear( t.allocatorIdx() );
-#else
-			zombieDeallocate( getAllocatedBlock_(t.getTypedPtr()) );
-			getControlBlock()->clear();
-#endif
+			releaseBlock();
 			t.setZombie();
 			forcePreviousChangesToThisInDtor(this); // force compilers to apply the above instruction
 		}
@@ -804,7 +1085,7 @@ public:
 			if ( NODECPP_LIKELY(t.getTypedPtr()) )
 			{
 				destruct( t.getTypedPtr() );
-				deallocate( t.getTypedPtr(), t.allocatorIdx() );
+				deallocate( t.getTypedPtr(), alignof(T), t.allocatorIdx() );
 				t.reset();
 			}
 			return;
@@ -816,15 +1097,7 @@ public:
 #ifdef NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
 			dbgSetDestructionPointInfo( DbgDestructionInfo::Destruction::resetting );
 #endif // NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
-			updatePtrForListItemsWithInvalidPtr();
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-			zombieDeallocate( getAllocatedBlock_(t.getTypedPtr()), t.allocatorIdx() );
-			getControlBlock()->clear( t.allocatorIdx() );
-#else
-			zombieDeallocate( getAllocatedBlock_(t.getTypedPtr()) );
-			getControlBlock()->clear();
-#endif
-			t.reset();
+			releaseDestructed();
 		}
 		dbgCheckValidity();
 	}
@@ -946,21 +1219,17 @@ template<class _Ty,
 	std::enable_if_t<!std::is_array<_Ty>::value, int> = 0>
 NODISCARD owning_ptr_impl<_Ty> make_owning_impl(_Types&&... _Args)
 {
-	static_assert( alignof(_Ty) <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT );
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 		if ( ::nodecpp::iibmalloc::g_CurrentAllocManager == nullptr )
 		{
 			uint8_t* data = reinterpret_cast<uint8_t*>( allocate( sizeof(_Ty), alignof(_Ty) ) );
-			void* stackTmp = thg_stackPtrForMakeOwningCall;
-			thg_stackPtrForMakeOwningCall = nullptr;
 			NODECPP_ASSERT( nodecpp::foundation::module_id, nodecpp::assert::AssertLevel::pedantic, ((uintptr_t)data & (alignof(_Ty)-1)) == 0, "indeed, alignof(_Ty) = {} and data = 0x{:x}", alignof(_Ty), (uintptr_t)data );
 			try {
-				_Ty* objPtr = new (data) _Ty(::std::forward<_Types>(_Args)...);
-				thg_stackPtrForMakeOwningCall = stackTmp;
+				make_owning_context ctx( nullptr );
+				new (data) _Ty(::std::forward<_Types>(_Args)...);
 			}
 			catch (...) {
 				deallocate( data, alignof(_Ty), 0 );
-				thg_stackPtrForMakeOwningCall = stackTmp;
 				throw;
 			}
 			owning_ptr_impl<_Ty> op( make_owning_t(0), (_Ty*)(data) );
@@ -968,26 +1237,34 @@ NODISCARD owning_ptr_impl<_Ty> make_owning_impl(_Types&&... _Args)
 		}
 #endif
 	NODECPP_ASSERT( nodecpp::foundation::module_id, nodecpp::assert::AssertLevel::pedantic, ::nodecpp::iibmalloc::g_CurrentAllocManager != nullptr );
-	uint8_t* data = reinterpret_cast<uint8_t*>( zombieAllocateAligned< sizeof(FirstControlBlock) - getPrefixByteCount() + sizeof(_Ty), alignof(_Ty) >() );
+	constexpr size_t embeddedSlotCnt = FirstControlBlock::embeddedSlotCount<_Ty>();
+	constexpr size_t head = sizeof(FirstControlBlock) - getPrefixByteCount();
+	constexpr bool overAligned = FirstControlBlock::isOverAlignedType( alignof(_Ty) );
+	uint8_t* data = reinterpret_cast<uint8_t*>( zombieAllocateAligned< FirstControlBlock::overAlignedExtraSize( alignof(_Ty) ) + head + FirstControlBlock::allocSizeAfterControlBlock<_Ty>(), overAligned ? NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT : alignof(_Ty) >() );
 	auto allocatorID = ::nodecpp::iibmalloc::g_CurrentAllocManager->allocatorID();
 	NODECPP_ASSERT( nodecpp::foundation::module_id, nodecpp::assert::AssertLevel::pedantic, allocatorID != 0 );
-	uint8_t* dataForObj = data + sizeof(FirstControlBlock) - getPrefixByteCount();
+	uint8_t* dataForObj;
+	if constexpr ( overAligned )
+		dataForObj = FirstControlBlock::placeOverAligned( data, head, alignof(_Ty) );
+	else
+		dataForObj = data + head;
 	NODECPP_ASSERT( nodecpp::foundation::module_id, nodecpp::assert::AssertLevel::pedantic, ((uintptr_t)dataForObj & (alignof(_Ty)-1)) == 0, "indeed, dataForObj = 0x{:x}, NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT = 0x{:x}", (uintptr_t)dataForObj, alignof(_Ty) );
-	void* stackTmp = thg_stackPtrForMakeOwningCall;
-	thg_stackPtrForMakeOwningCall = dataForObj;
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 	owning_ptr_impl<_Ty> op(make_owning_t( allocatorID ), (_Ty*)(uintptr_t)(dataForObj));
 #else
 	owning_ptr_impl<_Ty> op(make_owning_t(), (_Ty*)(uintptr_t)(dataForObj));
 #endif
+	if constexpr ( overAligned )
+		getControlBlock_(dataForObj)->setOverAligned();
+	if constexpr ( embeddedSlotCnt != 0 )
+		getControlBlock_(dataForObj)->attachEmbeddedSecondBlock( dataForObj + FirstControlBlock::embeddedBlockOffset( sizeof(_Ty) ), embeddedSlotCnt );
 	try { 
+		make_owning_context ctx( dataForObj );
 		new ( dataForObj ) _Ty(::std::forward<_Types>(_Args)...);
-		thg_stackPtrForMakeOwningCall = stackTmp;
 		return op;
 	}
 	catch( ... ) {
 		killUnderconsructedOP( op );
-		thg_stackPtrForMakeOwningCall = stackTmp;
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 		zombieDeallocate(data, allocatorID);
 #else
@@ -997,20 +1274,27 @@ NODISCARD owning_ptr_impl<_Ty> make_owning_impl(_Types&&... _Args)
 	}
 }
 
-
+// Opt-in: define NODECPP_SAFE_PTR_USE_ON_STACK_OPTIMIZATION to skip registration of soft_ptrs that are on stack.
+// NOTE: this changes semantics: a soft_ptr on stack is not reset to nullptr when its owner is destroyed, that is,
+//       it does not compare equal to nullptr afterwards, and only zombie detection protects its dereferencing
 #ifdef NODECPP_SAFE_PTR_USE_ON_STACK_OPTIMIZATION
-//NODECPP_FORCEINLINE
-//bool is_guaranteed_on_stack(void* p) { return nodecpp::platform::is_guaranteed_on_stack( p ); }
-#define IF_IS_GUARANTEED_ON_STACK( ptr ) if ( nodecpp::platform::is_guaranteed_on_stack( (ptr) ) )
-#ifndef NODECPP_MEMORY_SAFETY_ON_DEMAND
+#define IF_IS_GUARANTEED_ON_STACK( ptr ) if ( isGuaranteedOnStack( (ptr) ) )
 #define NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING
-#endif
 #else
 //constexpr bool is_guaranteed_on_stack(void*) { return false; }
 #define IF_IS_GUARANTEED_ON_STACK( ptr ) if constexpr ( false )
 #endif // NODECPP_SAFE_PTR_USE_ON_STACK_OPTIMIZATION
 
 
+// Number of soft_ptrs created/destroyed at current thread without registration, as they are on stack;
+// compare with the total of soft_ptrs created to see a hit rate of the optimization
+struct OnStackSafePtrMetrics
+{
+	size_t creationCount;
+	size_t destructionCount;
+};
+OnStackSafePtrMetrics getOnStackSafePtrMetrics(); // zeros if the optimization is disabled
+
 #ifdef NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING
 extern thread_local size_t onStackSafePtrCreationCount; 
 extern thread_local size_t onStackSafePtrDestructionCount;
@@ -1021,6 +1305,76 @@ extern thread_local size_t onStackSafePtrDestructionCount;
 #define INCREMENT_ONSTACK_SAFE_PTR_DESTRUCTION_COUNT() {}
 #endif // NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING
 
+#if defined NODECPP_COMPACT_SOFT_PTR && defined NODECPP_X64 && !defined NODECPP_SAFE_PTR_DEBUG_MODE
+// Compact (2-word) replacement for allocated_ptr_and_ptr_and_data_and_flags<3,32,1> to be used by soft_ptr_base_impl.
+// User-space addresses on x64 fit into 48 bits, so 16 upper bits of each of the two pointers are spare;
+// a 32-bit slot index is split between them. Lower bits of the allocated pointer (aligned to 8) keep flags.
+// word0: [ idx 0..15 | ptr (48 bits) ]
+// word1: [ idx 16..31 | allocated ptr (45 bits) | zombie | flags ]
+struct compact_allocated_ptr_and_ptr_and_data_and_flags
+{
+	static constexpr size_t addressBits = 48;
+	static constexpr uintptr_t addressMask = ( ((uintptr_t)1) << addressBits ) - 1;
+	static constexpr size_t halfDataBits = 64 - addressBits;
+	static constexpr uintptr_t halfDataMask = ( ((uintptr_t)1) << halfDataBits ) - 1;
+	static constexpr uintptr_t allocptrFlagMask = 0x7; // allocated ptr is aligned at least to 8
+	static constexpr uintptr_t zombieFlag = 0x4;
+	static constexpr size_t max_data = ( ((size_t)1) << ( 2 * halfDataBits ) ) - 1;
+
+	uintptr_t word0;
+	uintptr_t word1;
+
+	// with a wider address space (e.g. 5-level paging) packing would silently corrupt pointers; one test covers both
+	static void checkAddresses( uintptr_t ptr, uintptr_t allocptr ) {
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, ( ( ptr | allocptr ) & ~addressMask ) == 0, "addresses beyond {} bits: 0x{:x}, 0x{:x}", addressBits, ptr, allocptr );
+	}
+
+	void init() { word0 = 0; word1 = 0; }
+	void init( size_t data ) {
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, data <= max_data );
+		word0 = ( data & halfDataMask ) << addressBits;
+		word1 = ( data >> halfDataBits ) << addressBits;
+	}
+	void init( const void* ptr, const void* allocptr, size_t data ) {
+		uintptr_t p = reinterpret_cast<uintptr_t>( ptr );
+		uintptr_t ap = reinterpret_cast<uintptr_t>( allocptr );
+		checkAddresses( p, ap );
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, ( ap & allocptrFlagMask ) == 0 );
+		init( data );
+		word0 |= p;
+		word1 |= ap;
+	}
+
+	void* get_ptr() const { return reinterpret_cast<void*>( word0 & addressMask ); }
+	void* get_allocated_ptr() const { return reinterpret_cast<void*>( word1 & addressMask & ~allocptrFlagMask ); }
+
+	size_t get_data() const { return ( word0 >> addressBits ) | ( ( word1 >> addressBits ) << halfDataBits ); }
+	void set_data( size_t data ) {
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::pedantic, data <= max_data );
+		word0 = ( word0 & addressMask ) | ( ( data & halfDataMask ) << addressBits );
+		word1 = ( word1 & addressMask ) | ( ( data >> halfDataBits ) << addressBits );
+	}
+
+	template<size_t pos>
+	void set_flag() { static_assert( pos < 2 ); word1 |= ((uintptr_t)1) << pos; }
+	template<size_t pos>
+	void unset_flag() { static_assert( pos < 2 ); word1 &= ~( ((uintptr_t)1) << pos ); }
+	template<size_t pos>
+	bool has_flag() const { static_assert( pos < 2 ); return ( word1 & ( ((uintptr_t)1) << pos ) ) != 0; }
+
+	// dereferencable ptr is dropped, so that any further access is caught as a null pointer access
+	void set_zombie() { word0 &= ~addressMask; word1 |= zombieFlag; }
+	bool is_zombie() const { return ( word1 & zombieFlag ) != 0; }
+
+	void copy_from( const compact_allocated_ptr_and_ptr_and_data_and_flags& other ) { word0 = other.word0; word1 = other.word1; }
+	void swap( compact_allocated_ptr_and_ptr_and_data_and_flags& other ) {
+		uintptr_t tmp0 = word0; word0 = other.word0; other.word0 = tmp0;
+		uintptr_t tmp1 = word1; word1 = other.word1; other.word1 = tmp1;
+	}
+};
+static_assert( sizeof(compact_allocated_ptr_and_ptr_and_data_and_flags) == 2 * sizeof(void*) );
+#endif // NODECPP_COMPACT_SOFT_PTR
+
 template<class T>
 class soft_ptr_base_impl
 {
@@ -1045,6 +1399,8 @@ class soft_ptr_base_impl
 	friend struct FirstControlBlock;
 
 	friend class safememory::detail::soft_ptr_helper;
+	template<class TT>
+	friend class borrowed_ptr_impl;
 
 #ifdef NODECPP_SAFE_PTR_DEBUG_MODE
 #ifdef NODECPP_X64
@@ -1053,7 +1409,9 @@ class soft_ptr_base_impl
 	using PointersT = nodecpp::platform::ptrwithdatastructsdefs::generic_allocated_ptr_and_ptr_and_data_and_flags_<2,26,1>; 
 #endif
 #else
-#ifdef NODECPP_X64
+#if defined NODECPP_COMPACT_SOFT_PTR && defined NODECPP_X64
+	using PointersT = compact_allocated_ptr_and_ptr_and_data_and_flags; 
+#elif defined NODECPP_X64
 	using PointersT = nodecpp::platform::allocated_ptr_and_ptr_and_data_and_flags<3,32,1>; 
 #else
 	using PointersT = nodecpp::platform::allocated_ptr_and_ptr_and_data_and_flags<2,26,1>; 
@@ -1091,6 +1449,25 @@ class soft_ptr_base_impl
 
 	void invalidatePtr() { pointers.invalidatePtr(); }
 	void setPtrZombie() { pointers.setPtrZombie(); }
+	// A dead object is detected by its control block, which is marked as zombie by the owner and is not reused
+	// until killAllZombies(); this takes a single load next to the object rather than an allocator query.
+	// With deferred owner destruction a soft_ptr is invalidated at killAllZombies() only, and otherwise it is needed
+	// for on-stack soft_ptrs, that are not registered in (and thus not invalidated via) the control block
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+	void checkNotZombieByControlBlock() const {
+		void* allocated = getAllocatedPtr();
+		if ( allocated != nullptr && NODECPP_UNLIKELY( getControlBlock_(allocated)->isZombie() ) )
+			throw ::nodecpp::error::zero_pointer_access;
+	}
+#elif !defined NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+	void checkNotZombieByControlBlock() const {
+		void* allocated = getAllocatedPtr();
+		if ( allocated != nullptr && NODECPP_UNLIKELY( getControlBlock_(allocated)->isZombie() ) )
+			throw ::nodecpp::error::early_detected_zombie_pointer_access;
+	}
+#else
+	void checkNotZombieByControlBlock() const {}
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
 	void setOnStack() { pointers.setOnStack(); }
 	void setNotOnStack() { pointers.setNotOnStack(); }
 	bool isOnStack() { return pointers.isOnStack(); }
@@ -1721,17 +2098,14 @@ public:
 
 template<class T>
 soft_ptr_impl<T> soft_ptr_in_constructor_impl(T* ptr) {
+	void* obj = make_owning_context::current();
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-	if ( thg_stackPtrForMakeOwningCall == nullptr )
+	if ( obj == nullptr )
 		return soft_ptr_impl<T>( nullptr, ptr );
 #endif
-	FirstControlBlock* cbPtr = nullptr;
-	if ( thg_stackPtrForMakeOwningCall == NODECPP_SECOND_NULLPTR )
+	if ( obj == NODECPP_SECOND_NULLPTR )
 		throwPointerOutOfRange();
-	cbPtr = getControlBlock_(thg_stackPtrForMakeOwningCall);
-	void* allocatedPtr = getAllocatedBlockFromControlBlock_( getAllocatedBlock_(cbPtr) );
-	FirstControlBlock* cb = cbPtr;
-	return soft_ptr_impl<T>( cb, ptr );
+	return soft_ptr_impl<T>( getControlBlock_(obj), ptr );
 }
 
 template<class T>
@@ -1760,6 +2134,8 @@ private:
 	friend soft_ptr_impl<T> soft_ptr_in_constructor_impl<>(T* ptr);
 
 	friend class safememory::detail::soft_ptr_helper;
+	template<class TT>
+	friend class borrowed_ptr_impl;
 
 	soft_ptr_impl(FirstControlBlock* cb, T* t) : soft_ptr_base_impl<T>(cb, t) {} // to be used for only types annotaded as [[nodecpp::owning_only]]
 
@@ -2007,6 +2383,7 @@ public:
 		dbgTestForNullAndThrowNullPtrAccess();
 #endif // NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
 
+		this->checkNotZombieByControlBlock();
 		return soft_ptr_base_impl<T>::get();
 	}
 
@@ -2017,6 +2394,7 @@ public:
 #endif // NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
 
 		checkNotNullAllSizes( this->getDereferencablePtr() );
+		this->checkNotZombieByControlBlock();
 		return *(this->getDereferencablePtr());
 	}
 
@@ -2027,6 +2405,7 @@ public:
 #endif // NODECPP_MEMORY_SAFETY_DBG_ADD_PTR_LIFECYCLE_INFO
 
 		checkNotNullLargeSize( this->getDereferencablePtr() );
+		this->checkNotZombieByControlBlock();
 		return this->getDereferencablePtr();
 	}
 
@@ -2194,6 +2573,20 @@ public:
 	}
 };
 
+inline
+soft_ptr_base_impl<void>* FirstControlBlock::untypedSoftPtr_( void* softPtr )
+{
+	// data members of soft_ptr_base_impl<T> are of types that do not depend on T, and soft_ptr_impl<T> adds none
+	static_assert( std::is_same<soft_ptr_base_impl<int>::PointersT, soft_ptr_base_impl<void>::PointersT>::value );
+	static_assert( sizeof(soft_ptr_base_impl<int>) == sizeof(soft_ptr_base_impl<void>) );
+	static_assert( alignof(soft_ptr_base_impl<int>) == alignof(soft_ptr_base_impl<void>) );
+	static_assert( sizeof(soft_ptr_impl<int>) == sizeof(soft_ptr_base_impl<int>) );
+	return reinterpret_cast<soft_ptr_base_impl<void>*>( softPtr );
+}
+inline
+void FirstControlBlock::setSoftPtrIdx_( void* softPtr, size_t idx ) { untypedSoftPtr_( softPtr )->setIdx_( idx ); }
+inline
+void FirstControlBlock::invalidateSoftPtr_( void* softPtr ) { untypedSoftPtr_( softPtr )->invalidatePtr(); }
 
 template<class T, class T1>
 soft_ptr_impl<T> soft_ptr_static_cast_impl( soft_ptr_impl<T1> p ) {
@@ -2208,111 +2601,93 @@ soft_ptr_impl<T> soft_ptr_reinterpret_cast_impl( soft_ptr_impl<T1> p ) {
 }
 
 
-template<class T>
-class soft_this_ptr_impl
+// Common part of soft_this_ptr_impl<T> and soft_this_ptr2_impl: a single word with the control block of the object
+// under construction (see make_owning_context). Copy and move constructors take it anew, as they run for a new object,
+// and assignments leave it as is. nullptr means the object is not created by make_owning() (so zeroed memory is safe),
+// NODECPP_SECOND_NULLPTR stands for an object in common heap (see NODECPP_MEMORY_SAFETY_ON_DEMAND)
+class soft_this_ptr_base_impl
 {
+protected:
 	FirstControlBlock* cbPtr = nullptr;
-	uint32_t offset;
-
-public:
-
-	static constexpr memory_safety is_safe = memory_safety::safe;
 
-	soft_this_ptr_impl()
-	{
+	static FirstControlBlock* getCbPtr() noexcept {
+		void* obj = make_owning_context::current();
+		if(obj == NODECPP_SECOND_NULLPTR)
+			return nullptr;
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-		if ( thg_stackPtrForMakeOwningCall == nullptr )
-		{
-			cbPtr = nullptr;
-			offset = 0;
-			return;
-		}
+		else if(obj == nullptr)
+			return reinterpret_cast<FirstControlBlock*>(NODECPP_SECOND_NULLPTR);
 #endif
-		if ( thg_stackPtrForMakeOwningCall != NODECPP_SECOND_NULLPTR )
-		{
-			cbPtr = getControlBlock_(thg_stackPtrForMakeOwningCall);
-			uintptr_t delta = reinterpret_cast<uint8_t*>(this) - reinterpret_cast<uint8_t*>(cbPtr);
-			NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, delta <= UINT32_MAX, "delta = 0x{:x}", delta );
-			offset = (uint32_t)delta;
-		}
 		else
-		{
-			cbPtr = (FirstControlBlock*)(NODECPP_SECOND_NULLPTR);
-			offset = (uint32_t)(-1);
-		}
+			return getControlBlock_(obj);
 	}
 
-	soft_this_ptr_impl( soft_this_ptr_impl& other ) {}
-	soft_this_ptr_impl& operator = ( soft_this_ptr_impl& other ) { return *this; }
+	soft_this_ptr_base_impl() : cbPtr(getCbPtr()) {}
+	soft_this_ptr_base_impl(const soft_this_ptr_base_impl&) : cbPtr(getCbPtr()) {}
+	soft_this_ptr_base_impl(soft_this_ptr_base_impl&&) : cbPtr(getCbPtr()) {}
 
-	soft_this_ptr_impl( soft_this_ptr_impl&& other ) {}
-	soft_this_ptr_impl& operator = ( soft_this_ptr_impl&& other ) { return *this; }
+	soft_this_ptr_base_impl& operator=(const soft_this_ptr_base_impl&) { return *this; }
+	soft_this_ptr_base_impl& operator=(soft_this_ptr_base_impl&&) { return *this; }
 
-	explicit operator bool() const noexcept
-	{
-		return cbPtr != NODECPP_SECOND_NULLPTR;
+	~soft_this_ptr_base_impl() = default;
+
+public:
+
+	static constexpr memory_safety is_safe = memory_safety::safe;
+
+	explicit operator bool() const noexcept {
+		return cbPtr != nullptr;
 	}
+};
+
+
+template<class T>
+class soft_this_ptr_impl : public soft_this_ptr_base_impl
+{
+public:
+
+	soft_this_ptr_impl() = default;
+	soft_this_ptr_impl(const soft_this_ptr_impl&) = default;
+	soft_this_ptr_impl(soft_this_ptr_impl&&) = default;
 
+	soft_this_ptr_impl& operator=(const soft_this_ptr_impl&) = default;
+	soft_this_ptr_impl& operator=(soft_this_ptr_impl&&) = default;
+
+	~soft_this_ptr_impl() = default;
+
+	// unlike soft_this_ptr2_impl, throws for an object not created by make_owning()
 	template<class TT>
-	soft_ptr_impl<TT> getSoftPtr(TT* ptr)
+	soft_ptr_impl<TT> getSoftPtr(TT* ptr) const
 	{
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 		if ( cbPtr == nullptr )
-		{
+			throwPointerOutOfRange();
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		if ( cbPtr == NODECPP_SECOND_NULLPTR )
 			return soft_ptr_impl<TT>( nullptr, ptr );
-		}
 #endif
-		if ( cbPtr == NODECPP_SECOND_NULLPTR )
-			throwPointerOutOfRange();
-		void* allocatedPtr = getAllocatedBlockFromControlBlock_( getAllocatedBlock_(cbPtr) );
-		//return soft_ptr_impl<T>( allocatedPtr, ptr );
-		//FirstControlBlock* cb = cbPtr;
-		FirstControlBlock* cb = reinterpret_cast<FirstControlBlock*>( reinterpret_cast<uint8_t*>(this) - offset );
-		return soft_ptr_impl<TT>( cb, ptr );
-	}
-
-	~soft_this_ptr_impl()
-	{
+		return soft_ptr_impl<TT>( cbPtr, ptr );
 	}
 };
+static_assert( sizeof(soft_this_ptr_impl<int>) == sizeof(void*) );
 
 /**
- * \c soft_this_ptr2_impl has reversed the meanings of \c nullptr and \c NODECPP_SECOND_NULLPTR
- * with respect to \c soft_this_ptr.
+ * \c soft_this_ptr2_impl is a \c soft_this_ptr that returns an empty \c soft_ptr (rather than throwing)
+ * for an object not created by \c make_owning.
  * This is because we need it to be safe when memory is zeroed.
  */ 
-class soft_this_ptr2_impl
+class soft_this_ptr2_impl : public soft_this_ptr_base_impl
 {
-	FirstControlBlock* cbPtr = nullptr;
-
-	static FirstControlBlock* getCbPtr() noexcept {
-		if(thg_stackPtrForMakeOwningCall == NODECPP_SECOND_NULLPTR)
-			return nullptr;
-#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
-		else if(thg_stackPtrForMakeOwningCall == nullptr)
-			return reinterpret_cast<FirstControlBlock*>(NODECPP_SECOND_NULLPTR);
-#endif
-		else
-			return getControlBlock_(thg_stackPtrForMakeOwningCall);
-	}
-
 public:
 
-	static constexpr memory_safety is_safe = memory_safety::safe;
-
-	soft_this_ptr2_impl() : cbPtr(getCbPtr()) {}
-	soft_this_ptr2_impl(const soft_this_ptr2_impl&) : cbPtr(getCbPtr()) {}
-	soft_this_ptr2_impl(soft_this_ptr2_impl&&) : cbPtr(getCbPtr()) {}
+	soft_this_ptr2_impl() = default;
+	soft_this_ptr2_impl(const soft_this_ptr2_impl&) = default;
+	soft_this_ptr2_impl(soft_this_ptr2_impl&&) = default;
 
-	soft_this_ptr2_impl& operator=(const soft_this_ptr2_impl&) { return *this; }
-	soft_this_ptr2_impl& operator=(soft_this_ptr2_impl&&) { return *this; }
+	soft_this_ptr2_impl& operator=(const soft_this_ptr2_impl&) = default;
+	soft_this_ptr2_impl& operator=(soft_this_ptr2_impl&&) = default;
 
 	~soft_this_ptr2_impl() = default;
 
-	explicit operator bool() const noexcept {
-		return cbPtr != nullptr;
-	}
-
 	template<class T>
 	soft_ptr_impl<T> getSoftPtr(T* ptr) const
 	{
@@ -2605,6 +2980,91 @@ nullable_ptr_impl<T> nullable_cast_impl( T* p ) {
 	return nullable_ptr_impl<T>( p );
 }
 
+
+// borrowed_ptr_impl is a soft reference for passing down call chains: unlike soft_ptr_impl, it is never registered
+// at a control block, and thus is neither invalidated nor updated by the owner. This is safe as long as it does not
+// outlive its scope, which is guaranteed by the checker (it is treated as a stack-only type, same as nullable_ptr).
+// Memory of a destroyed object is zombie (not reused) until killAllZombies(), which cannot happen within such a scope.
+// In contrast to nullable_ptr_impl, it keeps the control block, so that a regular soft_ptr can be made of it where
+// a reference is to be stored.
+template<class T>
+class borrowed_ptr_impl
+{
+	template<class TT>
+	friend class borrowed_ptr_impl;
+
+	T* t = nullptr;
+	FirstControlBlock* cb = nullptr; // nullptr for nullptr and for objects in common heap (see NODECPP_MEMORY_SAFETY_ON_DEMAND)
+
+	T* getDereferencablePtr() const { // see soft_ptr_base_impl::checkNotZombieByControlBlock()
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+		if ( cb != nullptr && NODECPP_UNLIKELY( cb->isZombie() ) )
+			throw ::nodecpp::error::zero_pointer_access;
+#elif !defined NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		if ( cb != nullptr && NODECPP_UNLIKELY( cb->isZombie() ) )
+			throw ::nodecpp::error::early_detected_zombie_pointer_access;
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+		return t;
+	}
+
+public:
+	static constexpr memory_safety is_safe = memory_safety::safe;
+
+	borrowed_ptr_impl() {}
+	borrowed_ptr_impl( std::nullptr_t ) {}
+
+	template<class T1>
+	borrowed_ptr_impl( const owning_ptr_impl<T1>& owner ) : t( owner.t.getTypedPtr() ) { // automatic type conversion (if at all possible)
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		if ( owner.isInCommonHeap() )
+			return;
+#endif
+		if ( owner.t.getPtr() != nullptr )
+			cb = getControlBlock_( owner.t.getPtr() );
+	}
+
+	template<class T1>
+	borrowed_ptr_impl( const soft_ptr_impl<T1>& other ) : t( other.getDereferencablePtr() ) { // automatic type conversion (if at all possible)
+		void* allocated = other.getAllocatedPtr();
+		if ( allocated != nullptr )
+			cb = getControlBlock_( allocated );
+	}
+
+	template<class T1>
+	borrowed_ptr_impl( const borrowed_ptr_impl<T1>& other ) : t( other.t ), cb( other.cb ) {}
+	borrowed_ptr_impl( const borrowed_ptr_impl<T>& other ) = default;
+	borrowed_ptr_impl<T>& operator = ( const borrowed_ptr_impl<T>& other ) = default;
+	borrowed_ptr_impl<T>& operator = ( std::nullptr_t ) { t = nullptr; cb = nullptr; return *this; }
+
+	// makes a regular (registered) soft_ptr, e.g. to store it in heap
+	soft_ptr_impl<T> to_soft() const {
+		if ( t == nullptr )
+			return soft_ptr_impl<T>();
+		getDereferencablePtr();
+		// whether dereferencing detects zombies or not, a soft_ptr must never be registered in a control block of a dead object
+		if ( cb != nullptr && NODECPP_UNLIKELY( cb->isZombie() ) )
+			throw ::nodecpp::error::zero_pointer_access;
+		return soft_ptr_impl<T>( cb, t );
+	}
+
+	void swap( borrowed_ptr_impl<T>& other ) {
+		T* tmpT = t; t = other.t; other.t = tmpT;
+		FirstControlBlock* tmpCB = cb; cb = other.cb; other.cb = tmpCB;
+	}
+
+	T& operator * () const { T* ptr = getDereferencablePtr(); checkNotNullAllSizes( ptr ); return *ptr; }
+	T* operator -> () const { T* ptr = getDereferencablePtr(); checkNotNullLargeSize( ptr ); return ptr; }
+
+	explicit operator bool() const noexcept { return t != nullptr; }
+
+	template<class T1>
+	bool operator == ( const borrowed_ptr_impl<T1>& other ) const { return t == other.t; }
+	template<class T1>
+	bool operator != ( const borrowed_ptr_impl<T1>& other ) const { return t != other.t; }
+	bool operator == ( std::nullptr_t ) const { return t == nullptr; }
+	bool operator != ( std::nullptr_t ) const { return t != nullptr; }
+};
+
 } // namespace safememory::detail
 
 #endif // SAFE_PTR_IMPL_H
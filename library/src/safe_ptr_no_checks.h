@@ -45,6 +45,7 @@ template<class T> class soft_ptr_base_no_checks; // forward declaration
 template<class T> class soft_ptr_no_checks; // forward declaration
 template<class T> class soft_this_ptr_no_checks; // forward declaration
 template<class T> class nullable_ptr_no_checks; // forward declaration
+template<class T> class borrowed_ptr_no_checks; // forward declaration
 class soft_this_ptr2_no_checks; // forward declaration
 
 struct fbc_ptr_t {};
@@ -61,6 +62,8 @@ class owning_ptr_base_no_checks
 	friend class soft_ptr_base_no_checks;
 	template<class TT>
 	friend class soft_ptr_no_checks;
+	template<class TT>
+	friend class borrowed_ptr_no_checks;
 
 #ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
 #ifdef NODECPP_SAFE_PTR_DEBUG_MODE
@@ -275,7 +278,6 @@ template<class _Ty,
 	std::enable_if_t<!std::is_array<_Ty>::value, int> = 0>
 NODISCARD owning_ptr_no_checks<_Ty> make_owning_no_checks(_Types&&... _Args)
 {
-	static_assert( alignof(_Ty) <= NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT );
 	uint8_t* data = reinterpret_cast<uint8_t*>( allocate( sizeof(_Ty), alignof(_Ty) ) );
 	NODECPP_ASSERT( nodecpp::foundation::module_id, nodecpp::assert::AssertLevel::pedantic, ((uintptr_t)data & (alignof(_Ty)-1)) == 0, "indeed, alignof(_Ty) = {} and data = 0x{:x}", alignof(_Ty), (uintptr_t)data );
 	auto allocatorID = ::nodecpp::iibmalloc::g_CurrentAllocManager != nullptr ? ::nodecpp::iibmalloc::g_CurrentAllocManager->allocatorID() : 0;
@@ -298,8 +300,6 @@ NODISCARD owning_ptr_no_checks<_Ty> make_owning_no_checks(_Types&&... _Args)
 	return op;
 }
 
-
-
 template<class T>
 class soft_ptr_base_no_checks
 {
@@ -317,6 +317,8 @@ class soft_ptr_base_no_checks
 	friend soft_ptr_no_checks<TT> soft_ptr_reinterpret_cast_no_checks( soft_ptr_no_checks<TT1> );
 
 	friend class safememory::detail::soft_ptr_helper;
+	template<class TT>
+	friend class borrowed_ptr_no_checks;
 
 	T* t;
 
@@ -448,6 +450,8 @@ private:
 	friend soft_ptr_no_checks<T> soft_ptr_in_constructor_no_checks<>(T*);
 
 	friend class safememory::detail::soft_ptr_helper;
+	template<class TT>
+	friend class borrowed_ptr_no_checks;
 
 	soft_ptr_no_checks(fbc_ptr_t cb, T* t) : soft_ptr_base_no_checks<T>(cb, t) {} // to be used for only types annotaded as [[nodecpp::owning_only]]
 
@@ -1016,6 +1020,48 @@ nullable_ptr_no_checks<T> nullable_cast_no_checks( T* p ) {
 	return nullable_ptr_no_checks<T>( p );
 }
 
+
+template<class T>
+class borrowed_ptr_no_checks
+{
+	template<class TT>
+	friend class borrowed_ptr_no_checks;
+
+	T* t = nullptr;
+
+public:
+	static constexpr memory_safety is_safe = memory_safety::none;
+
+	borrowed_ptr_no_checks() {}
+	borrowed_ptr_no_checks( std::nullptr_t ) {}
+
+	template<class T1>
+	borrowed_ptr_no_checks( const owning_ptr_no_checks<T1>& owner ) : t( owner.implGetPtr() ) {}
+	template<class T1>
+	borrowed_ptr_no_checks( const soft_ptr_no_checks<T1>& other ) : t( other.t ) {}
+	template<class T1>
+	borrowed_ptr_no_checks( const borrowed_ptr_no_checks<T1>& other ) : t( other.t ) {}
+	borrowed_ptr_no_checks( const borrowed_ptr_no_checks<T>& other ) = default;
+	borrowed_ptr_no_checks<T>& operator = ( const borrowed_ptr_no_checks<T>& other ) = default;
+	borrowed_ptr_no_checks<T>& operator = ( std::nullptr_t ) { t = nullptr; return *this; }
+
+	soft_ptr_no_checks<T> to_soft() const { return soft_ptr_no_checks<T>( fbc_ptr_t(), t ); }
+
+	void swap( borrowed_ptr_no_checks<T>& other ) { T* tmp = t; t = other.t; other.t = tmp; }
+
+	T& operator * () const { return *t; }
+	T* operator -> () const { return t; }
+
+	explicit operator bool() const noexcept { return t != nullptr; }
+
+	template<class T1>
+	bool operator == ( const borrowed_ptr_no_checks<T1>& other ) const { return t == other.t; }
+	template<class T1>
+	bool operator != ( const borrowed_ptr_no_checks<T1>& other ) const { return t != other.t; }
+	bool operator == ( std::nullptr_t ) const { return t == nullptr; }
+	bool operator != ( std::nullptr_t ) const { return t != nullptr; }
+};
+
 } // namespace safememory::detail
 
 
@@ -0,0 +1,205 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_PTR_POOL_H
+#define SAFE_PTR_POOL_H
+
+#include "safe_ptr.h"
+
+namespace safememory::detail {
+
+// Keeps blocks (with their control blocks) of recycled objects of type T for reuse by make().
+// An object is recycled only if no soft_ptrs to it are registered with its control block (otherwise it is released
+// as by owning_ptr::reset(), that is, soft_ptrs are invalidated and the block goes to the allocator). Control block
+// of a recycled object is zombie, exactly as for a regular deallocation, and the block is quarantined:
+// it becomes available for reuse only at collect(), which is to be called where killAllZombies() would be called
+// (i.e. when no on-stack soft_ptrs and borrowed_ptrs that may still point to recycled objects are alive).
+// NOTE: in on-demand mode the pool serves the allocator that is current at its construction (none, if it is std heap);
+//       it must be destroyed while that allocator is current
+template<class T>
+class object_pool_impl
+{
+	static constexpr size_t head = sizeof(FirstControlBlock) - getPrefixByteCount();
+	static constexpr bool overAligned = FirstControlBlock::isOverAlignedType( alignof(T) );
+	static constexpr size_t embeddedSlotCnt = FirstControlBlock::embeddedSlotCount<T>();
+
+	T* freeList = nullptr;
+	T* quarantineHead = nullptr;
+	T* quarantineTail = nullptr;
+	size_t freeCnt = 0;
+	size_t quarantineCnt = 0;
+	size_t maxCached;
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+	uint16_t allocatorID;
+#endif
+
+	// a block that is not in use keeps a link to the next one in place of the (unused) first slot of its control block
+	static T*& nextOf( T* obj ) { return *reinterpret_cast<T**>( getControlBlock_( obj )->slots ); }
+
+	void deallocateList( T* obj ) {
+		while ( obj != nullptr ) {
+			T* next = nextOf( obj );
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+			zombieDeallocate( getAllocatedBlock_( obj ), allocatorID );
+#else
+			zombieDeallocate( getAllocatedBlock_( obj ) );
+#endif
+			obj = next;
+		}
+	}
+
+public:
+	explicit object_pool_impl( size_t maxCached_ = SIZE_MAX ) : maxCached( maxCached_ ) {
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		allocatorID = g_CurrentAllocManager != nullptr ? g_CurrentAllocManager->allocatorID() : 0;
+#endif
+	}
+	object_pool_impl( const object_pool_impl& ) = delete;
+	object_pool_impl& operator = ( const object_pool_impl& ) = delete;
+	~object_pool_impl() { clear(); }
+
+	size_t free_count() const { return freeCnt; }
+	size_t quarantined_count() const { return quarantineCnt; }
+
+	template<class... _Types>
+	NODISCARD owning_ptr_impl<T> make( _Types&&... _Args ) {
+		if ( freeList == nullptr )
+			return make_owning_impl<T>( ::std::forward<_Types>(_Args)... );
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, g_CurrentAllocManager != nullptr && g_CurrentAllocManager->allocatorID() == allocatorID );
+#endif
+		T* dataForObj = freeList;
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::pedantic, getControlBlock_( dataForObj )->isZombie() );
+		freeList = nextOf( dataForObj );
+		--freeCnt;
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		owning_ptr_impl<T> op( make_owning_t( allocatorID ), dataForObj );
+#else
+		owning_ptr_impl<T> op( make_owning_t(), dataForObj );
+#endif
+		// control block is re-initialized by op's ctor; shift to an over-aligned object is kept in the block
+		if constexpr ( overAligned )
+			getControlBlock_( dataForObj )->setOverAligned();
+		if constexpr ( embeddedSlotCnt != 0 )
+			getControlBlock_( dataForObj )->attachEmbeddedSecondBlock( reinterpret_cast<uint8_t*>( dataForObj ) + FirstControlBlock::embeddedBlockOffset( sizeof(T) ), embeddedSlotCnt );
+		try { 
+			make_owning_context ctx( dataForObj );
+			new ( dataForObj ) T(::std::forward<_Types>(_Args)...);
+			return op;
+		}
+		catch( ... ) {
+			killUnderconsructedOP( op );
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+			zombieDeallocate( getAllocatedBlock_( dataForObj ), allocatorID );
+#else
+			zombieDeallocate( getAllocatedBlock_( dataForObj ) );
+#endif
+			throw;
+		}
+	}
+
+	// destroys the object (p becomes nullptr) and keeps its block for reuse if possible
+	void recycle( owning_ptr_impl<T>&& p ) {
+		T* obj = p.t.getTypedPtr();
+		if ( obj == nullptr )
+			return;
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+		if ( allocatorID == 0 || p.t.allocatorIdx() != allocatorID ) {
+			p.reset();
+			return;
+		}
+#endif
+		destruct( obj );
+		FirstControlBlock* cb = getControlBlock_( obj );
+		if ( cb->hasSoftPtrs() || freeCnt + quarantineCnt >= maxCached ) {
+			p.releaseDestructed();
+			return;
+		}
+		cb->clear();
+		p.t.reset();
+		nextOf( obj ) = nullptr;
+		if ( quarantineTail != nullptr )
+			nextOf( quarantineTail ) = obj;
+		else
+			quarantineHead = obj;
+		quarantineTail = obj;
+		++quarantineCnt;
+	}
+
+	// makes blocks recycled so far available for reuse
+	void collect() {
+		if ( quarantineHead == nullptr )
+			return;
+		nextOf( quarantineTail ) = freeList;
+		freeList = quarantineHead;
+		freeCnt += quarantineCnt;
+		quarantineHead = quarantineTail = nullptr;
+		quarantineCnt = 0;
+	}
+
+	// returns all kept blocks to the allocator
+	void clear() {
+		deallocateList( freeList );
+		deallocateList( quarantineHead );
+		freeList = quarantineHead = quarantineTail = nullptr;
+		freeCnt = quarantineCnt = 0;
+	}
+};
+
+template<class T>
+class object_pool_no_checks
+{
+public:
+	explicit object_pool_no_checks( size_t = SIZE_MAX ) {}
+	object_pool_no_checks( const object_pool_no_checks& ) = delete;
+	object_pool_no_checks& operator = ( const object_pool_no_checks& ) = delete;
+
+	size_t free_count() const { return 0; }
+	size_t quarantined_count() const { return 0; }
+
+	template<class... _Types>
+	NODISCARD owning_ptr_no_checks<T> make( _Types&&... _Args ) { return make_owning_no_checks<T>( ::std::forward<_Types>(_Args)... ); }
+	void recycle( owning_ptr_no_checks<T>&& p ) { p.reset(); }
+	void collect() {}
+	void clear() {}
+};
+
+template<class T, memory_safety is_safe> struct object_pool_type_ { typedef object_pool_impl<T> type; };
+template<class T> struct object_pool_type_<T, memory_safety::none> { typedef object_pool_no_checks<T> type; };
+template<class T> struct object_pool_type_<T, memory_safety::safe> { typedef object_pool_impl<T> type; };
+
+} // namespace safememory::detail
+
+namespace safememory {
+
+// pool of blocks for make_owning()-like creation of objects of a single type with high churn (see object_pool_impl)
+template<class T, memory_safety is_safe = safeness_declarator<T>::is_safe> using object_pool = typename detail::object_pool_type_<T, is_safe>::type;
+
+} // namespace safememory
+
+#endif // SAFE_PTR_POOL_H
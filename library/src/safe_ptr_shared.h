@@ -0,0 +1,375 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_PTR_SHARED_H
+#define SAFE_PTR_SHARED_H
+
+#include "safe_ptr_impl.h"
+#include <atomic>
+#include <new>
+#include <thread>
+
+/*
+	Shared (cross-thread) variant of owning_ptr / soft_ptr.
+
+	Regular soft_ptr_impl registers itself in a slot of FirstControlBlock and is invalidated by the owner at its
+	destruction; this requires all of them to live in the thread of the owner. SharedControlBlock is the shared
+	variant of that control block: it is placed right before the object as well, but its slots are counters
+	that a shared_soft_ptr_impl claims and releases with a single atomic operation, so it can be created, copied
+	and destroyed at any thread. Slots are cache-line-sized and each thread has its own preferred slot, which keeps
+	threads creating many short-lived soft_ptrs to the same (read-mostly) object from contending for a single line.
+
+	As an owner cannot safely write to soft_ptrs of other threads, the death of an object is detected lazily.
+	The object is accessed through a pin (see shared_soft_ptr_impl::pin(), operator-> pins for the duration of
+	the full expression). Taking a pin fails with an exception once the owner is dead. The owner destructs the
+	object at its own thread, as a regular owning_ptr does, but first marks it dead and waits for outstanding
+	pins to be released. Therefore pins must be short-lived, and the owner thread must not hold one itself while
+	destroying the owner.
+
+	Each slot keeps (2 * number of soft_ptrs claiming it) + 1, where the latter is a bias held by the owner;
+	a slot is "closed" when it drops to zero, and a closed slot is never claimed again (when the slot of
+	current thread is closed, a copy claims the slot of its source, which is open while the source exists).
+	Owner death removes biases after destructing the object; the party closing the last open slot releases memory.
+	Pins are counted per slot as well, the soft_ptr taking a pin holds a claim at the same slot.
+*/
+
+namespace safememory::detail
+{
+
+struct SharedControlBlock
+{
+	static constexpr size_t cacheLineSize = 64;
+	static constexpr size_t slotCount = 16;
+	static_assert( slotCount <= cacheLineSize ); // slot index is kept in the lower bits of a SharedControlBlock* in a soft_ptr
+
+	struct alignas(cacheLineSize) Slot
+	{
+		std::atomic<size_t> cnt;
+		std::atomic<size_t> pinCnt;
+	};
+
+	alignas(cacheLineSize) std::atomic<bool> alive; // read by every pin; written once at owner death
+	std::atomic<size_t> openSlotCnt;
+	Slot slots[slotCount];
+
+	void init() {
+		alive.store( true, std::memory_order_relaxed );
+		openSlotCnt.store( slotCount, std::memory_order_relaxed );
+		for ( size_t i=0; i<slotCount; ++i ) {
+			slots[i].cnt.store( 1, std::memory_order_relaxed );
+			slots[i].pinCnt.store( 0, std::memory_order_relaxed );
+		}
+	}
+
+	bool isAlive() const { return alive.load( std::memory_order_acquire ); }
+
+	// s is a slot claimed by the caller; fails if the owner is dead (or is waiting for pins to be released)
+	bool pin( size_t s ) {
+		// mb: seq_cst on both sides: either the owner sees this pin, or we see it is dead
+		slots[s].pinCnt.fetch_add( 1, std::memory_order_seq_cst );
+		if ( NODECPP_LIKELY( alive.load( std::memory_order_seq_cst ) ) )
+			return true;
+		unpin( s );
+		return false;
+	}
+
+	void unpin( size_t s ) {
+		size_t prev = slots[s].pinCnt.fetch_sub( 1, std::memory_order_release );
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, prev != 0 );
+	}
+
+	static size_t currentThreadSlot();
+
+	// claims a slot at creation from an owner (all slots are open while the owner is alive)
+	size_t claim() {
+		size_t s = currentThreadSlot();
+		slots[s].cnt.fetch_add( 2, std::memory_order_relaxed );
+		return s;
+	}
+
+	// claims a slot at copying from a soft_ptr holding slot srcSlot
+	size_t claimCopy( size_t srcSlot ) {
+		size_t s = currentThreadSlot();
+		size_t cnt = slots[s].cnt.load( std::memory_order_relaxed );
+		while ( NODECPP_LIKELY( cnt != 0 ) )
+			if ( slots[s].cnt.compare_exchange_weak( cnt, cnt + 2, std::memory_order_relaxed ) )
+				return s;
+		// closed; the source slot is open while the source exists
+		slots[srcSlot].cnt.fetch_add( 2, std::memory_order_relaxed );
+		return srcSlot;
+	}
+
+	void release( size_t s ) {
+		size_t prev = slots[s].cnt.fetch_sub( 2, std::memory_order_acq_rel );
+		NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, prev >= 2 );
+		if ( NODECPP_UNLIKELY( prev == 2 ) )
+			closeSlot();
+	}
+
+	// to be called by the owner before destructing the object; no pin can be taken after it returns
+	void ownerDying() {
+		alive.store( false, std::memory_order_seq_cst );
+		for ( size_t i=0; i<slotCount; ++i )
+			while ( slots[i].pinCnt.load( std::memory_order_seq_cst ) != 0 )
+				std::this_thread::yield();
+	}
+
+	// to be called after the object is destructed
+	void ownerDied() {
+		for ( size_t i=0; i<slotCount; ++i )
+			if ( slots[i].cnt.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+				closeSlot();
+	}
+
+	void closeSlot() {
+		if ( openSlotCnt.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+			dealloc( this );
+	}
+
+	static SharedControlBlock* alloc( size_t objSz ) {
+		void* ret = ::operator new( sizeof(SharedControlBlock) + objSz, std::align_val_t(cacheLineSize) );
+		return reinterpret_cast<SharedControlBlock*>( ret );
+	}
+	static void dealloc( SharedControlBlock* cb ) {
+		::operator delete( cb, std::align_val_t(cacheLineSize) );
+	}
+
+	void* getObject() { return this + 1; }
+	static SharedControlBlock* fromObject( const void* obj ) { return reinterpret_cast<SharedControlBlock*>( const_cast<void*>( obj ) ) - 1; }
+};
+static_assert( sizeof(SharedControlBlock) % SharedControlBlock::cacheLineSize == 0 );
+
+
+template<class T> class shared_soft_ptr_impl; // forward declaration
+
+template<class T>
+class shared_owning_ptr_impl
+{
+	template<class TT>
+	friend class shared_owning_ptr_impl;
+	template<class TT>
+	friend class shared_soft_ptr_impl;
+
+	T* t = nullptr;
+
+	void do_delete() {
+		if ( t != nullptr ) {
+			SharedControlBlock* cb = SharedControlBlock::fromObject( t );
+			cb->ownerDying();
+			destruct( t );
+			t = nullptr;
+			cb->ownerDied();
+		}
+	}
+
+public:
+	static constexpr memory_safety is_safe = memory_safety::safe;
+
+	shared_owning_ptr_impl( make_owning_t, T* t_ ) : t( t_ ) {} // make it private with a friend make_shared_owning_impl()!
+	shared_owning_ptr_impl() {}
+	shared_owning_ptr_impl( std::nullptr_t ) {}
+	shared_owning_ptr_impl( const shared_owning_ptr_impl<T>& other ) = delete;
+	shared_owning_ptr_impl& operator = ( const shared_owning_ptr_impl<T>& other ) = delete;
+	shared_owning_ptr_impl( shared_owning_ptr_impl<T>&& other ) : t( other.t ) { other.t = nullptr; }
+	shared_owning_ptr_impl& operator = ( shared_owning_ptr_impl<T>&& other ) {
+		if ( this == &other ) return *this;
+		do_delete();
+		t = other.t;
+		other.t = nullptr;
+		return *this;
+	}
+	shared_owning_ptr_impl& operator = ( std::nullptr_t ) { do_delete(); return *this; }
+	~shared_owning_ptr_impl() { do_delete(); }
+
+	void reset() { do_delete(); }
+	void swap( shared_owning_ptr_impl<T>& other ) { T* tmp = t; t = other.t; other.t = tmp; }
+
+	T& operator * () const { checkNotNullAllSizes( t ); return *t; }
+	T* operator -> () const { checkNotNullLargeSize( t ); return t; }
+
+	explicit operator bool() const noexcept { return t != nullptr; }
+	bool operator == ( std::nullptr_t ) const { return t == nullptr; }
+	bool operator != ( std::nullptr_t ) const { return t != nullptr; }
+};
+
+
+/// object pinned through a shared_soft_ptr_impl; the owner does not destruct it while the pin exists
+template<class T>
+class shared_soft_ptr_pin
+{
+	template<class TT>
+	friend class shared_soft_ptr_impl;
+
+	T* t = nullptr;
+	SharedControlBlock* cb = nullptr;
+	size_t slot = 0;
+
+	shared_soft_ptr_pin( T* t_, SharedControlBlock* cb_, size_t slot_ ) : t( t_ ), cb( cb_ ), slot( slot_ ) {}
+
+public:
+	shared_soft_ptr_pin( const shared_soft_ptr_pin<T>& other ) = delete;
+	shared_soft_ptr_pin& operator = ( const shared_soft_ptr_pin<T>& other ) = delete;
+	shared_soft_ptr_pin( shared_soft_ptr_pin<T>&& other ) : t( other.t ), cb( other.cb ), slot( other.slot ) {
+		other.t = nullptr;
+		other.cb = nullptr;
+	}
+	shared_soft_ptr_pin& operator = ( shared_soft_ptr_pin<T>&& other ) = delete;
+	~shared_soft_ptr_pin() {
+		if ( cb != nullptr )
+			cb->unpin( slot );
+	}
+
+	T& operator * () const { checkNotNullAllSizes( t ); return *t; }
+	T* operator -> () const { checkNotNullLargeSize( t ); return t; }
+};
+
+
+template<class T>
+class shared_soft_ptr_impl
+{
+	template<class TT>
+	friend class shared_soft_ptr_impl;
+
+	T* t = nullptr;
+	uintptr_t cbAndSlot = 0; // SharedControlBlock* with a slot index in lower bits
+
+	static constexpr uintptr_t slotMask = SharedControlBlock::cacheLineSize - 1;
+	SharedControlBlock* getControlBlock() const { return reinterpret_cast<SharedControlBlock*>( cbAndSlot & ~slotMask ); }
+	size_t getSlot() const { return cbAndSlot & slotMask; }
+	void set( T* t_, SharedControlBlock* cb, size_t slot ) { t = t_; cbAndSlot = reinterpret_cast<uintptr_t>( cb ) | slot; }
+
+	template<class T1>
+	void copyFrom( const shared_soft_ptr_impl<T1>& other ) {
+		if ( other.cbAndSlot != 0 ) {
+			SharedControlBlock* cb = other.getControlBlock();
+			set( other.t, cb, cb->claimCopy( other.getSlot() ) ); // implicit cast, if at all possible
+		}
+	}
+	void releaseClaim() {
+		if ( cbAndSlot != 0 )
+			getControlBlock()->release( getSlot() );
+		t = nullptr;
+		cbAndSlot = 0;
+	}
+
+public:
+	static constexpr memory_safety is_safe = memory_safety::safe;
+
+	shared_soft_ptr_impl() {}
+	shared_soft_ptr_impl( std::nullptr_t ) {}
+	template<class T1>
+	shared_soft_ptr_impl( const shared_owning_ptr_impl<T1>& owner ) {
+		if ( owner.t != nullptr ) {
+			SharedControlBlock* cb = SharedControlBlock::fromObject( owner.t );
+			set( owner.t, cb, cb->claim() ); // implicit cast, if at all possible
+		}
+	}
+	shared_soft_ptr_impl( const shared_soft_ptr_impl<T>& other ) { copyFrom( other ); }
+	template<class T1>
+	shared_soft_ptr_impl( const shared_soft_ptr_impl<T1>& other ) { copyFrom( other ); }
+	shared_soft_ptr_impl( shared_soft_ptr_impl<T>&& other ) : t( other.t ), cbAndSlot( other.cbAndSlot ) {
+		other.t = nullptr;
+		other.cbAndSlot = 0;
+	}
+	shared_soft_ptr_impl& operator = ( const shared_soft_ptr_impl<T>& other ) {
+		if ( this == &other ) return *this;
+		shared_soft_ptr_impl<T> tmp( other );
+		swap( tmp );
+		return *this;
+	}
+	shared_soft_ptr_impl& operator = ( shared_soft_ptr_impl<T>&& other ) {
+		if ( this == &other ) return *this;
+		releaseClaim();
+		swap( other );
+		return *this;
+	}
+	template<class T1>
+	shared_soft_ptr_impl& operator = ( const shared_owning_ptr_impl<T1>& owner ) {
+		shared_soft_ptr_impl<T> tmp( owner );
+		swap( tmp );
+		return *this;
+	}
+	shared_soft_ptr_impl& operator = ( std::nullptr_t ) { releaseClaim(); return *this; }
+	~shared_soft_ptr_impl() { releaseClaim(); }
+
+	void reset() { releaseClaim(); }
+	void swap( shared_soft_ptr_impl<T>& other ) {
+		T* tmpT = t; t = other.t; other.t = tmpT;
+		uintptr_t tmp = cbAndSlot; cbAndSlot = other.cbAndSlot; other.cbAndSlot = tmp;
+	}
+
+	// throws if the owner is dead; the pin must be released soon, as the owner waits for it to destruct the object
+	shared_soft_ptr_pin<T> pin() const {
+		if ( cbAndSlot == 0 )
+			return shared_soft_ptr_pin<T>( t, nullptr, 0 );
+		SharedControlBlock* cb = getControlBlock();
+		if ( NODECPP_UNLIKELY( !cb->pin( getSlot() ) ) )
+			throw ::nodecpp::error::zero_pointer_access;
+		return shared_soft_ptr_pin<T>( t, cb, getSlot() );
+	}
+
+	// NOTE: there is no operator * returning a reference, as nothing would keep the object from being destructed
+	shared_soft_ptr_pin<T> operator -> () const { return pin(); } // pinned till the end of the full expression
+
+	// NOTE: a pointer to a destroyed object is still non-null (its death is only detected on pin)
+	explicit operator bool() const noexcept { return t != nullptr; }
+	bool operator == ( std::nullptr_t ) const { return t == nullptr; }
+	bool operator != ( std::nullptr_t ) const { return t != nullptr; }
+	template<class T1>
+	bool operator == ( const shared_soft_ptr_impl<T1>& other ) const { return t == other.t; }
+	template<class T1>
+	bool operator != ( const shared_soft_ptr_impl<T1>& other ) const { return t != other.t; }
+};
+
+
+template<class _Ty,
+	class... _Types,
+	std::enable_if_t<!std::is_array<_Ty>::value, int> = 0>
+NODISCARD shared_owning_ptr_impl<_Ty> make_shared_owning_impl(_Types&&... _Args)
+{
+	static_assert( alignof(_Ty) <= SharedControlBlock::cacheLineSize );
+	SharedControlBlock* cb = SharedControlBlock::alloc( sizeof(_Ty) );
+	cb->init();
+	void* dataForObj = cb->getObject();
+	try {
+		new ( dataForObj ) _Ty(::std::forward<_Types>(_Args)...);
+	}
+	catch (...) {
+		SharedControlBlock::dealloc( cb );
+		throw;
+	}
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+	return shared_owning_ptr_impl<_Ty>( make_owning_t(0), reinterpret_cast<_Ty*>( dataForObj ) );
+#else
+	return shared_owning_ptr_impl<_Ty>( make_owning_t(), reinterpret_cast<_Ty*>( dataForObj ) );
+#endif
+}
+
+} // namespace safememory::detail
+
+#endif // SAFE_PTR_SHARED_H
@@ -0,0 +1,102 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_PTR_STACK_BOUNDS_H
+#define SAFE_PTR_STACK_BOUNDS_H
+
+#include "safe_ptr_common.h"
+
+/*
+	Detection of pointers to the stack of current thread (used by the on-stack soft_ptr optimization).
+
+	Bounds of the stack are obtained once per thread (pthread_getattr_np() on Linux, GetCurrentThreadStackLimits()
+	on Windows) and cached in a trivial thread_local, so that a check is two loads and a compare.
+	A false negative is always safe (a soft_ptr is then just registered as a regular one), while a false positive is not;
+	therefore, if bounds cannot be obtained, nothing is reported as being on stack.
+
+	Code running on its own stacks (fibers, stackful coroutines) should report a switch of stacks via
+	setCurrentStackBounds() (or stack_bounds_scope); otherwise objects on such stacks are just not recognized as on-stack ones.
+*/
+
+namespace safememory::detail {
+
+struct StackBounds
+{
+	uintptr_t lo; // lowest address of the stack
+	uintptr_t hi; // one past the highest address; 0 if not yet initialized
+};
+static_assert( std::is_trivial<StackBounds>::value ); // zero-initialized thread_local, no dynamic init
+extern thread_local StackBounds thg_stackBounds;
+
+// fills thg_stackBounds with bounds of the stack of current thread (or with an empty range, if not available)
+NODECPP_NOINLINE void initThreadStackBounds();
+
+NODECPP_FORCEINLINE bool isGuaranteedOnStack( const void* ptr )
+{
+	StackBounds& bounds = thg_stackBounds;
+	if ( NODECPP_UNLIKELY( bounds.hi == 0 ) )
+		initThreadStackBounds();
+	return reinterpret_cast<uintptr_t>( ptr ) - bounds.lo < bounds.hi - bounds.lo;
+}
+
+inline StackBounds getCurrentStackBounds()
+{
+	if ( thg_stackBounds.hi == 0 )
+		initThreadStackBounds();
+	return thg_stackBounds;
+}
+
+// to be called by fiber/coroutine schedulers when switching to another stack; returns bounds being replaced
+inline StackBounds setCurrentStackBounds( void* lo, void* hi )
+{
+	NODECPP_ASSERT(safememory::module_id, nodecpp::assert::AssertLevel::critical, lo < hi );
+	StackBounds prev = getCurrentStackBounds();
+	thg_stackBounds.lo = reinterpret_cast<uintptr_t>( lo );
+	thg_stackBounds.hi = reinterpret_cast<uintptr_t>( hi );
+	return prev;
+}
+
+inline void setCurrentStackBounds( StackBounds bounds )
+{
+	thg_stackBounds = bounds;
+}
+
+// RAII helper to run a piece of code on a stack other than the thread's one
+class stack_bounds_scope
+{
+	StackBounds prev;
+public:
+	stack_bounds_scope( void* lo, void* hi ) : prev( setCurrentStackBounds( lo, hi ) ) {}
+	stack_bounds_scope( const stack_bounds_scope& ) = delete;
+	stack_bounds_scope& operator = ( const stack_bounds_scope& ) = delete;
+	~stack_bounds_scope() { setCurrentStackBounds( prev ); }
+};
+
+} // namespace safememory::detail
+
+#endif // SAFE_PTR_STACK_BOUNDS_H
@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#ifndef SAFE_PTR_ZOMBIE_BITMAP_H
+#define SAFE_PTR_ZOMBIE_BITMAP_H
+
+#include <foundation.h>
+#include <nodecpp_assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "memory_safety.h"
+
+/*
+	Index of zombie memory for the new/delete fallback allocator (used for early detection of zombie access).
+
+	Memory is split into 8-byte granules, and a granule is marked if any byte of it belongs to a zombie block.
+	Since blocks returned by operator new are at least 8-byte aligned, a granule never contains bytes of both
+	a zombie block and a live one, so the answer is exact for any pointer into a live or a zombie block.
+
+	Bits live in a three-level radix tree (root -> mid -> leaf) covering 47 bits of address space; a leaf
+	covers 2MB and is allocated on first use. Lookup is at most three dependent loads with no search;
+	marking a block touches only the bits of its own granules and allocates nothing per block.
+*/
+
+namespace safememory::detail {
+
+class ZombieBitmap
+{
+	static constexpr size_t granuleBits = 3;
+	static constexpr size_t leafBits = 18;
+	static constexpr size_t midBits = 14;
+	static constexpr size_t rootBits = 12;
+	static constexpr size_t addressBits = granuleBits + leafBits + midBits + rootBits;
+	static constexpr uint64_t leafMask = ( uint64_t(1) << leafBits ) - 1;
+	static constexpr uint64_t midMask = ( uint64_t(1) << midBits ) - 1;
+
+	struct Leaf { uint64_t bits[ ( size_t(1) << leafBits ) / 64 ]; };
+	struct Mid { Leaf* leaves[ size_t(1) << midBits ]; };
+
+	// NOTE: no constructors; instances are zero-initialized thread_locals
+	Mid** root;
+	size_t blockCount;
+
+	static void setBits( Leaf* leaf, size_t from, size_t to, bool set ) // [from, to)
+	{
+		while ( from < to )
+		{
+			size_t wordIx = from >> 6;
+			size_t bitFrom = from & 63;
+			size_t bitTo = to - ( wordIx << 6 ) < 64 ? to - ( wordIx << 6 ) : 64;
+			uint64_t mask = ( bitTo == 64 ? ~uint64_t(0) : ( ( uint64_t(1) << bitTo ) - 1 ) ) & ~( ( uint64_t(1) << bitFrom ) - 1 );
+			if ( set )
+				leaf->bits[wordIx] |= mask;
+			else
+				leaf->bits[wordIx] &= ~mask;
+			from = ( wordIx + 1 ) << 6;
+		}
+	}
+
+	void setRange( const void* begin, size_t sz, bool set )
+	{
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::pedantic, sz != 0 );
+		uint64_t g = uint64_t( reinterpret_cast<uintptr_t>( begin ) ) >> granuleBits;
+		uint64_t gEnd = ( ( uint64_t( reinterpret_cast<uintptr_t>( begin ) ) + sz - 1 ) >> granuleBits ) + 1;
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::critical, ( ( gEnd - 1 ) >> ( addressBits - granuleBits ) ) == 0, "address 0x{:x} is out of range", (uintptr_t)begin );
+		if ( root == nullptr )
+			root = new Mid*[ size_t(1) << rootBits ]();
+		while ( g < gEnd )
+		{
+			Mid*& mid = root[ g >> ( leafBits + midBits ) ];
+			if ( mid == nullptr )
+				mid = new Mid();
+			Leaf*& leaf = mid->leaves[ ( g >> leafBits ) & midMask ];
+			if ( leaf == nullptr )
+				leaf = new Leaf();
+			uint64_t leafEnd = ( g | leafMask ) + 1;
+			uint64_t to = gEnd < leafEnd ? gEnd : leafEnd;
+			setBits( leaf, g & leafMask, ( ( to - 1 ) & leafMask ) + 1, set );
+			g = to;
+		}
+	}
+
+public:
+	void mark( const void* begin, size_t sz ) { setRange( begin, sz, true ); ++blockCount; }
+	void unmark( const void* begin, size_t sz ) { 
+		NODECPP_ASSERT( safememory::module_id, nodecpp::assert::AssertLevel::pedantic, blockCount != 0 );
+		setRange( begin, sz, false );
+		--blockCount;
+	}
+
+	NODECPP_FORCEINLINE bool isMarked( const void* ptr ) const
+	{
+		if ( root == nullptr )
+			return false;
+		uint64_t g = uint64_t( reinterpret_cast<uintptr_t>( ptr ) ) >> granuleBits; // 64-bit, as shifts below exceed 32 bits
+		if ( NODECPP_UNLIKELY( ( g >> ( addressBits - granuleBits ) ) != 0 ) )
+			return false; // never marked
+		const Mid* mid = root[ g >> ( leafBits + midBits ) ];
+		if ( mid == nullptr )
+			return false;
+		const Leaf* leaf = mid->leaves[ ( g >> leafBits ) & midMask ];
+		if ( leaf == nullptr )
+			return false;
+		size_t ix = g & leafMask;
+		return ( leaf->bits[ ix >> 6 ] >> ( ix & 63 ) ) & 1;
+	}
+
+	bool empty() const { return blockCount == 0; }
+
+	// releases all memory of the index
+	void clear()
+	{
+		if ( root != nullptr )
+		{
+			for ( size_t i=0; i<(size_t(1) << rootBits); ++i )
+				if ( root[i] != nullptr )
+				{
+					for ( size_t j=0; j<(size_t(1) << midBits); ++j )
+						delete root[i]->leaves[j];
+					delete root[i];
+				}
+			delete [] root;
+			root = nullptr;
+		}
+		blockCount = 0;
+	}
+};
+static_assert( std::is_trivial<ZombieBitmap>::value ); // zero-initialized thread_local, no dynamic init
+
+} // namespace safememory::detail
+
+#endif // SAFE_PTR_ZOMBIE_BITMAP_H
@@ -0,0 +1,258 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) Electronic Arts Inc. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "EASTLBenchmark.h"
+#include "EASTLTest.h"
+#include "EAStopwatch.h"
+#include <EASTL/algorithm.h>
+#include <EASTL/deque.h>
+#include <EASTL/vector.h>
+#include <EASTL/bonus/ring_buffer.h>
+#include <safememory/deque.h>
+#include <safememory/ring_buffer.h>
+#include <safememory/vector.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace EA;
+using EA::StdC::Stopwatch;
+
+
+namespace
+{
+	// event queue operations, a vector can only be used as a queue with erase(begin())
+	template <typename Container>
+	void PopFront(Container& c) { c.pop_front(); }
+
+	template <typename T, safememory::memory_safety Safety>
+	void PopFront(safememory::vector<T, Safety>& c) { c.erase(c.begin()); }
+
+
+	// bounded queue, a ring_buffer overwrites the oldest element by itself
+	template <typename Container>
+	void InitBounded(Container& c, size_t capacity) { c.set_capacity((typename Container::size_type)capacity); }
+
+	template <typename T, safememory::memory_safety Safety>
+	void InitBounded(safememory::deque<T, Safety>& c, size_t capacity) { c.reserve((typename safememory::deque<T, Safety>::size_type)capacity); }
+
+	template <typename Container>
+	void PushBounded(Container& c, size_t, uint64_t value) { c.push_back(value); }
+
+	template <typename T, safememory::memory_safety Safety>
+	void PushBounded(safememory::deque<T, Safety>& c, size_t capacity, uint64_t value)
+	{
+		if(c.size() == capacity)
+			c.pop_front();
+		c.push_back(value);
+	}
+
+
+	template <typename Container>
+	void TestPushBack(EA::StdC::Stopwatch& stopwatch, Container& c, eastl::vector<uint32_t>& intVector)
+	{
+		stopwatch.Restart();
+		for(size_t j = 0, jEnd = intVector.size(); j < jEnd; j++)
+			c.push_back((uint64_t)intVector[j]);
+		stopwatch.Stop();
+	}
+
+
+	template <typename Container>
+	void TestBracket(EA::StdC::Stopwatch& stopwatch, Container& c, eastl::vector<uint32_t>& intVector)
+	{
+		uint64_t temp = 0;
+		stopwatch.Restart();
+		for(size_t j = 0, jEnd = intVector.size(); j < jEnd; j++)
+			temp += c[intVector[j]];
+		stopwatch.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)(temp & 0xffffffff));
+	}
+
+
+	template <typename Container>
+	void TestIteration(EA::StdC::Stopwatch& stopwatch, Container& c)
+	{
+		uint64_t temp = 0;
+		stopwatch.Restart();
+		for(auto it = c.begin(), itEnd = c.end(); it != itEnd; ++it)
+			temp += *it;
+		stopwatch.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)(temp & 0xffffffff));
+	}
+
+
+	/// steady state event queue, \p depth elements waiting at all times
+	template <typename Container>
+	void TestPushPop(EA::StdC::Stopwatch& stopwatch, Container& c, eastl::vector<uint32_t>& intVector, size_t depth)
+	{
+		for(size_t j = 0; j < depth; j++)
+			c.push_back((uint64_t)j);
+
+		uint64_t temp = 0;
+		stopwatch.Restart();
+		for(size_t j = 0, jEnd = intVector.size(); j < jEnd; j++)
+		{
+			c.push_back((uint64_t)intVector[j]);
+			temp += c.front();
+			PopFront(c);
+		}
+		stopwatch.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)(temp & 0xffffffff));
+	}
+
+
+	template <typename Container>
+	void TestPushBounded(EA::StdC::Stopwatch& stopwatch, Container& c, eastl::vector<uint32_t>& intVector, size_t capacity)
+	{
+		InitBounded(c, capacity);
+
+		uint64_t temp = 0;
+		stopwatch.Restart();
+		for(size_t j = 0, jEnd = intVector.size(); j < jEnd; j++)
+		{
+			PushBounded(c, capacity, (uint64_t)intVector[j]);
+			temp += c.front();
+		}
+		stopwatch.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)(temp & 0xffffffff));
+	}
+
+} // namespace
+
+
+template<int IX, template<typename> typename Queue> 
+void BenchmarkDequeTempl()
+{
+	RandGenT<uint32_t> rng(GetRandSeed());
+	Stopwatch              stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	eastl::vector<uint32_t> intVector(100000);
+	eastl::generate(intVector.begin(), intVector.end(), [&]() { return rng(100000); });
+
+	for(int i = 0; i < 2; i++)
+	{
+		Queue<uint64_t> queueUint64;
+
+
+		///////////////////////////////
+		// Test push_back
+		///////////////////////////////
+
+		TestPushBack(stopwatch1, queueUint64, intVector);
+
+		if(i == 1)
+			Benchmark::AddResult("deque<uint64>/push_back", IX, stopwatch1);
+
+
+		///////////////////////////////
+		// Test operator[].
+		///////////////////////////////
+
+		TestBracket(stopwatch1, queueUint64, intVector);
+
+		if(i == 1)
+			Benchmark::AddResult("deque<uint64>/operator[]", IX, stopwatch1);
+
+
+		///////////////////////////////
+		// Test iteration
+		///////////////////////////////
+
+		TestIteration(stopwatch1, queueUint64);
+
+		if(i == 1)
+			Benchmark::AddResult("deque<uint64>/iteration", IX, stopwatch1);
+
+
+		///////////////////////////////
+		// Test push_back / pop_front
+		///////////////////////////////
+
+		Queue<uint64_t> eventQueue;
+
+		TestPushPop(stopwatch1, eventQueue, intVector, 64);
+
+		if(i == 1)
+			Benchmark::AddResult("deque<uint64>/push_back+pop_front", IX, stopwatch1);
+	}
+}
+
+
+template<int IX, template<typename> typename Ring> 
+void BenchmarkRingBufferTempl()
+{
+	RandGenT<uint32_t> rng(GetRandSeed());
+	Stopwatch              stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	eastl::vector<uint32_t> intVector(100000);
+	eastl::generate(intVector.begin(), intVector.end(), [&]() { return rng(100000); });
+
+	for(int i = 0; i < 2; i++)
+	{
+		Ring<uint64_t> ringUint64;
+
+		///////////////////////////////
+		// Test push_back when full
+		///////////////////////////////
+
+		TestPushBounded(stopwatch1, ringUint64, intVector, 64);
+
+		if(i == 1)
+			Benchmark::AddResult("ring_buffer<uint64>/push_back", IX, stopwatch1);
+
+
+		///////////////////////////////
+		// Test push_back / pop_front
+		///////////////////////////////
+
+		Ring<uint64_t> eventQueue;
+		InitBounded(eventQueue, 128);
+
+		TestPushPop(stopwatch1, eventQueue, intVector, 64);
+
+		if(i == 1)
+			Benchmark::AddResult("ring_buffer<uint64>/push_back+pop_front", IX, stopwatch1);
+	}
+}
+
+template<class T>
+using EaDeque = eastl::deque<T>;
+
+template<class T>
+using UnsafeDeque = safememory::deque<T, safememory::memory_safety::none>;
+
+template<class T>
+using SafeDeque = safememory::deque<T, safememory::memory_safety::safe>;
+
+template<class T>
+using SafeVecQueue = safememory::vector<T, safememory::memory_safety::safe>;
+
+template<class T>
+using EaRingBuffer = eastl::ring_buffer<T, eastl::vector<T>>;
+
+template<class T>
+using UnsafeRingBuffer = safememory::ring_buffer<T, safememory::memory_safety::none>;
+
+template<class T>
+using SafeRingBuffer = safememory::ring_buffer<T, safememory::memory_safety::safe>;
+
+
+void BenchmarkDeque()
+{
+	EASTLTest_Printf("Deque\n");
+
+	BenchmarkDequeTempl<1, EaDeque>();
+	BenchmarkDequeTempl<2, UnsafeDeque>();
+	BenchmarkDequeTempl<3, SafeDeque>();
+	BenchmarkDequeTempl<4, SafeVecQueue>();
+
+	// the last column is a safe deque popping by hand when full
+	BenchmarkRingBufferTempl<1, EaRingBuffer>();
+	BenchmarkRingBufferTempl<2, UnsafeRingBuffer>();
+	BenchmarkRingBufferTempl<3, SafeRingBuffer>();
+	BenchmarkRingBufferTempl<4, SafeDeque>();
+}
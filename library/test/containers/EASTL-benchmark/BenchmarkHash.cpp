@@ -8,6 +8,7 @@
 #include "EAStopwatch.h"
 // #include <EASTL/vector.h>
 #include <safememory/unordered_map.h>
+#include <safememory/flat_hash_map.h>
 #include <safememory/algorithm.h>
 #include <EASTL/unordered_map.h>
 #include <EASTL/vector.h>
@@ -272,11 +273,14 @@ namespace
 
 
 template<int IX, template<typename, typename> typename Map1, template<typename, typename, typename> typename Map2>
-void BenchmarkHashTempl()
+void BenchmarkHashTempl(const char* mapName = "unordered_map")
 {
 	EASTLTest_Rand  rng(GetRandSeed());
 	EA::StdC::Stopwatch stopwatch1(EA::StdC::Stopwatch::kUnitsCPUCycles);
 
+	// results of different map kinds go to separate rows
+	auto name = [mapName](const char* test) { return eastl::string(mapName) + test; };
+
 	std::size_t sz = 10000;
 	eastl::vector<uint32_t> baseData(sz);
 	for(std::size_t i = 0; i != sz; ++i) {
@@ -321,12 +325,12 @@ void BenchmarkHashTempl()
 		TestInsertEA<Vt1>(stopwatch1, stdMapUint32TO, stdVectorUT);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/insert", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/insert").c_str(), IX, stopwatch1);
 
 		TestInsertEA<Vt2>(stopwatch1, stdMapStrUint32, stdVectorSU);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/insert", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/insert").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -336,12 +340,12 @@ void BenchmarkHashTempl()
 		TestIteration(stopwatch1, stdMapUint32TO, Vt1(9999999, 9999999));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/iteration", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/iteration").c_str(), IX, stopwatch1);
 
 		TestIteration(stopwatch1, stdMapStrUint32, Vt2(eastl::string("9999999"), eastl::string("9999999")));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/iteration", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/iteration").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -351,12 +355,12 @@ void BenchmarkHashTempl()
 		TestBracket(stopwatch1, stdMapUint32TO, stdVectorUT.data(), stdVectorUT.data() + stdVectorUT.size());
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/operator[]", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/operator[]").c_str(), IX, stopwatch1);
 
 		TestBracket(stopwatch1, stdMapStrUint32, stdVectorSU.data(), stdVectorSU.data() + stdVectorSU.size());
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/operator[]", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/operator[]").c_str(), IX, stopwatch1);
 
 		///////////////////////////////
 		// Test operator[]
@@ -365,12 +369,12 @@ void BenchmarkHashTempl()
 		TestBracket2(stopwatch1, stdMapUint32TO, uint32_t(0));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/operator[]2", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/operator[]2").c_str(), IX, stopwatch1);
 
 		TestBracket2(stopwatch1, stdMapStrUint32, eastl::string("0"));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/operator[]2", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/operator[]2").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -380,12 +384,12 @@ void BenchmarkHashTempl()
 		TestFind(stopwatch1, stdMapUint32TO, stdVectorUT.data(), stdVectorUT.data() + stdVectorUT.size());
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/find", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/find").c_str(), IX, stopwatch1);
 
 		TestFind(stopwatch1, stdMapStrUint32, stdVectorSU.data(), stdVectorSU.data() + stdVectorSU.size());
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/find", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/find").c_str(), IX, stopwatch1);
 
 		///////////////////////////////
 		// Test find
@@ -394,12 +398,12 @@ void BenchmarkHashTempl()
 		TestFind2(stopwatch1, stdMapUint32TO, uint32_t(0));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/find2", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/find2").c_str(), IX, stopwatch1);
 
 		TestFind2(stopwatch1, stdMapStrUint32, eastl::string("0"));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/find2", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/find2").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -410,7 +414,7 @@ void BenchmarkHashTempl()
 		// TestFindAsEa(stopwatch2, eaMapStrUint32,    eaVectorSU.data(),  eaVectorSU.data() +  eaVectorSU.size());
 
 		// if(i == 1)
-		// 	Benchmark::AddResult("unordered_map<string, string>/find_as/char*", IX, stopwatch1);
+		// 	Benchmark::AddResult(name("<string, string>/find_as/char*").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -420,12 +424,12 @@ void BenchmarkHashTempl()
 		TestCount(stopwatch1, stdMapUint32TO, stdVectorUT.data(), stdVectorUT.data() + stdVectorUT.size());
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/count", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/count").c_str(), IX, stopwatch1);
 
 		TestCount(stopwatch1, stdMapStrUint32, stdVectorSU.data(), stdVectorSU.data() + stdVectorSU.size());
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/count", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/count").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -435,12 +439,12 @@ void BenchmarkHashTempl()
 		TestEraseValue(stopwatch1, stdMapUint32TO, stdVectorUT.data(), stdVectorUT.data() + (stdVectorUT.size() / 2));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/erase val", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/erase val").c_str(), IX, stopwatch1);
 
 		TestEraseValue(stopwatch1, stdMapStrUint32, stdVectorSU.data(), stdVectorSU.data() + (stdVectorSU.size() / 2));
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/erase val", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/erase val").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -450,12 +454,12 @@ void BenchmarkHashTempl()
 		TestErasePosition(stopwatch1, stdMapUint32TO);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/erase pos", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/erase pos").c_str(), IX, stopwatch1);
 
 		TestErasePosition(stopwatch1, stdMapStrUint32);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/erase pos", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/erase pos").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -465,12 +469,12 @@ void BenchmarkHashTempl()
 		TestEraseRange(stopwatch1, stdMapUint32TO);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/erase range", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/erase range").c_str(), IX, stopwatch1);
 
 		TestEraseRange(stopwatch1, stdMapStrUint32);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/erase range", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/erase range").c_str(), IX, stopwatch1);
 
 
 		///////////////////////////////
@@ -489,12 +493,12 @@ void BenchmarkHashTempl()
 		TestClear(stopwatch1, stdMapUint32TO);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<uint32_t, uint32_t>/clear", IX, stopwatch1);
+			Benchmark::AddResult(name("<uint32_t, uint32_t>/clear").c_str(), IX, stopwatch1);
 
 		TestClear(stopwatch1, stdMapStrUint32);
 
 		if(i == 1)
-			Benchmark::AddResult("unordered_map<string, string>/clear", IX, stopwatch1);
+			Benchmark::AddResult(name("<string, string>/clear").c_str(), IX, stopwatch1);
 
 	}
 }
@@ -529,6 +533,18 @@ using ReallySafeMap1 = safememory::unordered_map_safe<K, V, eastl::hash<K>, east
 template<class K, class V, class H>
 using ReallySafeMap2 = safememory::unordered_map_safe<K, V, H, eastl::equal_to<K>, safememory::memory_safety::safe>;
 
+template<class K, class V>
+using UnsafeFlatMap1 = safememory::flat_hash_map<K, V, eastl::hash<K>, eastl::equal_to<K>, safememory::memory_safety::none>;
+
+template<class K, class V, class H>
+using UnsafeFlatMap2 = safememory::flat_hash_map<K, V, H, eastl::equal_to<K>, safememory::memory_safety::none>;
+
+template<class K, class V>
+using SafeFlatMap1 = safememory::flat_hash_map<K, V, eastl::hash<K>, eastl::equal_to<K>, safememory::memory_safety::safe>;
+
+template<class K, class V, class H>
+using SafeFlatMap2 = safememory::flat_hash_map<K, V, H, eastl::equal_to<K>, safememory::memory_safety::safe>;
+
 void BenchmarkHash()
 {
 	EASTLTest_Printf("HashMap\n");
@@ -538,5 +554,10 @@ void BenchmarkHash()
 	BenchmarkHashTempl<2, UnsafeMap1, UnsafeMap2>();
 	BenchmarkHashTempl<3, SafeMap1, SafeMap2>();
 	BenchmarkHashTempl<4, ReallySafeMap1, ReallySafeMap2>();
+
+	// flat_hash_map against current safe unordered_map
+	BenchmarkHashTempl<1, SafeMap1, SafeMap2>("flat_hash_map");
+	BenchmarkHashTempl<2, UnsafeFlatMap1, UnsafeFlatMap2>("flat_hash_map");
+	BenchmarkHashTempl<3, SafeFlatMap1, SafeFlatMap2>("flat_hash_map");
 }
 
@@ -0,0 +1,571 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2021, OLogN Technologies AG
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "EASTLBenchmark.h"
+#include "EASTLTest.h"
+#include "EAStopwatch.h"
+#include <safememory/safe_ptr.h>
+#include <safememory/vector.h>
+#include "../../../src/zombie_bitmap.h"
+
+#include <stdio.h>
+#include <map>
+#include <thread>
+#include <vector>
+
+
+using namespace EA;
+using EA::StdC::Stopwatch;
+using safememory::memory_safety;
+
+
+namespace
+{
+	struct Payload
+	{
+		uint64_t mData[4];
+	};
+
+
+	// soft_ptrs are intentionally kept in a heap array, so that each of them
+	// gets registered at the control block of the owned object
+	template <typename OwningPtr, typename SoftPtr>
+	void TestSoftPtrCopyDestroy(Stopwatch& stopwatch, const OwningPtr& op, SoftPtr* sps, size_t liveCount, size_t repeatCount)
+	{
+		stopwatch.Restart();
+		for(size_t j = 0; j < repeatCount; ++j)
+		{
+			for(size_t k = 0; k < liveCount; ++k)
+				sps[k] = op;
+			for(size_t k = 0; k < liveCount; ++k)
+				sps[k] = nullptr;
+		}
+		stopwatch.Stop();
+	}
+
+
+	// soft_ptrs are spread over memory and registered in an order different from memory order,
+	// as it usually happens for soft_ptrs living in other heap objects
+	template <typename SoftPtr>
+	struct SoftPtrHolder
+	{
+		SoftPtr sp;
+		uint8_t mPad[120];
+	};
+
+
+	template <typename OwningPtr, typename Holder, typename MakeOwning>
+	void TestOwningPtrTeardown(Stopwatch& stopwatch, MakeOwning makeOwning, Holder* holders, size_t softCount, size_t repeatCount)
+	{
+		const size_t step = 7919; // prime, to scatter registration order over holders
+		stopwatch.Reset();
+		for(size_t j = 0; j < repeatCount; ++j)
+		{
+			OwningPtr op = makeOwning();
+			for(size_t k = 0; k < softCount; ++k)
+				holders[(k * step) % softCount].sp = op;
+
+			stopwatch.Start();
+			op = nullptr;
+			stopwatch.Stop();
+
+			for(size_t k = 0; k < softCount; ++k)
+				holders[k].sp = nullptr;
+		}
+	}
+
+
+	// each thread makes its own copies of a soft_ptr to an object shared between threads
+	template <typename SoftPtr>
+	void TestSharedSoftPtrCopyDestroy(Stopwatch& stopwatch, const SoftPtr& sp, size_t threadCount, size_t repeatCount)
+	{
+		std::vector<std::thread> threads;
+		stopwatch.Restart();
+		for(size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back([&sp, repeatCount]()
+			{
+				SoftPtr sps[4];
+				for(size_t j = 0; j < repeatCount; ++j)
+				{
+					for(size_t k = 0; k < 4; ++k)
+						sps[k] = sp;
+					for(size_t k = 0; k < 4; ++k)
+						sps[k] = nullptr;
+				}
+			});
+		}
+		for(auto& t : threads)
+			t.join();
+		stopwatch.Stop();
+	}
+
+
+	// same check as dezombiefy() does for each pointer
+	template <typename IsNotZombie>
+	void TestDezombiefy(Stopwatch& stopwatch, IsNotZombie isNotZombie, uint8_t** ptrs, size_t ptrCount, size_t repeatCount)
+	{
+		size_t liveCount = 0;
+		stopwatch.Restart();
+		for(size_t j = 0; j < repeatCount; ++j)
+		{
+			for(size_t k = 0; k < ptrCount; ++k)
+				liveCount += isNotZombie(ptrs[k]);
+		}
+		stopwatch.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)liveCount);
+	}
+
+
+	// each node creates its child from within its constructor, so make_owning calls are nested depth times
+	template <memory_safety is_safe>
+	struct NestedNode
+	{
+		safememory::soft_this_ptr<NestedNode, is_safe> myThis;
+		safememory::soft_ptr<NestedNode, is_safe> parent;
+		safememory::owning_ptr<NestedNode, is_safe> child;
+		size_t depth;
+
+		NestedNode(size_t depth_, safememory::soft_ptr<NestedNode, is_safe> parent_) : parent(parent_), depth(depth_)
+		{
+			if(depth > 1)
+				child = safememory::make_owning_2<NestedNode, is_safe>(depth - 1, myThis.getSoftPtr(this));
+		}
+	};
+
+} // namespace
+
+
+template<int IX, memory_safety is_safe>
+void BenchmarkSafePtrTempl()
+{
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t maxLiveCount = 64;
+	const size_t totalCopies = 0x100000;
+
+	for(int i = 0; i < 2; i++)
+	{
+		safememory::owning_ptr<Payload, is_safe> op = safememory::make_owning_2<Payload, is_safe>();
+		safememory::soft_ptr<Payload, is_safe>* sps = new safememory::soft_ptr<Payload, is_safe>[maxLiveCount];
+
+		///////////////////////////////
+		// Test copy/destroy with a single live soft_ptr
+		///////////////////////////////
+
+		TestSoftPtrCopyDestroy(stopwatch1, op, sps, 1, totalCopies);
+
+		if(i == 1)
+			Benchmark::AddResult("soft_ptr/copy+destroy, 1 live", IX, stopwatch1);
+
+
+		///////////////////////////////
+		// Test copy/destroy fitting into inline slots
+		///////////////////////////////
+
+		TestSoftPtrCopyDestroy(stopwatch1, op, sps, 3, totalCopies / 3);
+
+		if(i == 1)
+			Benchmark::AddResult("soft_ptr/copy+destroy, 3 live", IX, stopwatch1);
+
+
+		///////////////////////////////
+		// Test copy/destroy spilling to the second block
+		///////////////////////////////
+
+		TestSoftPtrCopyDestroy(stopwatch1, op, sps, 8, totalCopies / 8);
+
+		if(i == 1)
+			Benchmark::AddResult("soft_ptr/copy+destroy, 8 live", IX, stopwatch1);
+
+
+		TestSoftPtrCopyDestroy(stopwatch1, op, sps, 64, totalCopies / 64);
+
+		if(i == 1)
+			Benchmark::AddResult("soft_ptr/copy+destroy, 64 live", IX, stopwatch1);
+
+		delete [] sps;
+	}
+}
+
+
+template<int IX, memory_safety is_safe>
+void BenchmarkSafePtrTeardownTempl()
+{
+	typedef safememory::owning_ptr<Payload, is_safe> OwningPtr;
+	typedef SoftPtrHolder<safememory::soft_ptr<Payload, is_safe>> Holder;
+
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t maxSoftCount = 10000;
+	const size_t totalSoftPtrs = 0x100000;
+	auto makeOwning = []() { return safememory::make_owning_2<Payload, is_safe>(); };
+
+	for(int i = 0; i < 2; i++)
+	{
+		Holder* holders = new Holder[maxSoftCount];
+
+		///////////////////////////////
+		// Test owning_ptr destruction with N soft_ptrs pointing to it
+		///////////////////////////////
+
+		TestOwningPtrTeardown<OwningPtr>(stopwatch1, makeOwning, holders, 1, totalSoftPtrs);
+
+		if(i == 1)
+			Benchmark::AddResult("owning_ptr/teardown, 1 soft_ptr", IX, stopwatch1);
+
+		TestOwningPtrTeardown<OwningPtr>(stopwatch1, makeOwning, holders, 10, totalSoftPtrs / 10);
+
+		if(i == 1)
+			Benchmark::AddResult("owning_ptr/teardown, 10 soft_ptrs", IX, stopwatch1);
+
+		TestOwningPtrTeardown<OwningPtr>(stopwatch1, makeOwning, holders, 100, totalSoftPtrs / 100);
+
+		if(i == 1)
+			Benchmark::AddResult("owning_ptr/teardown, 100 soft_ptrs", IX, stopwatch1);
+
+		TestOwningPtrTeardown<OwningPtr>(stopwatch1, makeOwning, holders, 1000, totalSoftPtrs / 1000);
+
+		if(i == 1)
+			Benchmark::AddResult("owning_ptr/teardown, 1000 soft_ptrs", IX, stopwatch1);
+
+		TestOwningPtrTeardown<OwningPtr>(stopwatch1, makeOwning, holders, 10000, totalSoftPtrs / 10000);
+
+		if(i == 1)
+			Benchmark::AddResult("owning_ptr/teardown, 10000 soft_ptrs", IX, stopwatch1);
+
+		delete [] holders;
+	}
+}
+
+
+template<int IX, memory_safety is_safe>
+void BenchmarkSoftPtrVectorTempl()
+{
+	typedef safememory::owning_ptr<Payload, is_safe> OwningPtr;
+	typedef safememory::soft_ptr<Payload, is_safe> SoftPtr;
+	typedef safememory::vector<SoftPtr, is_safe> SoftPtrVector;
+
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t ownerCount = 256;
+	const size_t softCount = 0x10000;
+
+	EASTLTest_Printf("sizeof(soft_ptr) = %u, is_safe = %d\n", (unsigned)sizeof(SoftPtr), (int)(is_safe == memory_safety::safe));
+
+	for(int i = 0; i < 2; i++)
+	{
+		OwningPtr* owners = new OwningPtr[ownerCount];
+		for(size_t k = 0; k < ownerCount; ++k)
+		{
+			owners[k] = safememory::make_owning_2<Payload, is_safe>();
+			owners[k]->mData[0] = k;
+		}
+
+		{
+			SoftPtrVector v;
+
+			///////////////////////////////
+			// Test push_back (includes moving registered soft_ptrs at reallocation)
+			///////////////////////////////
+
+			stopwatch1.Restart();
+			for(size_t k = 0; k < softCount; ++k)
+				v.push_back(SoftPtr(owners[k % ownerCount]));
+			stopwatch1.Stop();
+
+			if(i == 1)
+				Benchmark::AddResult("vector<soft_ptr>/push_back", IX, stopwatch1);
+
+			///////////////////////////////
+			// Test sequential dereference (bound by memory bandwidth, i.e. by sizeof(soft_ptr))
+			///////////////////////////////
+
+			uint64_t sum = 0;
+			stopwatch1.Restart();
+			for(int r = 0; r < 16; ++r)
+			{
+				for(auto it = v.begin(); it != v.end(); ++it)
+					sum += (*it)->mData[0];
+			}
+			stopwatch1.Stop();
+			sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)(sum & 0xffffffff));
+
+			if(i == 1)
+				Benchmark::AddResult("vector<soft_ptr>/iterate+deref", IX, stopwatch1);
+
+			///////////////////////////////
+			// Test clear
+			///////////////////////////////
+
+			stopwatch1.Restart();
+			v.clear();
+			stopwatch1.Stop();
+
+			if(i == 1)
+				Benchmark::AddResult("vector<soft_ptr>/clear", IX, stopwatch1);
+		}
+
+		delete [] owners;
+	}
+}
+
+
+template<int IX, memory_safety is_safe>
+void BenchmarkNestedMakeOwningTempl()
+{
+	typedef NestedNode<is_safe> Node;
+
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t treeCount = 0x1000;
+	const size_t depth = 32;
+
+	for(int i = 0; i < 2; i++)
+	{
+		std::vector<safememory::owning_ptr<Node, is_safe>> v;
+		v.reserve(treeCount);
+
+		///////////////////////////////
+		// Test make_owning nested in constructors
+		///////////////////////////////
+
+		stopwatch1.Restart();
+		for(size_t k = 0; k < treeCount; ++k)
+			v.push_back(safememory::make_owning_2<Node, is_safe>(depth, safememory::soft_ptr<Node, is_safe>()));
+		stopwatch1.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)v.back()->child->depth);
+
+		if(i == 1)
+			Benchmark::AddResult("make_owning/nested in ctors, depth 32", IX, stopwatch1);
+	}
+}
+
+
+// objects are created and destroyed in rounds (e.g. messages of a single event loop iteration);
+// blocks recycled by object_pool become reusable at collect(), at the end of each round
+template<int IX, memory_safety is_safe>
+void BenchmarkObjectPoolTempl()
+{
+	typedef safememory::owning_ptr<Payload, is_safe> OwningPtr;
+
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t roundCount = 0x400;
+	const size_t objectCount = 0x100;
+
+	for(int i = 0; i < 2; i++)
+	{
+		std::vector<OwningPtr> v;
+		v.reserve(objectCount);
+
+		///////////////////////////////
+		// Test make_owning/reset churn
+		///////////////////////////////
+
+		stopwatch1.Restart();
+		for(size_t r = 0; r < roundCount; ++r)
+		{
+			for(size_t k = 0; k < objectCount; ++k)
+				v.push_back(safememory::make_owning_2<Payload, is_safe>());
+			v.clear();
+		}
+		stopwatch1.Stop();
+
+		if(i == 1)
+			Benchmark::AddResult("make_owning/churn", IX, stopwatch1);
+
+		///////////////////////////////
+		// Test object_pool make/recycle churn
+		///////////////////////////////
+
+		safememory::object_pool<Payload, is_safe> pool;
+		stopwatch1.Restart();
+		for(size_t r = 0; r < roundCount; ++r)
+		{
+			for(size_t k = 0; k < objectCount; ++k)
+				v.push_back(pool.make());
+			for(size_t k = 0; k < objectCount; ++k)
+				pool.recycle(std::move(v[k]));
+			v.clear();
+			pool.collect();
+		}
+		stopwatch1.Stop();
+
+		if(i == 1)
+			Benchmark::AddResult("object_pool/churn", IX, stopwatch1);
+	}
+}
+
+
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+// in on-demand mode objects created while no allocator is current come from the std heap (allocatorID 0),
+// and both kinds may be destroyed while iibmalloc is current
+template<int IX, memory_safety is_safe>
+void BenchmarkMixedHeapFreesTempl()
+{
+	typedef safememory::owning_ptr<Payload, is_safe> OwningPtr;
+
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t objectCount = 0x40000;
+
+	for(int i = 0; i < 2; i++)
+	{
+		std::vector<OwningPtr> v;
+		v.reserve(objectCount);
+		for(size_t k = 0; k < objectCount; ++k)
+		{
+			if(k % 2 == 0)
+			{
+				auto former = nodecpp::iibmalloc::setCurrneAllocator(nullptr);
+				v.push_back(safememory::make_owning_2<Payload, is_safe>());
+				nodecpp::iibmalloc::setCurrneAllocator(former);
+			}
+			else
+				v.push_back(safememory::make_owning_2<Payload, is_safe>());
+		}
+
+		///////////////////////////////
+		// Test destruction of interleaved std heap and iibmalloc objects
+		///////////////////////////////
+
+		stopwatch1.Restart();
+		v.clear();
+		stopwatch1.Stop();
+
+		if(i == 1)
+			Benchmark::AddResult("owning_ptr/destroy, std heap + iibmalloc", IX, stopwatch1);
+	}
+}
+#endif // NODECPP_MEMORY_SAFETY_ON_DEMAND
+
+
+template<int IX, memory_safety is_safe>
+void BenchmarkSharedSafePtrTempl()
+{
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t copiesPerThread = 0x40000;
+
+	for(int i = 0; i < 2; i++)
+	{
+		safememory::shared_owning_ptr<Payload, is_safe> op = safememory::make_shared_owning<Payload, is_safe>();
+		safememory::shared_soft_ptr<Payload, is_safe> sp = op;
+
+		///////////////////////////////
+		// Test copy/destroy of soft_ptrs to a shared object at N threads
+		///////////////////////////////
+
+		TestSharedSoftPtrCopyDestroy(stopwatch1, sp, 1, copiesPerThread / 4);
+
+		if(i == 1)
+			Benchmark::AddResult("shared_soft_ptr/copy+destroy, 1 thread", IX, stopwatch1);
+
+		TestSharedSoftPtrCopyDestroy(stopwatch1, sp, 2, copiesPerThread / 4);
+
+		if(i == 1)
+			Benchmark::AddResult("shared_soft_ptr/copy+destroy, 2 threads", IX, stopwatch1);
+
+		TestSharedSoftPtrCopyDestroy(stopwatch1, sp, 4, copiesPerThread / 4);
+
+		if(i == 1)
+			Benchmark::AddResult("shared_soft_ptr/copy+destroy, 4 threads", IX, stopwatch1);
+
+		TestSharedSoftPtrCopyDestroy(stopwatch1, sp, 8, copiesPerThread / 4);
+
+		if(i == 1)
+			Benchmark::AddResult("shared_soft_ptr/copy+destroy, 8 threads", IX, stopwatch1);
+	}
+}
+
+
+// zombie index of the new/delete fallback allocator: previous std::map based one vs. ZombieBitmap
+void BenchmarkDezombiefy()
+{
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	const size_t blockCount = 0x10000;
+	const size_t blockSize = 96;
+	const size_t repeatCount = 16;
+
+	for(int i = 0; i < 2; i++)
+	{
+		uint8_t** blocks = new uint8_t*[blockCount];
+		uint8_t** ptrs = new uint8_t*[blockCount];
+		for(size_t k = 0; k < blockCount; ++k)
+			blocks[k] = new uint8_t[blockSize];
+
+		// every other block is a zombie; pointers are checked in an order unrelated to memory order
+		std::map<uint8_t*, size_t, std::greater<uint8_t*>> zombieMap;
+		safememory::detail::ZombieBitmap zombieBitmap{};
+		for(size_t k = 0; k < blockCount; k += 2)
+		{
+			zombieMap.insert(std::make_pair(blocks[k], blockSize));
+			zombieBitmap.mark(blocks[k], blockSize);
+		}
+		for(size_t k = 0; k < blockCount; ++k)
+			ptrs[k] = blocks[(k * 7919) % blockCount] + (k % blockSize);
+
+		///////////////////////////////
+		// Test isPointerNotZombie() over 32K zombie blocks
+		///////////////////////////////
+
+		TestDezombiefy(stopwatch1, [&zombieMap](uint8_t* ptr) {
+			auto iter = zombieMap.lower_bound(ptr);
+			return iter == zombieMap.end() || ptr >= iter->first + iter->second;
+		}, ptrs, blockCount, repeatCount);
+
+		if(i == 1)
+			Benchmark::AddResult("dezombiefy/lookup, 32K zombies", 1, stopwatch1);
+
+		TestDezombiefy(stopwatch1, [&zombieBitmap](uint8_t* ptr) {
+			return !zombieBitmap.isMarked(ptr);
+		}, ptrs, blockCount, repeatCount);
+
+		if(i == 1)
+			Benchmark::AddResult("dezombiefy/lookup, 32K zombies", 4, stopwatch1);
+
+		zombieBitmap.clear();
+		for(size_t k = 0; k < blockCount; ++k)
+			delete [] blocks[k];
+		delete [] ptrs;
+		delete [] blocks;
+	}
+}
+
+
+void BenchmarkSafePtr()
+{
+	EASTLTest_Printf("SafePtr\n");
+
+	// NOTE: first column here is soft_ptr with no checks, last column is a regular (safe) soft_ptr
+	BenchmarkSafePtrTempl<1, memory_safety::none>();
+	BenchmarkSafePtrTempl<4, memory_safety::safe>();
+
+	BenchmarkSafePtrTeardownTempl<1, memory_safety::none>();
+	BenchmarkSafePtrTeardownTempl<4, memory_safety::safe>();
+
+	// NOTE: build with NODECPP_COMPACT_SOFT_PTR to compare against 2-word soft_ptr
+	BenchmarkSoftPtrVectorTempl<1, memory_safety::none>();
+	BenchmarkSoftPtrVectorTempl<4, memory_safety::safe>();
+
+	BenchmarkNestedMakeOwningTempl<1, memory_safety::none>();
+	BenchmarkNestedMakeOwningTempl<4, memory_safety::safe>();
+
+	BenchmarkObjectPoolTempl<1, memory_safety::none>();
+	BenchmarkObjectPoolTempl<4, memory_safety::safe>();
+
+#ifdef NODECPP_MEMORY_SAFETY_ON_DEMAND
+	BenchmarkMixedHeapFreesTempl<1, memory_safety::none>();
+	BenchmarkMixedHeapFreesTempl<4, memory_safety::safe>();
+#endif
+
+	BenchmarkSharedSafePtrTempl<1, memory_safety::none>();
+	BenchmarkSharedSafePtrTempl<4, memory_safety::safe>();
+
+	// NOTE: here first column is std::map based zombie index, last column is ZombieBitmap
+	BenchmarkDezombiefy();
+}
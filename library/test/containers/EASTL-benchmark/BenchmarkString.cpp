@@ -186,6 +186,51 @@ namespace
 	}
 
 
+	template <typename T>
+	size_t HashString(const eastl::basic_string<T>& s) { return eastl::hash<eastl::basic_string<T>>()(s); }
+
+	template <typename T, safememory::memory_safety Safety>
+	size_t HashString(const safememory::basic_string<T, Safety>& s) { return safememory::hash<safememory::basic_string<T, Safety>>()(s); }
+
+
+	// scans of a long text, where vectorized search of single byte strings matters most
+	template <typename Container> 
+	void TestFindLong(EA::StdC::Stopwatch& stopwatch, Container& c, Container& p)
+	{
+		stopwatch.Restart();
+		for(int i = 0; i < 100; i++)
+			Benchmark::DoNothing(&c, c.find(p));
+		stopwatch.Stop();
+	}
+
+	template <typename Container> 
+	void TestFirstOfLong(EA::StdC::Stopwatch& stopwatch, Container& c, Container& p)
+	{
+		stopwatch.Restart();
+		for(int i = 0; i < 100; i++)
+			Benchmark::DoNothing(&c, c.find_first_of(p));
+		stopwatch.Stop();
+	}
+
+	template <typename Container> 
+	void TestLastOfLong(EA::StdC::Stopwatch& stopwatch, Container& c, Container& p)
+	{
+		stopwatch.Restart();
+		for(int i = 0; i < 100; i++)
+			Benchmark::DoNothing(&c, c.find_last_of(p));
+		stopwatch.Stop();
+	}
+
+	template <typename Container> 
+	void TestHashLong(EA::StdC::Stopwatch& stopwatch, Container& c)
+	{
+		stopwatch.Restart();
+		for(int i = 0; i < 100; i++)
+			Benchmark::DoNothing(&c, HashString(c));
+		stopwatch.Stop();
+	}
+
+
 	template <typename Container> 
 	void TestSwap(EA::StdC::Stopwatch& stopwatch, Container& c1, Container& c2) // size()
 	{
@@ -458,6 +503,41 @@ void BenchmarkStringTempl()
 
 
 
+		///////////////////////////////
+		// Test search and hash over a long text
+		///////////////////////////////
+
+		S8 text8;
+		for(int j = 0; j < 64 * 1024; j++)
+			text8.push_back((j % 7) == 6 ? ' ' : (typename S8::value_type)('a' + (j % 26)));
+		text8.insert(0, 1, '#');
+		decltype(stds8) pNeedle8 = { 'n', 'e', 'e', 'd', 'l', 'e' };
+		text8.append(pNeedle8);
+		text8.push_back(';');
+
+		TestFindLong(stopwatch1, text8, pNeedle8);
+
+		if(i == 1)
+			Benchmark::AddResult("string<char8_t>/find/long", IX, stopwatch1);
+
+		decltype(stds8) pPunct8 = { ';', ',', '{', '}' };
+		TestFirstOfLong(stopwatch1, text8, pPunct8);
+
+		if(i == 1)
+			Benchmark::AddResult("string<char8_t>/find_first_of/long", IX, stopwatch1);
+
+		decltype(stds8) pHash8 = { '#', '@', '$' };
+		TestLastOfLong(stopwatch1, text8, pHash8);
+
+		if(i == 1)
+			Benchmark::AddResult("string<char8_t>/find_last_of/long", IX, stopwatch1);
+
+		TestHashLong(stopwatch1, text8);
+
+		if(i == 1)
+			Benchmark::AddResult("string<char8_t>/hash/long", IX, stopwatch1);
+
+
 		///////////////////////////////
 		// Test swap()
 		///////////////////////////////
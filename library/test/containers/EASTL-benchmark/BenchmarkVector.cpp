@@ -9,6 +9,7 @@
 #include <EASTL/algorithm.h>
 #include <EASTL/sort.h>
 #include <safememory/vector.h>
+#include <safememory/small_vector.h>
 #include <safememory/algorithm.h>
 #include <EASTL/vector.h>
 
@@ -414,6 +415,72 @@ void BenchmarkVectorTempl()
 	}
 }
 
+namespace
+{
+	template <typename Container>
+	size_t HeapBytes(const Container& c)
+	{
+		return c.capacity() * sizeof(typename Container::value_type);
+	}
+
+	template <typename T, eastl_size_t N, safememory::memory_safety Safety>
+	size_t HeapBytes(const safememory::small_vector<T, N, Safety>& c)
+	{
+		return c.is_inline() ? 0 : c.capacity() * sizeof(T);
+	}
+} // namespace
+
+/// Many tiny vectors, the typical per-object 'list of a few items' case,
+/// where small_vector avoids one heap allocation per container.
+template<int IX, template<typename> typename Vec> 
+void BenchmarkSmallVectorTempl()
+{
+	const size_t kContainerCount = 10000;
+	const size_t kElementCount   = 3;
+
+	Stopwatch stopwatch1(Stopwatch::kUnitsCPUCycles);
+
+	for(int i = 0; i < 2; i++)
+	{
+		eastl::vector<Vec<uint64_t>> containers(kContainerCount);
+
+
+		///////////////////////////////
+		// Test push_back
+		///////////////////////////////
+
+		stopwatch1.Restart();
+		for(size_t c = 0; c < kContainerCount; ++c)
+			for(size_t j = 0; j < kElementCount; ++j)
+				containers[c].push_back((uint64_t)(c + j));
+		stopwatch1.Stop();
+
+		size_t memory = containers.size() * sizeof(Vec<uint64_t>);
+		for(size_t c = 0; c < kContainerCount; ++c)
+			memory += HeapBytes(containers[c]);
+		sprintf(Benchmark::gScratchBuffer, "%d:%uKB", IX, (unsigned)(memory / 1024));
+
+		if(i == 1)
+			Benchmark::AddResult("small_vector<uint64,4>/push_back", IX, stopwatch1, Benchmark::gScratchBuffer);
+
+
+		///////////////////////////////
+		// Test iteration
+		///////////////////////////////
+
+		uint64_t temp = 0;
+		stopwatch1.Restart();
+		for(size_t c = 0; c < kContainerCount; ++c)
+			for(auto it = containers[c].begin(); it != containers[c].end(); ++it)
+				temp += *it;
+		stopwatch1.Stop();
+		sprintf(Benchmark::gScratchBuffer, "%u", (unsigned)(temp & 0xffffffff));
+
+		if(i == 1)
+			Benchmark::AddResult("small_vector<uint64,4>/iteration", IX, stopwatch1);
+	}
+}
+
 template<class T>
 using StdVec = std::vector<T>;
 
@@ -429,6 +496,12 @@ using SafeVec = safememory::vector<T, safememory::memory_safety::safe>;
 template<class T>
 using VerySafeVec = safememory::vector_safe<T, safememory::memory_safety::safe>;
 
+template<class T>
+using UnsafeSmallVec = safememory::small_vector<T, 4, safememory::memory_safety::none>;
+
+template<class T>
+using SafeSmallVec = safememory::small_vector<T, 4, safememory::memory_safety::safe>;
+
 
 void BenchmarkVector()
 {
@@ -439,5 +512,10 @@ void BenchmarkVector()
 	BenchmarkVectorTempl<2, UnsafeVec>();
 	BenchmarkVectorTempl<3, SafeVec>();
 	BenchmarkVectorTempl<4, VerySafeVec>();
+
+	BenchmarkSmallVectorTempl<1, EaVec>();
+	BenchmarkSmallVectorTempl<2, SafeVec>();
+	BenchmarkSmallVectorTempl<3, UnsafeSmallVec>();
+	BenchmarkSmallVectorTempl<4, SafeSmallVec>();
 }
 
@@ -156,6 +156,12 @@ namespace Benchmark
 		if(result == gResultSet.end())
 			return;
 
+		if(pNotes) {
+			if(result->second.msNotes.length())
+				result->second.msNotes += " ";
+			result->second.msNotes += pNotes;
+		}
+
 		if(index == 2)
 			result->second.mTime2 = sw.GetElapsedTime();
 		else if(index == 3)
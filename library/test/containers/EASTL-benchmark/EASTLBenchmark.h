@@ -45,6 +45,7 @@ void BenchmarkAlgorithm();
 void BenchmarkHeap();
 void BenchmarkBitset();
 void BenchmarkTupleVector();
+void BenchmarkSafePtr();
 
 
 namespace Benchmark
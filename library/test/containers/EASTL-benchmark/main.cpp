@@ -132,10 +132,11 @@ int main(int argc, char* argv[])
 		// BenchmarkList();
 		BenchmarkString();
 		BenchmarkVector();
-		// BenchmarkDeque();
+		BenchmarkDeque();
 		// BenchmarkSet();
 		// BenchmarkMap();
 		BenchmarkHash();
+		BenchmarkSafePtr();
 		// BenchmarkHeap();
 		// BenchmarkBitset();
 		// BenchmarkSort();
@@ -0,0 +1,247 @@
+/* -------------------------------------------------------------------------------
+* Copyright (c) 2021, OLogN Technologies AG
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the OLogN Technologies AG nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* -------------------------------------------------------------------------------*/
+
+
+#include "EASTLTest.h"
+#include <safememory/deque.h>
+#include <safememory/ring_buffer.h>
+
+
+// Template instantations.
+// These tell the compiler to compile all the functions for the given class.
+template class safememory::deque<int>;
+template class safememory::deque<TestObject>;
+template class safememory::deque<TestObject, safememory::memory_safety::none>;
+template class safememory::ring_buffer<int>;
+template class safememory::ring_buffer<TestObject, safememory::memory_safety::none>;
+
+
+template<class Deque>
+int TestDequeImpl()
+{
+	int nErrorCount = 0;
+
+	TestObject::Reset();
+
+	{
+		// push and pop at both ends, wrapping around the array
+		Deque d;
+		EATEST_VERIFY(d.empty() && d.begin() == d.end());
+
+		for(int i = 0; i < 4; ++i)
+			d.push_back(TestObject(i));
+		for(int i = 0; i < 3; ++i)
+			d.pop_front();
+		for(int i = 4; i < 7; ++i)
+			d.push_back(TestObject(i));
+		d.push_front(TestObject(2));
+
+		EATEST_VERIFY(d.size() == 5);
+		for(int i = 0; i < 5; ++i)
+			EATEST_VERIFY(d[i] == TestObject(i + 2));
+		EATEST_VERIFY(d.front() == TestObject(2) && d.back() == TestObject(6));
+
+		int n = 2;
+		for(auto it = d.begin(); it != d.end(); ++it)
+			EATEST_VERIFY(*it == TestObject(n++));
+		for(auto it = d.rbegin(); it != d.rend(); ++it)
+			EATEST_VERIFY(*it == TestObject(--n));
+
+		d.emplace_back(7);
+		d.emplace_front(1);
+		EATEST_VERIFY(d.size() == 7 && d.front() == TestObject(1) && d.back() == TestObject(7));
+
+		d.pop_back();
+		d.pop_front();
+		EATEST_VERIFY(d.size() == 5 && d.front() == TestObject(2) && d.back() == TestObject(6));
+	}
+
+	{
+		// insert and erase in the middle
+		Deque d = { TestObject(0), TestObject(1), TestObject(2), TestObject(3), TestObject(4) };
+
+		auto it = d.insert(d.begin() + 1, TestObject(9));
+		EATEST_VERIFY(*it == TestObject(9) && d.size() == 6 && d[2] == TestObject(1));
+		it = d.insert(d.end() - 1, TestObject(8));
+		EATEST_VERIFY(*it == TestObject(8) && d.size() == 7 && d[6] == TestObject(4));
+		it = d.emplace(d.begin() + 3, d[0]);
+		EATEST_VERIFY(*it == TestObject(0) && d[4] == TestObject(2));
+
+		it = d.erase(d.begin() + 1);
+		EATEST_VERIFY(*it == TestObject(1) && d.size() == 7);
+		it = d.erase(d.begin() + 4, d.end() - 1);
+		EATEST_VERIFY(*it == TestObject(4) && d.size() == 5);
+		it = d.erase(d.begin(), d.begin() + 2);
+		EATEST_VERIFY(*it == TestObject(0) && d.size() == 3);
+		EATEST_VERIFY(d[1] == TestObject(2) && d[2] == TestObject(4));
+	}
+
+	{
+		// copy, move, assign and compare
+		Deque a = { TestObject(1), TestObject(2) };
+		Deque b(5, TestObject(3));
+
+		Deque c(a);
+		EATEST_VERIFY(c == a);
+		c = b;
+		EATEST_VERIFY(c == b && a < b && a != b);
+
+		Deque d(std::move(c));
+		EATEST_VERIFY(d == b && c.empty());
+		c.swap(d);
+		EATEST_VERIFY(c == b && d.empty());
+
+		c.resize(2);
+		EATEST_VERIFY(c.size() == 2);
+		c.shrink_to_fit();
+		EATEST_VERIFY(c.capacity() == 2);
+		c.clear();
+		EATEST_VERIFY(c.empty());
+	}
+
+#if EASTL_EXCEPTIONS_ENABLED
+	if(Deque::is_safe == safememory::memory_safety::safe)
+	{
+		Deque d;
+
+		try {
+			d.pop_front();
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+
+		d.push_back(TestObject(1));
+		try {
+			d.erase(d.end());
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+
+		// iterators don't survive the head moving
+		d.reserve(8);
+		auto end = d.end();
+		d.push_front(TestObject(0));
+		try {
+			d.erase(end - 1);
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+
+		// nor a reallocation
+		auto it = d.begin();
+		for(int i = 0; i < 16; ++i)
+			d.push_back(TestObject(i));
+
+		try {
+			EATEST_VERIFY(*it == TestObject(0));
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+	}
+#endif
+
+	EATEST_VERIFY(TestObject::IsClear());
+	TestObject::Reset();
+
+	return nErrorCount;
+}
+
+
+template<class Ring>
+int TestRingBufferImpl()
+{
+	int nErrorCount = 0;
+
+	TestObject::Reset();
+
+	{
+		Ring r(3);
+		EATEST_VERIFY(r.empty() && r.capacity() == 3 && !r.full());
+
+		for(int i = 0; i < 3; ++i)
+			r.push_back(TestObject(i));
+		EATEST_VERIFY(r.full() && r.front() == TestObject(0));
+
+		// full, oldest element is overwritten
+		r.push_back(TestObject(3));
+		r.emplace_back(4);
+		EATEST_VERIFY(r.size() == 3 && r.capacity() == 3);
+		EATEST_VERIFY(r[0] == TestObject(2) && r[1] == TestObject(3) && r[2] == TestObject(4));
+
+		// and from the other side, newest element is overwritten
+		r.push_front(TestObject(1));
+		EATEST_VERIFY(r.size() == 3 && r.front() == TestObject(1) && r.back() == TestObject(3));
+
+		int n = 1;
+		for(auto it = r.begin(); it != r.end(); ++it)
+			EATEST_VERIFY(*it == TestObject(n++));
+
+		r.pop_front();
+		EATEST_VERIFY(r.size() == 2 && !r.full() && r.front() == TestObject(2));
+
+		// shrinking keeps the newest elements
+		r.push_back(TestObject(4));
+		r.set_capacity(2);
+		EATEST_VERIFY(r.size() == 2 && r.full() && r[0] == TestObject(3) && r[1] == TestObject(4));
+
+		Ring c(r);
+		EATEST_VERIFY(c == r);
+		c.pop_back();
+		EATEST_VERIFY(c != r);
+	}
+
+	EATEST_VERIFY(TestObject::IsClear());
+	TestObject::Reset();
+
+	return nErrorCount;
+}
+
+
+int TestDeque()
+{
+	int nErrorCount = 0;
+
+	nErrorCount += TestDequeImpl<safememory::deque<TestObject>>();
+	nErrorCount += TestDequeImpl<safememory::deque<TestObject, safememory::memory_safety::none>>();
+
+	return nErrorCount;
+}
+
+
+int TestRingBuffer()
+{
+	int nErrorCount = 0;
+
+	nErrorCount += TestRingBufferImpl<safememory::ring_buffer<TestObject>>();
+	nErrorCount += TestRingBufferImpl<safememory::ring_buffer<TestObject, safememory::memory_safety::none>>();
+
+	return nErrorCount;
+}
@@ -8,6 +8,8 @@
 #include "TestSet.h"
 #include <safememory/unordered_set.h>
 #include <safememory/unordered_map.h>
+#include <safememory/flat_hash_map.h>
+#include <safememory/flat_hash_set.h>
 // #include <EASTL/unordered_set.h>
 // #include <EASTL/unordered_map.h>
 #include <map>
@@ -1569,6 +1571,211 @@ template <typename Key, typename T, typename Hash, typename Predicate>
 using MMAP4 = safememory::unordered_multimap<Key, T, Hash, Predicate>;
 
 
+template <typename Map>
+int TestFlatHashMap()
+{
+	int nErrorCount = 0;
+
+	{
+		Map m;
+		EATEST_VERIFY(m.empty());
+		EATEST_VERIFY(m.capacity() == 0);
+		EATEST_VERIFY(m.begin() == m.end());
+		EATEST_VERIFY(m.find(1) == m.end());
+		EATEST_VERIFY(m.erase(1) == 0);
+
+		const int kCount = 10000;
+		for(int i = 0; i < kCount; i++)
+		{
+			auto r = m.insert(typename Map::value_type(i, i << 4));
+			EATEST_VERIFY(r.second);
+			EATEST_VERIFY(r.first->first == i);
+		}
+		EATEST_VERIFY(m.size() == kCount);
+		EATEST_VERIFY(m.load_factor() <= 0.875f);
+		EATEST_VERIFY(!m.insert(typename Map::value_type(0, 1)).second);
+
+		int n = 0;
+		for(auto it = m.begin(); it != m.end(); ++it)
+		{
+			EATEST_VERIFY(it->second == (it->first << 4));
+			++n;
+		}
+		EATEST_VERIFY(n == kCount);
+
+		for(int i = 0; i < kCount; i++)
+		{
+			EATEST_VERIFY(m.at(i) == (i << 4));
+			EATEST_VERIFY(m.count(i) == 1);
+		}
+		EATEST_VERIFY(!m.contains(kCount));
+
+		#if EASTL_EXCEPTIONS_ENABLED
+			try
+			{
+				m.at(kCount);
+				EATEST_VERIFY(false);
+			}
+			catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+			catch(...) { EATEST_VERIFY(false); }
+		#endif
+
+		// erase half, the rest must still be found through tombstones
+		for(int i = 0; i < kCount; i += 2)
+			EATEST_VERIFY(m.erase(i) == 1);
+		EATEST_VERIFY(m.size() == kCount / 2);
+		for(int i = 0; i < kCount; i++)
+			EATEST_VERIFY(m.contains(i) == (i % 2 == 1));
+
+		for(int i = 0; i < kCount; i += 2)
+			m[i] = i << 4;
+		EATEST_VERIFY(m.size() == kCount);
+		auto capacity = m.capacity();
+
+		auto it = m.begin();
+		while(it != m.end())
+			it = m.erase(it);
+		EATEST_VERIFY(m.empty());
+
+		m.clear();
+		EATEST_VERIFY(m.capacity() == capacity);
+	}
+
+	{
+		// try_emplace, insert_or_assign, copy and move
+		Map m;
+		EATEST_VERIFY(m.try_emplace(1, 10).second);
+		EATEST_VERIFY(!m.try_emplace(1, 20).second);
+		EATEST_VERIFY(m[1] == 10);
+		EATEST_VERIFY(!m.insert_or_assign(1, 30).second);
+		EATEST_VERIFY(m[1] == 30);
+		EATEST_VERIFY(m.insert_or_assign(2, 40).second);
+		EATEST_VERIFY(m[3] == 0);
+
+		Map m2(m);
+		EATEST_VERIFY(m2 == m);
+		m2[4] = 4;
+		EATEST_VERIFY(m2 != m);
+
+		Map m3(std::move(m2));
+		EATEST_VERIFY(m2.empty());
+		EATEST_VERIFY(m3.size() == 4);
+		m3.swap(m);
+		EATEST_VERIFY(m.size() == 4);
+		EATEST_VERIFY(m3.size() == 3);
+
+		m.reserve(1000);
+		EATEST_VERIFY(m.capacity() >= 1000);
+		EATEST_VERIFY(m[4] == 4);
+		m.rehash(0);
+		EATEST_VERIFY(m.capacity() == Map::min_capacity);
+		EATEST_VERIFY(m[1] == 30);
+	}
+
+	{
+		// iterator to erased element, or from other table
+		Map m;
+		m[1] = 1;
+		m[2] = 2;
+		auto it = m.find(1);
+		m.erase(1);
+		#if EASTL_EXCEPTIONS_ENABLED
+			try
+			{
+				int x = it->second;
+				(void)x;
+				EATEST_VERIFY(false);
+			}
+			catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+			catch(...) { EATEST_VERIFY(false); }
+
+			Map m2(m);
+			try
+			{
+				m.erase(m2.begin());
+				EATEST_VERIFY(false);
+			}
+			catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+			catch(...) { EATEST_VERIFY(false); }
+		#endif
+	}
+
+	{
+		// heap safe iterator is invalidated when the table grows
+		Map m;
+		m[1] = 1;
+		auto* it = new typename Map::iterator_safe(m.find_safe(1)); // explicitly non-stack
+		EATEST_VERIFY((*it)->second == 1);
+		for(int i = 2; i < 1000; i++)
+			m[i] = i;
+		#if EASTL_EXCEPTIONS_ENABLED
+		if constexpr (Map::is_safe == safememory::memory_safety::safe)
+		{
+			try
+			{
+				int x = (*it)->second;
+				(void)x;
+				EATEST_VERIFY(false);
+			}
+			catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+			catch(...) { EATEST_VERIFY(false); }
+		}
+		#endif
+		delete it;
+	}
+
+	{
+		// key and value refer to elements, while the insert rehashes the table
+		Map m;
+		m[0] = 7;
+		size_t capacity = m.capacity();
+		for(int i = 1; i < 1000; i++)
+			m.try_emplace(i, m.at(i - 1));
+		EATEST_VERIFY(m.capacity() > capacity);
+		for(int i = 0; i < 1000; i++)
+			EATEST_VERIFY(m.at(i) == 7);
+
+		Map m2;
+		m2[0] = 1;
+		for(int i = 1; i < 1000; i++)
+			m2[m2.at(i - 1)] = i + 1;
+		for(int i = 0; i < 1000; i++)
+			EATEST_VERIFY(m2.at(i) == i + 1);
+	}
+
+	{
+		TestObject::Reset();
+		{
+			safememory::flat_hash_map<int, TestObject> m;
+			for(int i = 0; i < 100; i++)
+				m.try_emplace(i, i);
+			for(int i = 0; i < 100; i += 3)
+				m.erase(i);
+			EATEST_VERIFY(m[1].mX == 1);
+		}
+		EATEST_VERIFY(TestObject::IsClear());
+		TestObject::Reset();
+	}
+
+	{
+		safememory::flat_hash_set<int> s = { 1, 2, 3 };
+		EATEST_VERIFY(s.size() == 3);
+		EATEST_VERIFY(!s.insert(2).second);
+		EATEST_VERIFY(s.contains(3));
+		EATEST_VERIFY(s.erase(3) == 1);
+		EATEST_VERIFY(s.find(3) == s.end());
+		EATEST_VERIFY(*s.find(1) == 1);
+	}
+
+	return nErrorCount;
+}
+
+template <typename Key, typename T>
+using FLAT_MAP = safememory::flat_hash_map<Key, T>;
+
+template <typename Key, typename T>
+using FLAT_MAP_NO_CHECKS = safememory::flat_hash_map<Key, T, safememory::hash<Key>, safememory::equal_to<Key>, safememory::memory_safety::none>;
+
 int TestHash()
 {
 	int nErrorCount = 0;
@@ -1583,6 +1790,9 @@ int TestHash()
 
 	nErrorCount += TestHashMultiMap<MMAP, MMAP4>();
 
+	nErrorCount += TestFlatHashMap<FLAT_MAP<int, int>>();
+	nErrorCount += TestFlatHashMap<FLAT_MAP_NO_CHECKS<int, int>>();
+
 	return nErrorCount;
 }
 
@@ -89,6 +89,162 @@ int TestToString() {
 }
 
 
+// single byte strings use vectorized search, check it against eastl for all
+// alignments and lengths around the vector width
+template <typename StringType>
+int TestStringKernels()
+{
+	int nErrorCount = 0;
+	typedef eastl::basic_string<char> BaseString;
+
+	EASTLTest_Rand rng(GetRandSeed());
+
+	for(int i = 0; i < 2000; i++)
+	{
+		const eastl_size_t n = rng.RandLimit(100);
+		const eastl_size_t m = rng.RandLimit(12);
+		const char alphabet = 'a' + (char)(2 + rng.RandLimit(5));
+
+		BaseString b1, b2;
+		for(eastl_size_t j = 0; j < n; j++)
+			b1.push_back(rng.RandLimit(10) == 0 ? '\0' : (char)rng.RandRange('a', alphabet));
+		for(eastl_size_t j = 0; j < m; j++)
+			b2.push_back((char)rng.RandRange('a', alphabet + 1));
+
+		StringType s1, s2;
+		s1.append_unsafe(b1.data(), b1.size());
+		s2.append_unsafe(b2.data(), b2.size());
+		const eastl_size_t pos = rng.RandLimit(n + 3);
+		const char c = m ? b2[0] : 'a';
+
+		VERIFY(s1.find(s2, pos) == b1.find(b2, pos));
+		VERIFY(s1.find(c, pos) == b1.find(c, pos));
+		VERIFY(s1.find_first_of(s2, pos) == b1.find_first_of(b2, pos));
+		VERIFY(s1.find_last_of(s2, pos) == b1.find_last_of(b2, pos));
+		VERIFY(s1.find_last_of(s2) == b1.find_last_of(b2));
+
+		StringType s3(s1);
+		VERIFY(safememory::hash<StringType>()(s1) == safememory::hash<StringType>()(s3));
+	}
+
+	// embedded zeros take part in hash
+	{
+		StringType s1, s2;
+		s1.append_unsafe("ab", 2);
+		s2.append_unsafe("ab\0", 3);
+		VERIFY(safememory::hash<StringType>()(s1) != safememory::hash<StringType>()(s2));
+	}
+
+	return nErrorCount;
+}
+
+
+template <typename StringType>
+int TestStringView()
+{
+	int nErrorCount = 0;
+	typedef typename StringType::view_type ViewType;
+	typedef eastl::basic_string<char> BaseString;
+
+	EASTLTest_Rand rng(GetRandSeed());
+
+	for(int i = 0; i < 2000; i++)
+	{
+		const eastl_size_t n = rng.RandLimit(100);
+		const eastl_size_t m = rng.RandLimit(6);
+
+		BaseString b1, b2;
+		for(eastl_size_t j = 0; j < n; j++)
+			b1.push_back((char)rng.RandRange('a', 'e'));
+		for(eastl_size_t j = 0; j < m; j++)
+			b2.push_back((char)rng.RandRange('a', 'f'));
+
+		StringType s1, s2;
+		s1.append_unsafe(b1.data(), b1.size());
+		s2.append_unsafe(b2.data(), b2.size());
+
+		const eastl_size_t off = rng.RandLimit(n + 1);
+		const eastl_size_t len = rng.RandLimit(n - off + 1);
+		const eastl_size_t pos = rng.RandLimit(n + 3);
+
+		ViewType v1 = s1.substr_view(off, len);
+		ViewType v2 = s2.view();
+		BaseString r1 = b1.substr(off, len);
+
+		VERIFY(v1.size() == r1.size());
+		VERIFY(v1.find(v2, pos) == r1.find(b2, pos));
+		VERIFY(v1.rfind(v2, pos) == r1.rfind(b2, pos));
+		VERIFY(v1.find_first_of(v2, pos) == r1.find_first_of(b2, pos));
+		VERIFY(v1.find_last_of(v2, pos) == r1.find_last_of(b2, pos));
+		VERIFY(v1.find_first_not_of(v2, pos) == r1.find_first_not_of(b2, pos));
+		VERIFY((v1.compare(v2) < 0) == (r1.compare(b2) < 0));
+		VERIFY((v1 == v2) == (r1 == b2));
+
+		VERIFY(s1.find(v2, pos) == b1.find(b2, pos));
+		VERIFY(s1.rfind(v2, pos) == b1.rfind(b2, pos));
+		VERIFY(s1.find_first_of(v2, pos) == b1.find_first_of(b2, pos));
+		VERIFY((s1.compare(v2) < 0) == (b1.compare(b2) < 0));
+
+		StringType s3(v1);
+		VERIFY(s3 == v1);
+		VERIFY(safememory::hash<ViewType>()(v1) == safememory::hash<StringType>()(s3));
+	}
+
+	{
+		StringType s1("hello world");
+		ViewType v1 = s1.substr_view(6);
+
+		VERIFY(v1 == "world");
+		VERIFY(v1.substr(1, 3) == "orl");
+		VERIFY(v1.front() == 'w' && v1.back() == 'd');
+		VERIFY(v1.starts_with("wor") && v1.ends_with('d'));
+
+		v1.remove_prefix(1);
+		v1.remove_suffix(1);
+		VERIFY(v1 == "orl");
+
+		// changes in place are seen by the view
+		s1[7] = 'O';
+		VERIFY(v1 == "Orl");
+
+		StringType s2(s1);
+		s2 += v1;
+		VERIFY(s2 == "hello wOrldOrl");
+
+		#if EASTL_EXCEPTIONS_ENABLED
+			try
+			{
+				v1.at(3);
+				EATEST_VERIFY(false);
+			}
+			catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+			catch(...) { EATEST_VERIFY(false); }
+		#endif
+	}
+
+	if constexpr (StringType::is_safe == safememory::memory_safety::safe)
+	{
+		StringType s1("short");
+		ViewType v1 = s1.view();
+
+		// buffer is reallocated, view is now a zombie
+		s1.append(1000, 'x');
+
+		#if EASTL_EXCEPTIONS_ENABLED
+			try
+			{
+				char c = v1[0];
+				(void)c;
+				EATEST_VERIFY(false);
+			}
+			catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+			catch(...) { EATEST_VERIFY(false); }
+		#endif
+	}
+
+	return nErrorCount;
+}
+
 int TestString()
 {
 	int nErrorCount = 0;
@@ -109,6 +265,12 @@ int TestString()
 
 	nErrorCount += TestToString();
 
+	nErrorCount += TestStringKernels<safememory::basic_string<char>>();
+	nErrorCount += TestStringKernels<safememory::basic_string<char, safememory::memory_safety::none>>();
+
+	nErrorCount += TestStringView<safememory::basic_string<char>>();
+	nErrorCount += TestStringView<safememory::basic_string<char, safememory::memory_safety::none>>();
+
 	return nErrorCount;
 
 	// Check for memory leaks by using the 'CountingAllocator' to ensure no active allocation after tests have completed.
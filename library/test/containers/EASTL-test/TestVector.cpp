@@ -4,6 +4,7 @@
 
 #include "EASTLTest.h"
 #include <safememory/vector.h>
+#include <safememory/small_vector.h>
 #include <string>
 #include <deque>
 #include <list>
@@ -57,6 +58,9 @@ struct HasAddressOfOperator
 };
 template class safememory::vector<HasAddressOfOperator>;  // force compile all functions of vector
 
+template class safememory::small_vector<int, 4>;
+template class safememory::small_vector<TestObject, 2, safememory::memory_safety::none>;
+
 
 
 // Test compiler issue that appeared in VS2012 relating to kAlignment
@@ -1733,6 +1737,114 @@ template<class T>
 using VEC_SAFE = safememory::vector_safe<T>;
 
 
+template<class SmallVec>
+int TestSmallVector()
+{
+	int nErrorCount = 0;
+
+	TestObject::Reset();
+
+	{
+		// elements stay inline up to N, then spill to the heap
+		SmallVec v;
+		EATEST_VERIFY(v.is_inline() && v.capacity() == SmallVec::inline_capacity);
+
+		for(int i = 0; i < 4; ++i)
+			v.push_back(TestObject(i));
+		EATEST_VERIFY(v.is_inline() && v.size() == 4);
+
+		v.push_back(TestObject(4));
+		EATEST_VERIFY(!v.is_inline() && v.size() == 5);
+		for(int i = 0; i < 5; ++i)
+			EATEST_VERIFY(v[i] == TestObject(i));
+
+		v.erase(v.begin(), v.begin() + 2);
+		EATEST_VERIFY(v.size() == 3 && v.front() == TestObject(2));
+		v.shrink_to_fit();
+		EATEST_VERIFY(v.is_inline() && v.size() == 3 && v.back() == TestObject(4));
+	}
+
+	{
+		// copy, move, assign and compare across inline and heap storage
+		SmallVec a = { TestObject(1), TestObject(2) };
+		SmallVec b = { TestObject(1), TestObject(2), TestObject(3), TestObject(4), TestObject(5) };
+
+		SmallVec c(a);
+		EATEST_VERIFY(c == a && c.is_inline());
+		c = b;
+		EATEST_VERIFY(c == b && !c.is_inline());
+		EATEST_VERIFY(a < b && b != a);
+
+		SmallVec d(std::move(c));
+		EATEST_VERIFY(d == b && c.empty());
+		c = std::move(a);
+		EATEST_VERIFY(c.size() == 2 && a.empty());
+
+		c.swap(d);
+		EATEST_VERIFY(c == b && d.size() == 2);
+
+		c.insert(c.begin() + 1, 3, TestObject(9));
+		EATEST_VERIFY(c.size() == 8 && c[1] == TestObject(9) && c[3] == TestObject(9) && c[4] == TestObject(2));
+		c.assign(c.begin() + 4, c.end());
+		EATEST_VERIFY(c.size() == 4 && c[0] == TestObject(2) && c[3] == TestObject(5));
+	}
+
+	{
+		// heap safe iterators move inline elements to the heap first
+		SmallVec v = { TestObject(1), TestObject(2) };
+		EATEST_VERIFY(v.is_inline());
+
+		auto it = v.begin_safe();
+		EATEST_VERIFY(!v.is_inline() && v.size() == 2);
+		EATEST_VERIFY(*it == TestObject(1));
+		++it;
+		EATEST_VERIFY(*it == TestObject(2));
+
+		auto it2 = v.make_safe(v.begin() + 1);
+		EATEST_VERIFY(it2 == it);
+	}
+
+#if EASTL_EXCEPTIONS_ENABLED
+	if(SmallVec::is_safe == safememory::memory_safety::safe)
+	{
+		SmallVec v;
+
+		try {
+			v.at(0);
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+
+		v.push_back(TestObject(1));
+		try {
+			v.erase(v.end());
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+
+		// a heap safe iterator must not survive a reallocation
+		auto it = v.begin_safe();
+		for(int i = 0; i < 16; ++i)
+			v.push_back(TestObject(i));
+
+		try {
+			EATEST_VERIFY(*it == TestObject(1));
+			EATEST_VERIFY(false);
+		}
+		catch (nodecpp::error::memory_error&) { EATEST_VERIFY(true); }
+		catch (...) { EATEST_VERIFY(false); }
+	}
+#endif
+
+	EATEST_VERIFY(TestObject::IsClear());
+	TestObject::Reset();
+
+	return nErrorCount;
+}
+
+
 int TestVector()
 {
 	int nErrorCount = 0;
@@ -1740,5 +1852,8 @@ int TestVector()
 	nErrorCount += TestVectorImpl<VEC>();
 	nErrorCount += TestVectorImpl<VEC_SAFE>();
 
+	nErrorCount += TestSmallVector<safememory::small_vector<TestObject, 4>>();
+	nErrorCount += TestSmallVector<safememory::small_vector<TestObject, 4, safememory::memory_safety::none>>();
+
 	return nErrorCount;
 }
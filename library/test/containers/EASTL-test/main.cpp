@@ -66,7 +66,7 @@ int main(int argc, char* argv[])
 		// testSuite.AddTest("Bitset",					TestBitset);
 		// testSuite.AddTest("CharTraits",			    TestCharTraits);
 		// testSuite.AddTest("Chrono",					TestChrono);
-		// testSuite.AddTest("Deque",					TestDeque);
+		nErrorCount += TestDeque();
 		// testSuite.AddTest("Extra",					TestExtra);
 		// testSuite.AddTest("Finally",				TestFinally);
 		// testSuite.AddTest("FixedFunction",			TestFixedFunction);
@@ -96,7 +96,7 @@ int main(int argc, char* argv[])
 		// testSuite.AddTest("Optional",				TestOptional);
 		// testSuite.AddTest("Random",					TestRandom);
 		// testSuite.AddTest("Ratio",					TestRatio);
-		// testSuite.AddTest("RingBuffer",				TestRingBuffer);
+		nErrorCount += TestRingBuffer();
 		// testSuite.AddTest("SList",					TestSList);
 		// testSuite.AddTest("SegmentedVector",		TestSegmentedVector);
 		// testSuite.AddTest("Set",					TestSet);
@@ -80,6 +80,8 @@ struct StructWithDtorRequiringValidSoftPtrsToItself
 	}
 };
 
+struct StructWithManyInlineSoftPtrSlots { int n; uint8_t dummyBytes[3]; }; // odd size to check placement of extra slots
+
 template<size_t minSz, size_t alignExp=0>
 struct LargeObjectWithControllableAlignment
 {
@@ -89,5 +91,7 @@ struct LargeObjectWithControllableAlignment
 
 } // namespace safememory::testing::dummy_objects
 
+template<> struct safememory::soft_ptr_slots_declarator<safememory::testing::dummy_objects::StructWithManyInlineSoftPtrSlots> { static constexpr std::size_t inline_slots = 8; };
+
 
 #endif // DUMMY_TEST_OBJECTS_H
\ No newline at end of file
@@ -29,6 +29,9 @@
 //
 
 #include <stdio.h>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 //#include <safe_ptr.h>
 //#include <safe_ptr_no_checks.h>
@@ -39,6 +42,7 @@
 #include <safememory/detail/instrument.h>
 // #include "containers/EASTLTest.h"
 #include "sample_containers.h"
+#include <safememory/owning_nary_tree.h>
 
 //template<> struct safememory::safeness_declarator<double> { static constexpr bool is_safe = false; }; // user-defined exclusion
 //template<> struct safememory::safeness_declarator<safememory::testing::dummy_objects::StructureWithSoftPtrDeclaredUnsafe> { static constexpr bool is_safe = false; }; // user-defined exclusion
@@ -90,6 +94,28 @@ void fnOwningEnd() {
 	gop.reset(); 
 }
 
+// testing intrusive owning containers
+struct ListNode : public owning_list_hook<ListNode>
+{
+	int n;
+	ListNode( int n_ ) : n( n_ ) {}
+};
+
+struct TreeNode : public owning_nary_tree_hook<TreeNode>
+{
+	int n;
+	TreeNode( int n_ ) : n( n_ ) {}
+};
+
+// testing shared soft ptrs pinning the object
+struct SharedCounted
+{
+	static std::atomic<size_t> dtorCount;
+	int n = 5;
+	~SharedCounted() { dtorCount.fetch_add( 1 ); }
+};
+std::atomic<size_t> SharedCounted::dtorCount = 0;
+
 
 #if 1
 int testWithLest( int argc, char * argv[] )
@@ -454,6 +480,46 @@ int testWithLest( int argc, char * argv[] )
 				EXPECT( !nodecpp::platform::is_guaranteed_on_stack( &g_int ) );
 				EXPECT( !nodecpp::platform::is_guaranteed_on_stack( &th_int ) );
 				//EXPECT( !nodecpp::platform::is_guaranteed_on_stack( &l ) );
+
+				using safememory::detail::isGuaranteedOnStack;
+				EXPECT( !isGuaranteedOnStack( pn ) );
+				EXPECT( !isGuaranteedOnStack( &g_int ) );
+				EXPECT( !isGuaranteedOnStack( &th_int ) );
+#if defined NODECPP_LINUX || defined __linux__ || defined NODECPP_WINDOWS
+				// bounds are known on these platforms
+				int a = 0;
+				EXPECT( isGuaranteedOnStack( &a ) );
+				bool inOtherThread = true;
+				bool otherLocalInOtherThread = false;
+				std::thread t( [&]() { int b = 0; inOtherThread = isGuaranteedOnStack( &a ); otherLocalInOtherThread = isGuaranteedOnStack( &b ); } );
+				t.join();
+				EXPECT( !inOtherThread );
+				EXPECT( otherLocalInOtherThread );
+
+				// a stack of a fiber
+				uint8_t* fiberStack = new uint8_t[0x1000];
+				{
+					safememory::detail::stack_bounds_scope scope( fiberStack, fiberStack + 0x1000 );
+					EXPECT( isGuaranteedOnStack( fiberStack + 0x800 ) );
+					EXPECT( !isGuaranteedOnStack( &a ) );
+				}
+				EXPECT( !isGuaranteedOnStack( fiberStack + 0x800 ) );
+				EXPECT( isGuaranteedOnStack( &a ) );
+				delete [] fiberStack;
+
+#if defined NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING && NODECPP_MEMORY_SAFETY > 0
+				owning_ptr<int> op = make_owning<int>(5);
+				safememory::detail::OnStackSafePtrMetrics before = safememory::detail::getOnStackSafePtrMetrics();
+				{
+					soft_ptr<int> sp = op;
+					EXPECT( *sp == 5 );
+				}
+				safememory::detail::OnStackSafePtrMetrics after = safememory::detail::getOnStackSafePtrMetrics();
+				EXPECT( after.creationCount == before.creationCount + 1 );
+				EXPECT( after.destructionCount == before.destructionCount + 1 );
+#endif // NODECPP_ENABLE_ONSTACK_SOFTPTR_COUNTING
+#endif
+				delete pn;
 			}
 			killAllZombies();
 		},
@@ -471,6 +537,19 @@ int testWithLest( int argc, char * argv[] )
 				owning_ptr<SomethingLarger> opSL_2 = make_owning<SomethingLarger>( 37, false, false );
 				EXPECT( *(opSL_2->opS->m) == 37 );
 				EXPECT( *(opSL_2->softpS->m) == 37 );
+
+				struct WithThis { soft_this_ptr<WithThis> myThis; int n = 5; };
+				EXPECT( sizeof(soft_this_ptr<WithThis>) <= sizeof(void*) );
+				owning_ptr<WithThis> opWT = make_owning<WithThis>();
+				owning_ptr<WithThis> opWTCopy = make_owning<WithThis>( *opWT ); // soft_this_ptr is taken anew by a copy
+				soft_ptr<WithThis> spWT = opWTCopy->myThis.getSoftPtr( &*opWTCopy );
+				EXPECT( &*spWT == &*opWTCopy );
+				EXPECT( spWT->n == 5 );
+#if NODECPP_MEMORY_SAFETY > 0
+				WithThis notOwned;
+				EXPECT( !notOwned.myThis );
+				EXPECT_THROWS( notOwned.myThis.getSoftPtr( &notOwned ) );
+#endif // NODECPP_MEMORY_SAFETY > 0
 			}
 			killAllZombies();
 		},
@@ -569,6 +648,730 @@ int testWithLest( int argc, char * argv[] )
 			}
 		},
 
+		CASE( "soft ptr slots reuse" )
+		{
+			SETUP("soft ptr slots reuse")
+			{
+				const size_t maxPtrs = 20; // covers both inline slots and a second block
+				soft_ptr<int>* sptrs = new soft_ptr<int>[maxPtrs];
+				owning_ptr<int> op = make_owning<int>(5);
+				for ( size_t i=0; i<maxPtrs; ++i )
+					sptrs[i] = op;
+				// release in non-sequential order and re-acquire
+				for ( size_t i=0; i<maxPtrs; i+=2 )
+					sptrs[i] = nullptr;
+				sptrs[1] = nullptr;
+				for ( size_t i=0; i<maxPtrs; i+=2 )
+					sptrs[i] = op;
+				sptrs[1] = op;
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( *(sptrs[i]) == 5 );
+				op = nullptr;
+#if NODECPP_MEMORY_SAFETY > 0
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( sptrs[i] == nullptr );
+#endif // NODECPP_MEMORY_SAFETY > 0
+				delete [] sptrs;
+			}
+		},
+
+		CASE( "soft ptr slots, configurable inline count" )
+		{
+			SETUP("soft ptr slots, configurable inline count")
+			{
+				const size_t maxPtrs = 20; // covers inline slots, embedded ones, and a second block
+				soft_ptr<StructWithManyInlineSoftPtrSlots>* sptrs = new soft_ptr<StructWithManyInlineSoftPtrSlots>[maxPtrs];
+				owning_ptr<StructWithManyInlineSoftPtrSlots> op = make_owning<StructWithManyInlineSoftPtrSlots>();
+				op->n = 5;
+				for ( size_t i=0; i<maxPtrs; ++i )
+					sptrs[i] = op;
+				for ( size_t i=0; i<maxPtrs; i+=3 )
+					sptrs[i] = nullptr;
+				for ( size_t i=0; i<maxPtrs; i+=3 )
+					sptrs[i] = op;
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( sptrs[i]->n == 5 );
+				op = nullptr;
+#if NODECPP_MEMORY_SAFETY > 0
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( sptrs[i] == nullptr );
+#endif // NODECPP_MEMORY_SAFETY > 0
+				delete [] sptrs;
+			}
+		},
+
+		CASE( "soft ptr second block shrinking" )
+		{
+			SETUP("soft ptr second block shrinking")
+			{
+#if NODECPP_MEMORY_SAFETY > 0
+				const size_t maxPtrs = 200;
+				size_t inUseAtStart = safememory::detail::getSecondCBBytesInUse();
+				soft_ptr<int>* sptrs = new soft_ptr<int>[maxPtrs];
+				owning_ptr<int> op = make_owning<int>(5);
+				for ( size_t i=0; i<maxPtrs; ++i )
+					sptrs[i] = op;
+				size_t inUsePeak = safememory::detail::getSecondCBBytesInUse();
+				EXPECT( inUsePeak > inUseAtStart );
+				// leave the first and the last one only; the last one is to be moved to a smaller block
+				for ( size_t i=1; i<maxPtrs-1; ++i )
+					sptrs[i] = nullptr;
+				EXPECT( safememory::detail::getSecondCBBytesInUse() < inUsePeak );
+				EXPECT( *(sptrs[0]) == 5 );
+				EXPECT( *(sptrs[maxPtrs-1]) == 5 );
+				for ( size_t i=1; i<maxPtrs/2; ++i )
+					sptrs[i] = op;
+				for ( size_t i=0; i<maxPtrs/2; ++i )
+					EXPECT( *(sptrs[i]) == 5 );
+				op = nullptr;
+				EXPECT( safememory::detail::getSecondCBBytesInUse() == inUseAtStart );
+				for ( size_t i=0; i<maxPtrs/2; ++i )
+					EXPECT( sptrs[i] == nullptr );
+				EXPECT( sptrs[maxPtrs-1] == nullptr );
+				delete [] sptrs;
+				safememory::detail::releaseSecondCBPool();
+				EXPECT( safememory::detail::getSecondCBBytesPooled() == 0 );
+#endif // NODECPP_MEMORY_SAFETY > 0
+			}
+		},
+
+#if NODECPP_MEMORY_SAFETY > 0 && defined NODECPP_USE_IIBMALLOC
+		CASE( "soft ptr second block pool at thread exit" )
+		{
+			SETUP("soft ptr second block pool at thread exit")
+			{
+				size_t pooledAtStart = safememory::detail::getSecondCBBytesPooled();
+				size_t pooledInThread = 0;
+				std::thread t( [&]() {
+					ThreadLocalAllocatorT allocManager;
+					ThreadLocalAllocatorT* formerAlloc = setCurrneAllocator( &allocManager );
+					{
+						const size_t maxPtrs = 20;
+						soft_ptr<int>* sptrs = new soft_ptr<int>[maxPtrs];
+						owning_ptr<int> op = make_owning<int>(5);
+						for ( size_t i=0; i<maxPtrs; ++i )
+							sptrs[i] = op;
+						delete [] sptrs;
+						op = nullptr; // second block goes to the pool of this thread
+						killAllZombies();
+						pooledInThread = safememory::detail::getSecondCBBytesPooled();
+					}
+					setCurrneAllocator( formerAlloc );
+				} );
+				t.join();
+				EXPECT( pooledInThread > pooledAtStart );
+				// the allocator is gone by thread exit, and pooled blocks are dropped with its memory
+				EXPECT( safememory::detail::getSecondCBBytesPooled() == pooledAtStart );
+			}
+		},
+#endif // NODECPP_MEMORY_SAFETY > 0 && NODECPP_USE_IIBMALLOC
+
+#if defined NODECPP_USE_IIBMALLOC && defined NODECPP_MEMORY_SAFETY_ON_DEMAND
+		CASE( "soft ptr second block, allocator switched" )
+		{
+			SETUP("soft ptr second block, allocator switched")
+			{
+				const size_t maxPtrs = 40;
+				safememory::detail::releaseSecondCBPool();
+				size_t inUseAtStart = safememory::detail::getSecondCBBytesInUse();
+				soft_ptr<int>* sptrs = new soft_ptr<int>[maxPtrs];
+				owning_ptr<int> op = make_owning<int>(5);
+				{
+					safememory::arena a;
+					{
+						arena_scope scope( a );
+						for ( size_t i=0; i<maxPtrs; ++i ) // second blocks are allocated and grown within the arena
+							sptrs[i] = op;
+					}
+					size_t pooled = safememory::detail::getSecondCBBytesPooled();
+					// shrinking moves slots to a block of current allocator; the one of the arena goes back to the arena
+					for ( size_t i=1; i<maxPtrs; ++i )
+						sptrs[i] = nullptr;
+					EXPECT( safememory::detail::getSecondCBBytesPooled() == pooled );
+					EXPECT( *(sptrs[0]) == 5 );
+					for ( size_t i=1; i<maxPtrs; ++i ) // and grow again
+						sptrs[i] = op;
+					{
+						arena_scope scope( a );
+						op = nullptr; // a block of the other allocator is not taken by the pool of the arena
+						EXPECT( safememory::detail::getSecondCBBytesInUse() == inUseAtStart );
+					}
+					for ( size_t i=0; i<maxPtrs; ++i )
+						EXPECT( sptrs[i] == nullptr );
+				}
+				delete [] sptrs;
+				safememory::detail::releaseSecondCBPool();
+				EXPECT( safememory::detail::getSecondCBBytesPooled() == 0 );
+			}
+		},
+#endif // NODECPP_USE_IIBMALLOC && NODECPP_MEMORY_SAFETY_ON_DEMAND
+
+#ifdef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+		CASE( "deferred owner destruction" )
+		{
+			SETUP("deferred owner destruction")
+			{
+				const size_t maxPtrs = 20;
+				soft_ptr<int>* sptrs = new soft_ptr<int>[maxPtrs];
+				owning_ptr<int> op = make_owning<int>(5);
+				for ( size_t i=0; i<maxPtrs; ++i )
+					sptrs[i] = op;
+				op = nullptr;
+				// soft_ptrs are not walked at owner destruction, but dead object is still detected
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT_THROWS( *(sptrs[i]) );
+				sptrs[0] = nullptr;
+				sptrs[maxPtrs-1] = nullptr;
+				killAllZombies();
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( sptrs[i] == nullptr );
+				delete [] sptrs;
+#if defined NODECPP_USE_IIBMALLOC && defined NODECPP_MEMORY_SAFETY_ON_DEMAND
+				if ( safememory::detail::g_CurrentAllocManager != nullptr )
+				{
+					soft_ptr<int>* sp = new soft_ptr<int>; // explicitly non-stack
+					owning_ptr<int> op2 = make_owning<int>(6);
+					*sp = op2;
+					safememory::arena a;
+					{
+						arena_scope scope( a );
+						op2 = nullptr; // recorded with allocatorID of the former allocator, registered for the scope
+					}
+					// owners of an allocator are released when it's unregistered, not left for good
+					EXPECT( *sp == nullptr );
+					delete sp;
+				}
+#endif // NODECPP_USE_IIBMALLOC && NODECPP_MEMORY_SAFETY_ON_DEMAND
+			}
+		},
+#endif // NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+
+#if NODECPP_MEMORY_SAFETY > 0 && ( defined NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION || !defined NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION )
+		CASE( "zombie detection by control block" )
+		{
+			SETUP("zombie detection by control block")
+			{
+				owning_ptr<int>* op = new owning_ptr<int>( make_owning<int>(5) );
+				soft_ptr<int> sp = *op; // not invalidated by the owner if on-stack soft_ptrs are not registered
+				borrowed_ptr<int> bp( *op );
+				EXPECT( *sp == 5 );
+				EXPECT( *bp == 5 );
+				int* raw = &**op;
+				delete op;
+				// the block is already returned to the allocator as zombie; its control block must be marked by then
+				EXPECT( safememory::detail::getControlBlock_( raw )->isZombie() );
+				EXPECT_THROWS( *sp );
+				EXPECT_THROWS( *bp );
+			}
+		},
+#endif // NODECPP_MEMORY_SAFETY > 0 && ( NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION || !NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION )
+
+		CASE( "control block zombie flag" )
+		{
+			SETUP("control block zombie flag")
+			{
+				// zombie detection on dereference reads the flag that is set when a dead object is released (or deferred)
+				using safememory::detail::FirstControlBlock;
+				FirstControlBlock cb;
+				cb.init();
+				EXPECT( !cb.isZombie() );
+				cb.clear();
+				EXPECT( cb.isZombie() );
+				cb.init();
+				cb.setOverAligned();
+				cb.clear();
+				EXPECT( cb.isZombie() );
+				EXPECT( cb.isOverAligned() ); // layout of the block is still known
+				cb.init();
+				EXPECT( !cb.isZombie() );
+				cb.markZombie();
+				EXPECT( cb.isZombie() );
+			}
+		},
+
+		CASE( "borrowed ptr" )
+		{
+			SETUP("borrowed ptr")
+			{
+#if NODECPP_MEMORY_SAFETY > 0
+				const size_t maxPtrs = 50;
+				owning_ptr<int> op = make_owning<int>(5);
+				soft_ptr<int> sp = op;
+				size_t inUseAtStart = safememory::detail::getSecondCBBytesInUse();
+				// kept in heap intentionally: soft_ptrs here would spill to the second block
+				borrowed_ptr<int>* bptrs = new borrowed_ptr<int>[maxPtrs];
+				for ( size_t i=0; i<maxPtrs; ++i )
+					bptrs[i] = ( i & 1 ) ? borrowed_ptr<int>( op ) : borrowed_ptr<int>( sp );
+				EXPECT( safememory::detail::getSecondCBBytesInUse() == inUseAtStart );
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( *(bptrs[i]) == 5 );
+				soft_ptr<int> sp2 = bptrs[0].to_soft();
+				EXPECT( *sp2 == 5 );
+				borrowed_ptr<int> bnull;
+				EXPECT( bnull == nullptr );
+				EXPECT( bnull.to_soft() == nullptr );
+				EXPECT_THROWS( *bnull );
+				op = nullptr;
+#ifndef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+				EXPECT( sp2 == nullptr );
+#endif
+				EXPECT_THROWS( bptrs[1].to_soft() ); // not registered in a dead object, whatever the zombie detection mode
+				delete [] bptrs;
+#endif // NODECPP_MEMORY_SAFETY > 0
+			}
+		},
+
+#if defined NODECPP_USE_NEW_DELETE_ALLOC && !defined NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		CASE( "zombie bitmap" )
+		{
+			SETUP("zombie bitmap")
+			{
+				safememory::detail::ZombieBitmap bm{};
+				EXPECT( bm.empty() );
+				uint8_t* blocks[3];
+				for ( size_t i=0; i<3; ++i )
+					blocks[i] = new uint8_t[ 3 << 20 ]; // each spans several bitmap leaves
+				bm.mark( blocks[1] + 8, ( 3 << 20 ) - 16 );
+				EXPECT( !bm.empty() );
+				EXPECT( !bm.isMarked( blocks[1] ) );
+				EXPECT( bm.isMarked( blocks[1] + 8 ) );
+				EXPECT( bm.isMarked( blocks[1] + ( 2 << 20 ) ) );
+				EXPECT( bm.isMarked( blocks[1] + ( 3 << 20 ) - 9 ) );
+				EXPECT( !bm.isMarked( blocks[1] + ( 3 << 20 ) - 8 ) );
+				EXPECT( !bm.isMarked( blocks[0] ) );
+				EXPECT( !bm.isMarked( blocks[2] + 8 ) );
+				EXPECT( !bm.isMarked( &bm ) );
+				bm.unmark( blocks[1] + 8, ( 3 << 20 ) - 16 );
+				EXPECT( bm.empty() );
+				EXPECT( !bm.isMarked( blocks[1] + ( 2 << 20 ) ) );
+				bm.clear();
+				for ( size_t i=0; i<3; ++i )
+					delete [] blocks[i];
+			}
+		},
+#endif // NODECPP_USE_NEW_DELETE_ALLOC && !NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+
+#if defined NODECPP_USE_NEW_DELETE_ALLOC && NODECPP_MEMORY_SAFETY > 0 && !defined NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+		CASE( "zombie quarantine" )
+		{
+			SETUP("zombie quarantine")
+			{
+				using namespace safememory::detail;
+				killAllZombies();
+				const size_t cnt = 100;
+				int* ptrs[cnt];
+				for ( size_t i=0; i<cnt; ++i )
+				{
+					owning_ptr<int> op = make_owning<int>( (int)i );
+					ptrs[i] = &*op;
+				}
+				ZombieQuarantineMetrics m = getZombieQuarantineMetrics();
+				EXPECT( m.blocksHeld == cnt );
+				size_t blockSize = m.bytesHeld / cnt;
+				EXPECT( !killZombiesStep() ); // no budget, nothing is released
+				EXPECT( getZombieQuarantineMetrics().blocksHeld == cnt );
+
+				size_t prevBudget = setZombieQuarantineBudget( blockSize * 10 );
+				EXPECT( killZombiesStep( 30 ) );
+				m = getZombieQuarantineMetrics();
+				EXPECT( m.blocksHeld == cnt - 30 );
+				EXPECT( m.releasedBlocks >= 30 );
+				while ( killZombiesStep( 30 ) );
+				m = getZombieQuarantineMetrics();
+				EXPECT( m.blocksHeld == 10 );
+				EXPECT( m.bytesHeld <= blockSize * 10 );
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+				EXPECT( !isPointerNotZombie( ptrs[cnt - 1] ) ); // newest ones are still there
+#endif
+				killAllZombies();
+				EXPECT( getZombieQuarantineMetrics().bytesHeld == 0 );
+				setZombieQuarantineBudget( prevBudget );
+			}
+		},
+#endif // NODECPP_USE_NEW_DELETE_ALLOC && NODECPP_MEMORY_SAFETY > 0 && !NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+
+		CASE( "over-aligned objects" )
+		{
+			SETUP("over-aligned objects")
+			{
+				struct alignas(64) CacheLineAligned { int n; };
+				struct alignas(32) WithAlignedMember { int n; alignas(32) double d[4]; };
+				owning_ptr<CacheLineAligned> op = make_owning<CacheLineAligned>( CacheLineAligned{5} );
+				EXPECT( ( (uintptr_t)&*op & 63 ) == 0 );
+				EXPECT( op->n == 5 );
+				std::vector<owning_ptr<WithAlignedMember>> ops;
+				for ( size_t i=0; i<8; ++i )
+					ops.push_back( make_owning<WithAlignedMember>() );
+				for ( auto& p : ops )
+					EXPECT( ( (uintptr_t)p->d & 31 ) == 0 );
+#if NODECPP_MEMORY_SAFETY > 0
+				soft_ptr<CacheLineAligned>* sp = new soft_ptr<CacheLineAligned>( op ); // explicitly non-stack
+				EXPECT( (*sp)->n == 5 );
+				op = nullptr;
+#ifndef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+				EXPECT( *sp == nullptr );
+#endif
+				delete sp;
+#endif // NODECPP_MEMORY_SAFETY > 0
+				safememory::vector<CacheLineAligned> v;
+				for ( int i=0; i<100; ++i )
+					v.push_back( CacheLineAligned{i} );
+				EXPECT( ( (uintptr_t)&v[0] & 63 ) == 0 );
+				EXPECT( v[99].n == 99 );
+				killAllZombies();
+			}
+		},
+
+#if defined NODECPP_USE_IIBMALLOC && defined NODECPP_MEMORY_SAFETY_ON_DEMAND
+		CASE( "arena" )
+		{
+			SETUP("arena")
+			{
+				owning_ptr<int> outer = make_owning<int>( 1 );
+				{
+					safememory::arena a;
+					EXPECT( a.allocatorID() != 0 );
+					EXPECT( !a.isCurrent() );
+					owning_ptr<int> op = make_owning_in<int>( a, 2 );
+					EXPECT( *op == 2 );
+					EXPECT( !a.isCurrent() );
+					EXPECT( a.liveObjectCount() == 1 );
+					{
+						safememory::vector<int> v;
+						safememory::unordered_map<int, int> m;
+						safememory::string s;
+						{
+							arena_scope scope( a );
+							EXPECT( a.isCurrent() );
+							for ( int i=0; i<100; ++i )
+								v.push_back( i );
+							s = "a string allocated within the arena, too long for SSO";
+							m.insert( { 1, 2 } );
+						}
+						EXPECT( a.liveObjectCount() > 1 ); // container buffers are objects of the arena as well
+						// buffers of the arena are released to it while another allocator is current
+						for ( int i=100; i<1000; ++i )
+							v.push_back( i );
+						s.append( 100, '!' );
+						for ( int i=2; i<100; ++i )
+							m.insert( { i, i + 1 } );
+						EXPECT( v[999] == 999 );
+						EXPECT( m[1] == 2 );
+						EXPECT( m[99] == 100 );
+						EXPECT( s.size() == 153 );
+					}
+					EXPECT( a.liveObjectCount() == 1 ); // containers are destroyed outside of any arena_scope
+					{
+						arena_scope scope( a );
+						EXPECT( a.isCurrent() );
+						owning_ptr<int> op2 = make_owning<int>( 3 );
+						EXPECT( a.liveObjectCount() == 2 );
+						op = std::move( op2 );
+#ifndef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+						EXPECT( a.liveObjectCount() == 1 );
+#endif
+					}
+					EXPECT( !a.isCurrent() );
+					op = nullptr; // returned to the arena while another allocator is current
+					a.release();
+					EXPECT( a.liveObjectCount() == 0 );
+					EXPECT( *outer == 1 );
+				}
+				EXPECT( *outer == 1 );
+			}
+		},
+#endif // NODECPP_USE_IIBMALLOC && NODECPP_MEMORY_SAFETY_ON_DEMAND
+
+		CASE( "owning_list" )
+		{
+			SETUP("owning_list")
+			{
+				owning_list<ListNode> l;
+				EXPECT( l.empty() );
+				for ( int i=1; i<=3; ++i )
+					l.push_back( make_owning<ListNode>( i ) );
+				l.push_front( make_owning<ListNode>( 0 ) );
+				EXPECT( l.size() == 4 );
+				int expected = 0;
+				for ( auto p = l.front(); p != nullptr; p = l.next( *p ) )
+					EXPECT( p->n == expected++ );
+				EXPECT( expected == 4 );
+				EXPECT( l.back()->n == 3 );
+				EXPECT( l.prev( *(l.back()) )->n == 2 );
+
+				soft_ptr<ListNode> second = l.next( *(l.front()) );
+				owning_ptr<ListNode> taken = l.unlink( *second );
+				EXPECT( taken->n == 1 );
+				EXPECT( !taken->is_linked() );
+				EXPECT( l.size() == 3 );
+				EXPECT( l.next( *(l.front()) )->n == 2 );
+				l.insert_after( *(l.back()), std::move( taken ) );
+				EXPECT( l.back()->n == 1 );
+				EXPECT( l.pop_back()->n == 1 );
+				EXPECT( l.pop_front()->n == 0 );
+				EXPECT( l.front()->n == 2 );
+				EXPECT( l.size() == 2 );
+
+#if NODECPP_MEMORY_SAFETY > 0
+				soft_ptr<ListNode>* sp = new soft_ptr<ListNode>( l.back() ); // explicitly non-stack
+				l.clear();
+				EXPECT( l.empty() );
+#ifndef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+				EXPECT( *sp == nullptr );
+#endif
+				delete sp;
+#endif // NODECPP_MEMORY_SAFETY > 0
+
+				l.clear();
+				for ( int i=0; i<100000; ++i ) // long lists are destroyed without recursion
+					l.push_back( make_owning<ListNode>( i ) );
+				EXPECT( l.size() == 100000 );
+			}
+		},
+
+		CASE( "owning_nary_tree" )
+		{
+			SETUP("owning_nary_tree")
+			{
+				owning_nary_tree<TreeNode> t( make_owning<TreeNode>( 0 ) );
+				soft_ptr<TreeNode> root = t.root();
+				for ( int i=1; i<=3; ++i )
+					t.add_child( root, make_owning<TreeNode>( i ) );
+				soft_ptr<TreeNode> first = t.first_child( *root );
+				t.add_child( first, make_owning<TreeNode>( 10 ) );
+				EXPECT( t.child_count( *root ) == 3 );
+				EXPECT( t.child_count( *first ) == 1 );
+				EXPECT( t.parent( *(t.first_child( *first )) ) == first );
+				EXPECT( t.parent( *root ) == nullptr );
+				EXPECT( t.next_sibling( *first )->n == 2 );
+				EXPECT( t.last_child( *root )->n == 3 );
+
+				owning_ptr<TreeNode> sub = t.remove( *first );
+				EXPECT( t.child_count( *root ) == 2 );
+				EXPECT( t.first_child( *root )->n == 2 );
+				EXPECT( t.parent( *sub ) == nullptr );
+				EXPECT( t.first_child( *sub )->n == 10 ); // subtree is kept
+				t.add_child( t.last_child( *root ), std::move( sub ) );
+				EXPECT( t.first_child( *(t.last_child( *root )) )->n == 1 );
+
+				t.set_root( nullptr );
+				EXPECT( t.root() == nullptr );
+
+				t.set_root( make_owning<TreeNode>( 0 ) );
+				soft_ptr<TreeNode> leaf = t.root();
+				for ( int i=1; i<100000; ++i ) { // deep trees are destroyed without recursion
+					t.add_child( leaf, make_owning<TreeNode>( i ) );
+					leaf = t.first_child( *leaf );
+				}
+				EXPECT( leaf->n == 99999 );
+				t.set_root( nullptr );
+			}
+		},
+
+		CASE( "object_pool" )
+		{
+			SETUP("object_pool")
+			{
+				object_pool<int> pool;
+				owning_ptr<int> op = pool.make( 5 );
+				EXPECT( *op == 5 );
+				int* addr = &*op;
+				pool.recycle( std::move( op ) );
+				EXPECT( op == nullptr );
+#if NODECPP_MEMORY_SAFETY > 0
+				EXPECT( pool.quarantined_count() == 1 );
+				EXPECT( pool.free_count() == 0 );
+				owning_ptr<int> op2 = pool.make( 6 ); // quarantined blocks are not reused before collect()
+				EXPECT( &*op2 != addr );
+				pool.collect();
+				EXPECT( pool.free_count() == 1 );
+				owning_ptr<int> op3 = pool.make( 7 );
+				EXPECT( &*op3 == addr );
+				EXPECT( *op3 == 7 );
+				EXPECT( pool.free_count() == 0 );
+
+				soft_ptr<int>* sp = new soft_ptr<int>( op2 ); // explicitly non-stack
+				pool.recycle( std::move( op2 ) ); // has soft_ptrs: released as by reset()
+				EXPECT( pool.quarantined_count() == 0 );
+#ifndef NODECPP_MEMORY_SAFETY_DEFERRED_DESTRUCTION
+				EXPECT( *sp == nullptr );
+#endif
+				delete sp;
+				pool.recycle( std::move( op3 ) );
+#endif // NODECPP_MEMORY_SAFETY > 0
+				pool.clear();
+				EXPECT( pool.free_count() == 0 );
+				EXPECT( pool.quarantined_count() == 0 );
+				killAllZombies();
+			}
+		},
+
+#if defined NODECPP_COMPACT_SOFT_PTR && defined NODECPP_X64 && !defined NODECPP_SAFE_PTR_DEBUG_MODE && NODECPP_MEMORY_SAFETY > 0
+		CASE( "compact soft ptr" )
+		{
+			SETUP("compact soft ptr")
+			{
+				using Compact = safememory::detail::compact_allocated_ptr_and_ptr_and_data_and_flags;
+				EXPECT( sizeof(soft_ptr<int>) == 2 * sizeof(void*) );
+				Compact obj;
+				obj.init();
+				int x = 0;
+				alignas(8) uint64_t y = 0;
+				for ( size_t i=0; i<32; ++i )
+				{
+					size_t data = (size_t)1 << i;
+					obj.init( &x, &y, data );
+					EXPECT( obj.get_data() == data );
+					EXPECT( obj.get_ptr() == &x );
+					EXPECT( obj.get_allocated_ptr() == &y );
+					obj.set_flag<0>();
+					obj.set_data( Compact::max_data - data );
+					EXPECT( obj.get_data() == Compact::max_data - data );
+					EXPECT( obj.get_ptr() == &x );
+					EXPECT( obj.get_allocated_ptr() == &y );
+					EXPECT( obj.has_flag<0>() );
+					obj.unset_flag<0>();
+					EXPECT( !obj.has_flag<0>() );
+				}
+				obj.set_zombie();
+				EXPECT( obj.is_zombie() );
+				EXPECT( obj.get_ptr() == nullptr );
+				EXPECT( obj.get_allocated_ptr() == &y );
+
+				Compact other;
+				other.init( &y, &y, 7 );
+				other.set_flag<1>();
+				obj.swap( other );
+				EXPECT( obj.get_ptr() == &y );
+				EXPECT( obj.get_data() == 7 );
+				EXPECT( obj.has_flag<1>() );
+				EXPECT( !obj.is_zombie() );
+				EXPECT( other.is_zombie() );
+				EXPECT( other.get_allocated_ptr() == &y );
+
+				// soft_ptrs in the second block still keep their (large) slot index
+				const size_t maxPtrs = 100;
+				soft_ptr<int>* sptrs = new soft_ptr<int>[maxPtrs];
+				owning_ptr<int> op = make_owning<int>(5);
+				for ( size_t i=0; i<maxPtrs; ++i )
+					sptrs[i] = op;
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( *(sptrs[i]) == 5 );
+				op = nullptr;
+				for ( size_t i=0; i<maxPtrs; ++i )
+					EXPECT( sptrs[i] == nullptr );
+				delete [] sptrs;
+			}
+		},
+#endif // NODECPP_COMPACT_SOFT_PTR
+
+		CASE( "shared soft ptrs, multithreaded" )
+		{
+			SETUP("shared soft ptrs, multithreaded")
+			{
+#if NODECPP_MEMORY_SAFETY > 0
+				const size_t threadCount = 4;
+				const size_t iterCount = 100000;
+				shared_owning_ptr<int> op = make_shared_owning<int>(5);
+				shared_soft_ptr<int> sp0 = op;
+
+				// copy/destroy at many threads while the owner is alive
+				std::atomic<size_t> errCount = 0;
+				std::vector<std::thread> threads;
+				for ( size_t i=0; i<threadCount; ++i )
+					threads.emplace_back( [&]() {
+						for ( size_t j=0; j<iterCount; ++j )
+						{
+							shared_soft_ptr<int> sp1 = sp0;
+							shared_soft_ptr<int> sp2 = sp1;
+							if ( *sp2.pin() != 5 )
+								errCount.fetch_add( 1 );
+						}
+					});
+				for ( auto& t : threads )
+					t.join();
+				threads.clear();
+				EXPECT( errCount.load() == 0 );
+
+				// owner dies while other threads are copying
+				std::atomic<size_t> startedCount = 0;
+				std::atomic<size_t> detectedCount = 0;
+				for ( size_t i=0; i<threadCount; ++i )
+					threads.emplace_back( [sp1 = shared_soft_ptr<int>( sp0 ), &startedCount, &detectedCount]() {
+						startedCount.fetch_add( 1 );
+						for (;;)
+						{
+							shared_soft_ptr<int> sp2 = sp1;
+							try { (void)*sp2.pin(); }
+							catch (...) { detectedCount.fetch_add( 1 ); break; }
+						}
+					});
+				while ( startedCount.load() != threadCount )
+					std::this_thread::yield();
+				op = nullptr;
+				for ( auto& t : threads )
+					t.join();
+				EXPECT( detectedCount.load() == threadCount );
+				EXPECT_THROWS( sp0.pin() );
+				sp0 = nullptr; // last one; memory is released here
+				EXPECT( sp0 == nullptr );
+#endif // NODECPP_MEMORY_SAFETY > 0
+			}
+		},
+
+		CASE( "shared soft ptrs pin the object" )
+		{
+			SETUP("shared soft ptrs pin the object")
+			{
+#if NODECPP_MEMORY_SAFETY > 0
+				// the owner destructs the object, even if soft ptrs exist
+				SharedCounted::dtorCount = 0;
+				shared_owning_ptr<SharedCounted> op = make_shared_owning<SharedCounted>();
+				shared_soft_ptr<SharedCounted> sp0 = op;
+				EXPECT( sp0->n == 5 );
+				op = nullptr;
+				EXPECT( SharedCounted::dtorCount.load() == 1 );
+				EXPECT_THROWS( sp0.pin() );
+				EXPECT_THROWS( sp0->n );
+				sp0 = nullptr;
+				EXPECT( SharedCounted::dtorCount.load() == 1 );
+
+				// owner dies while other threads are using the object; it waits for their pins
+				const size_t threadCount = 4;
+				SharedCounted::dtorCount = 0;
+				op = make_shared_owning<SharedCounted>();
+				sp0 = op;
+				std::atomic<size_t> startedCount = 0;
+				std::atomic<size_t> errCount = 0;
+				std::vector<std::thread> threads;
+				for ( size_t i=0; i<threadCount; ++i )
+					threads.emplace_back( [sp1 = shared_soft_ptr<SharedCounted>( sp0 ), &startedCount, &errCount]() {
+						startedCount.fetch_add( 1 );
+						for (;;)
+						{
+							shared_soft_ptr<SharedCounted> sp2 = sp1;
+							try {
+								auto pinned = sp2.pin();
+								std::this_thread::yield(); // give the owner a chance to die here
+								if ( pinned->n != 5 || SharedCounted::dtorCount.load() != 0 )
+									errCount.fetch_add( 1 );
+							}
+							catch (...) { break; }
+						}
+					});
+				while ( startedCount.load() != threadCount )
+					std::this_thread::yield();
+				op = nullptr;
+				EXPECT( SharedCounted::dtorCount.load() == 1 ); // destructed at the owner thread
+				for ( auto& t : threads )
+					t.join();
+				EXPECT( errCount.load() == 0 );
+				sp0 = nullptr;
+				EXPECT( SharedCounted::dtorCount.load() == 1 );
+#endif // NODECPP_MEMORY_SAFETY > 0
+			}
+		},
+
 		CASE( "soft ptrs to me are valid in dtor" )
 		{
 			SETUP("soft ptrs to me are valid in dtor")